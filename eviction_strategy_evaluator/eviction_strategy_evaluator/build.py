@@ -10,22 +10,24 @@ class Builder(object):
         self.configuration = configuration
         self.strategy = strategy
 
-        # create build directory
+        # create build directory. The strategy is passed to the executable at
+        # runtime, so all strategies of a device share one build.
         device_codename = self.strategy.device_configuration['device']['codename']
-        self.build_dir = os.path.join(configuration['build']['directory'], device_codename, self.strategy.get_name())
+        self.build_dir = os.path.join(configuration['build']['directory'], device_codename)
 
         if not os.path.exists(self.build_dir):
             os.makedirs(self.build_dir)
 
-        # create strategy file
         self.strategy_file = os.path.join(self.build_dir, "strategy.h")
-        self.strategy.save_strategy_to_file(self.strategy_file)
 
     def build(self, force):
         if os.path.exists(self.get_executable_path()) and not force:
             logger.info('Executable has already been build.')
             return False
 
+        # create strategy file with the cache geometry of the device
+        self.strategy.save_strategy_to_file(self.strategy_file)
+
         self.build_libflush()
         self.build_executable()
 
@@ -13,6 +13,19 @@ class Executor(object):
         self.builder = builder
         self.device_configuration = self.strategy.device_configuration
 
+    def get_strategy_arguments(self):
+        arguments = [
+            "-e", str(self.strategy.eviction_counter),
+            "-a", str(self.strategy.number_of_accesses_in_loop),
+            "-d", str(self.strategy.different_addresses_in_loop),
+            "-s", str(self.strategy.step_size)
+        ]
+
+        if self.strategy.mirroring:
+            arguments.append("-m")
+
+        return arguments
+
     def run(self, number_of_runs, force):
         local_executable = self.builder.get_executable_path()
 
@@ -75,7 +88,7 @@ class Executor(object):
             "'",
             remote_executable,
             "-n", str(number_of_runs),
-            "-c", "0",
+            "-c", "0"] + self.get_strategy_arguments() + [
             remote_logfile,
             "'"
         ])
@@ -134,7 +147,7 @@ class Executor(object):
     def __run_local(self, local_executable, local_logfile, number_of_runs):
         execute_command([
             local_executable,
-            "-n", str(number_of_runs),
+            "-n", str(number_of_runs)] + self.get_strategy_arguments() + [
             local_logfile
         ])
 
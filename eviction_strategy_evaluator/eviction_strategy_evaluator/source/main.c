@@ -26,6 +26,11 @@ print_help(char* argv[]) {
   fprintf(stdout, "\t-t, -thread-cpu <value>\t Bind thread to cpu (only for thread counter)\n");
   fprintf(stdout, "\t-n, -number-of-measurements <value>\t Number of measurements\n");
   fprintf(stdout, "\t-b, -batch-size <value>\t Batch size\n");
+  fprintf(stdout, "\t-e, -eviction-counter <value>\t Length of the eviction loop\n");
+  fprintf(stdout, "\t-a, -number-of-accesses-in-loop <value>\t Accesses of an address in one loop round\n");
+  fprintf(stdout, "\t-d, -different-addresses-in-loop <value>\t Different addresses in one loop round\n");
+  fprintf(stdout, "\t-s, -step-size <value>\t Increment of the eviction loop\n");
+  fprintf(stdout, "\t-m, -mirroring\t Repeat the eviction loop in reverse order\n");
   fprintf(stdout, "\t-h, -help\t Help page\n");
 }
 
@@ -38,14 +43,20 @@ main(int argc, char* argv[])
   FILE* logfile = NULL;
   uint64_t number_of_runs = NUMBER_OF_RUNS;
   uint64_t batch_size = BATCH_SIZE;
+  libflush_eviction_strategy_t strategy = { 0 };
 
   /* Parse arguments */
-  static const char* short_options = "c:t:n:b:h";
+  static const char* short_options = "c:t:n:b:e:a:d:s:mh";
   static struct option long_options[] = {
     {"cpu",             required_argument, NULL, 'c'},
     {"thread-cpu",      required_argument, NULL, 't'},
     {"number-of-runs",  required_argument, NULL, 'n'},
     {"batch-size",      required_argument, NULL, 'b'},
+    {"eviction-counter",              required_argument, NULL, 'e'},
+    {"number-of-accesses-in-loop",    required_argument, NULL, 'a'},
+    {"different-addresses-in-loop",   required_argument, NULL, 'd'},
+    {"step-size",                     required_argument, NULL, 's'},
+    {"mirroring",                     no_argument, NULL, 'm'},
     {"help",            no_argument, NULL, 'h'},
     { NULL,             0, NULL, 0}
   };
@@ -75,6 +86,21 @@ main(int argc, char* argv[])
       case 'b':
         batch_size = atoi(optarg);
         break;
+      case 'e':
+        strategy.eviction_counter = atoi(optarg);
+        break;
+      case 'a':
+        strategy.number_of_accesses_in_loop = atoi(optarg);
+        break;
+      case 'd':
+        strategy.different_addresses_in_loop = atoi(optarg);
+        break;
+      case 's':
+        strategy.step_size = atoi(optarg);
+        break;
+      case 'm':
+        strategy.mirroring = true;
+        break;
       case 'h':
         print_help(argv);
         return 0;
@@ -111,11 +137,12 @@ main(int argc, char* argv[])
   void* address = (void*) ((size_t) &buffer[1024] & ~(0x3F));
 
   /* Initialize libflush */
-  libflush_session_args_t args;
+  libflush_session_args_t args = { 0 };
   args.bind_to_cpu = thread_cpu;
+  args.eviction_strategy = strategy;
   libflush_session_t* libflush_session;
   if (libflush_init(&libflush_session, &args) == false) {
-    fprintf(stderr, "Error: Could not initialize libflush.\n");
+    fprintf(stderr, "Error: Could not initialize libflush (invalid eviction strategy?).\n");
     return -1;
   }
 
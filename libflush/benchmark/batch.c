@@ -0,0 +1,94 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+typedef uint64_t (*single_function_t)(libflush_session_t* session, void* address);
+typedef void (*batch_function_t)(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+
+typedef struct batch_mapping_s {
+  const char* name;
+  single_function_t single_function;
+  batch_function_t batch_function;
+} batch_mapping_t;
+
+static batch_mapping_t batch_mapping[] = {
+  { "reload",           libflush_reload_address,           libflush_reload_batch },
+  { "reload_and_flush", libflush_reload_address_and_flush, libflush_reload_and_flush_batch },
+  { "flush_time",       libflush_flush_time,               libflush_flush_time_batch },
+  { "prefetch_time",    libflush_prefetch_time,            libflush_prefetch_time_batch },
+};
+
+static double
+samples_per_second(size_t samples, uint64_t duration)
+{
+  return (duration == 0) ? 0 : (double) samples * 1000*1000*1000ULL / duration;
+}
+
+int
+benchmark_batch(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+
+  void** addresses = calloc(n, sizeof(void*));
+  uint64_t* timings = calloc(n, sizeof(uint64_t));
+  if (addresses == NULL || timings == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(addresses);
+    free(timings);
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, addresses);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(addresses);
+    free(timings);
+    return -1;
+  }
+
+  libflush_session_t* libflush_session;
+  if (benchmark_init_session(&libflush_session, options) == false) {
+    benchmark_unmap_lines(buffer, n);
+    free(addresses);
+    free(timings);
+    return -1;
+  }
+
+  fprintf(stdout, "%-20s %18s %18s %8s\n", "Function", "Single [samples/s]",
+      "Batch [samples/s]", "Speedup");
+
+  for (size_t f = 0; f < LENGTH(batch_mapping); f++) {
+    batch_mapping_t* mapping = &(batch_mapping[f]);
+
+    uint64_t start = benchmark_get_time_ns();
+    for (size_t r = 0; r < options->number_of_runs; r++) {
+      for (size_t i = 0; i < n; i++) {
+        timings[i] = mapping->single_function(libflush_session, addresses[i]);
+      }
+    }
+    uint64_t single_duration = benchmark_get_time_ns() - start;
+
+    start = benchmark_get_time_ns();
+    for (size_t r = 0; r < options->number_of_runs; r++) {
+      mapping->batch_function(libflush_session, addresses, n, timings);
+    }
+    uint64_t batch_duration = benchmark_get_time_ns() - start;
+
+    double single = samples_per_second(n * options->number_of_runs, single_duration);
+    double batch = samples_per_second(n * options->number_of_runs, batch_duration);
+
+    fprintf(stdout, "%-20s %18.0f %18.0f %7.2fx\n", mapping->name, single, batch,
+        (single == 0) ? 0 : batch / single);
+  }
+
+  libflush_terminate(libflush_session);
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+  free(timings);
+
+  return 0;
+}
@@ -0,0 +1,141 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <libflush/libflush.h>
+
+#define LENGTH(x) (sizeof(x)/sizeof((x)[0]))
+
+/**
+ * Benchmark options
+ */
+typedef struct benchmark_options_s {
+  size_t cpu; /**< CPU id the benchmark is bound to */
+  size_t thread_cpu; /**< CPU id to bind dedicated thread timer */
+  size_t number_of_runs; /**< Number of repetitions */
+  size_t number_of_addresses; /**< Number of measured addresses */
+} benchmark_options_t;
+
+typedef int (*benchmark_function_t)(const benchmark_options_t* options);
+
+/**
+ * Statistics of a series of measurements
+ */
+typedef struct benchmark_statistics_s {
+  uint64_t minimum; /**< Minimum */
+  uint64_t median; /**< Median */
+  uint64_t maximum; /**< Maximum */
+  double mean; /**< Arithmetic mean */
+  double standard_deviation; /**< Standard deviation */
+} benchmark_statistics_t;
+
+/**
+ * Returns the current time of the monotonic clock in nanoseconds
+ *
+ * @return Time in nanoseconds
+ */
+uint64_t benchmark_get_time_ns(void);
+
+/**
+ * Maps a buffer that holds the given number of cache lines
+ *
+ * @param[in] number_of_lines Number of cache lines
+ * @param[out] addresses Array that receives the address of every line
+ *
+ * @return The mapped buffer or NULL on failure
+ */
+void* benchmark_map_lines(size_t number_of_lines, void** addresses);
+
+/**
+ * Unmaps a buffer returned by benchmark_map_lines or
+ * benchmark_map_aliased_lines
+ *
+ * @param[in] buffer The buffer
+ * @param[in] number_of_lines Number of cache lines
+ */
+void benchmark_unmap_lines(void* buffer, size_t number_of_lines);
+
+/**
+ * Maps a buffer that holds the given number of cache lines, where every page of
+ * the buffer is backed by the same physical page. The lines have distinct
+ * virtual addresses but only occupy the cache sets of a single page.
+ *
+ * @param[in] number_of_lines Number of cache lines
+ * @param[out] addresses Array that receives the address of every line
+ *
+ * @return The mapped buffer or NULL on failure
+ */
+void* benchmark_map_aliased_lines(size_t number_of_lines, void** addresses);
+
+/**
+ * Computes the statistics of a series of measurements. The measurements are
+ * sorted in place.
+ *
+ * @param[in] values The measurements
+ * @param[in] number_of_values The number of measurements
+ * @param[out] statistics The statistics
+ */
+void benchmark_get_statistics(uint64_t* values, size_t number_of_values,
+    benchmark_statistics_t* statistics);
+
+/**
+ * Returns the threshold between the median reload time of a cached and a
+ * flushed line
+ *
+ * @param[in] session The used session
+ * @param[in] address The measured line
+ * @param[in] values Buffer of the measurements
+ * @param[in] number_of_values The number of measurements of either case
+ *
+ * @return The threshold
+ */
+uint64_t benchmark_get_threshold(libflush_session_t* session, void* address,
+    uint64_t* values, size_t number_of_values);
+
+/**
+ * Reads a field of /proc/self/status
+ *
+ * @param[in] field The name of the field, e.g. VmRSS
+ *
+ * @return The value in kB or 0 if the field is not available
+ */
+size_t benchmark_get_status_kilobytes(const char* field);
+
+/**
+ * Initializes a libflush session with the default benchmark arguments
+ *
+ * @param[out] session The initialized session
+ * @param[in] options The benchmark options
+ *
+ * @return true Initialization was successful
+ * @return false Initialization failed
+ */
+bool benchmark_init_session(libflush_session_t** session, const benchmark_options_t* options);
+
+int benchmark_batch(const benchmark_options_t* options);
+int benchmark_inline(const benchmark_options_t* options);
+int benchmark_timing(const benchmark_options_t* options);
+int benchmark_fence(const benchmark_options_t* options);
+int benchmark_flush(const benchmark_options_t* options);
+int benchmark_translate(const benchmark_options_t* options);
+int benchmark_eviction(const benchmark_options_t* options);
+int benchmark_pool(const benchmark_options_t* options);
+int benchmark_strategy(const benchmark_options_t* options);
+int benchmark_jit(const benchmark_options_t* options);
+int benchmark_chain(const benchmark_options_t* options);
+int benchmark_sweep(const benchmark_options_t* options);
+int benchmark_slice(const benchmark_options_t* options);
+int benchmark_discovery(const benchmark_options_t* options);
+int benchmark_metadata(const benchmark_options_t* options);
+int benchmark_profile(const benchmark_options_t* options);
+int benchmark_prepare(const benchmark_options_t* options);
+int benchmark_level(const benchmark_options_t* options);
+int benchmark_numa(const benchmark_options_t* options);
+int benchmark_startup(const benchmark_options_t* options);
+
+#endif /* BENCHMARK_H */
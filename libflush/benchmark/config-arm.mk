@@ -0,0 +1,3 @@
+# See LICENSE file for license and copyright information
+
+LDFLAGS += -pie
@@ -0,0 +1,7 @@
+# See LICENSE file for license and copyright information
+
+INCS += -I../
+
+LIBFLUSH_RELEASE=../${BUILDDIR_RELEASE}/libflush.a
+LIBFLUSH_DEBUG=../${BUILDDIR_DEBUG}/libflush.a
+LIBFLUSH_GCOV=../${BUILDDIR_GCOV}/libflush.a
@@ -0,0 +1,132 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+/* Upper bounds of the associativity from below to above the one of the last
+ * level cache */
+static const size_t associativities[] = { 16, 20, 24 };
+
+/* Every discovery takes tens of milliseconds, so at most this many of the
+ * addresses are used as targets */
+#define MAXIMUM_NUMBER_OF_TARGETS 64
+
+/* Median time of the first eviction of every target, which searches the pool
+ * with the physical addresses from the pagemap */
+static bool
+measure_pagemap(const benchmark_options_t* options, void** targets, size_t n,
+    uint64_t* durations, benchmark_statistics_t* statistics)
+{
+  libflush_session_t* libflush_session;
+  if (benchmark_init_session(&libflush_session, options) == false) {
+    return false;
+  }
+
+  uint64_t page_frame_number;
+  if (libflush_translate_range(libflush_session, (uintptr_t) targets[0], 1,
+        &page_frame_number) == false) {
+    libflush_terminate(libflush_session);
+    return false;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    uint64_t start = benchmark_get_time_ns();
+    libflush_evict(libflush_session, targets[i]);
+    durations[i] = benchmark_get_time_ns() - start;
+  }
+  benchmark_get_statistics(durations, n, statistics);
+
+  libflush_terminate(libflush_session);
+
+  return true;
+}
+
+int
+benchmark_discovery(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+  if (n > MAXIMUM_NUMBER_OF_TARGETS) {
+    n = MAXIMUM_NUMBER_OF_TARGETS;
+  }
+
+  void** targets = calloc(n, sizeof(void*));
+  uint64_t* durations = calloc(n, sizeof(uint64_t));
+  if (targets == NULL || durations == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(targets);
+    free(durations);
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, targets);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(targets);
+    free(durations);
+    return -1;
+  }
+
+  fprintf(stdout, "%-14s %10s %12s %12s %10s %14s\n", "Associativity", "Success",
+      "Median [ms]", "Tests", "Attempts", "Eviction rate");
+
+  for (size_t a = 0; a < LENGTH(associativities); a++) {
+    libflush_session_t* libflush_session;
+    if (benchmark_init_session(&libflush_session, options) == false) {
+      fprintf(stdout, "%-14zu %10s\n", associativities[a], "unavailable");
+      continue;
+    }
+
+    libflush_discovery_args_t args = { 0 };
+    args.associativity = associativities[a];
+
+    size_t found = 0;
+    size_t tests = 0;
+    size_t attempts = 0;
+    size_t evicted = 0;
+
+    for (size_t i = 0; i < n; i++) {
+      libflush_discovery_result_t result = { 0 };
+      if (libflush_discover_eviction_set(libflush_session, targets[i], &args,
+            &result) == true) {
+        durations[found++] = result.duration;
+
+        for (size_t r = 0; r < options->number_of_runs; r++) {
+          libflush_access_memory(targets[i]);
+          libflush_memory_barrier();
+          libflush_evict(libflush_session, targets[i]);
+          if (libflush_reload_address(libflush_session, targets[i]) >= result.threshold) {
+            evicted++;
+          }
+        }
+      }
+
+      tests += result.number_of_tests;
+      attempts += result.number_of_attempts;
+    }
+
+    benchmark_statistics_t statistics;
+    benchmark_get_statistics(durations, found, &statistics);
+
+    fprintf(stdout, "%-14zu %10.3f %12.1f %12.0f %10.2f %14.3f\n", associativities[a],
+        (double) found / n, statistics.median / 1000000.0, (double) tests / n,
+        (double) attempts / n,
+        (found == 0) ? 0 : (double) evicted / (found * options->number_of_runs));
+
+    libflush_terminate(libflush_session);
+  }
+
+  benchmark_statistics_t statistics;
+  if (measure_pagemap(options, targets, n, durations, &statistics) == true) {
+    fprintf(stdout, "%-14s %10.3f %12.3f\n", "pagemap", 1.0, statistics.median / 1000000.0);
+  } else {
+    fprintf(stdout, "%-14s %10s\n", "pagemap", "unavailable");
+  }
+
+  benchmark_unmap_lines(buffer, n);
+  free(targets);
+  free(durations);
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+/* Numbers of distinct addresses that are evicted in turn */
+static const size_t distinct_addresses[] = { 1, 16, 128, 1024, 100000 };
+
+#define NUMBER_OF_EVICTIONS (1000 * 1000)
+
+/* Average time of an eviction if the given number of distinct lines is evicted
+ * in turn. The first round fills the address cache and is not measured. The
+ * lines alias a single physical page, so the eviction sets of the same 64 sets
+ * are used for every number of lines. */
+static bool
+measure_distinct_addresses(libflush_session_t* libflush_session, size_t n, double* average)
+{
+  void** addresses = calloc(n, sizeof(void*));
+  if (addresses == NULL) {
+    return false;
+  }
+
+  void* buffer = benchmark_map_aliased_lines(n, addresses);
+  if (buffer == NULL) {
+    free(addresses);
+    return false;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    libflush_evict(libflush_session, addresses[i]);
+  }
+
+  size_t rounds = (NUMBER_OF_EVICTIONS + n - 1) / n;
+
+  uint64_t start = benchmark_get_time_ns();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < n; i++) {
+      libflush_evict(libflush_session, addresses[i]);
+    }
+  }
+  *average = (double) (benchmark_get_time_ns() - start) / (rounds * n);
+
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+
+  return true;
+}
+
+int
+benchmark_eviction(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+
+  void** addresses = calloc(n, sizeof(void*));
+  if (addresses == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, addresses);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(addresses);
+    return -1;
+  }
+
+  /* Initialization maps the eviction pool */
+  uint64_t start = benchmark_get_time_ns();
+  libflush_session_t* libflush_session;
+  if (benchmark_init_session(&libflush_session, options) == false) {
+    benchmark_unmap_lines(buffer, n);
+    free(addresses);
+    return -1;
+  }
+  uint64_t init = benchmark_get_time_ns() - start;
+
+  /* The first eviction searches the pool for the eviction set */
+  start = benchmark_get_time_ns();
+  libflush_evict(libflush_session, addresses[0]);
+  uint64_t first_evict = benchmark_get_time_ns() - start;
+
+  /* Subsequent evictions of the same address use the cached eviction set */
+  start = benchmark_get_time_ns();
+  libflush_evict(libflush_session, addresses[0]);
+  uint64_t cached_evict = benchmark_get_time_ns() - start;
+
+  /* Eviction sets of the remaining lines, which belong to different sets */
+  start = benchmark_get_time_ns();
+  for (size_t i = 1; i < n; i++) {
+    libflush_evict(libflush_session, addresses[i]);
+  }
+  uint64_t other_evict = benchmark_get_time_ns() - start;
+
+  fprintf(stdout, "%-30s %15s\n", "Operation", "Time [us]");
+  fprintf(stdout, "%-30s %15.1f\n", "libflush_init", init / 1000.0);
+  fprintf(stdout, "%-30s %15.1f\n", "first libflush_evict", first_evict / 1000.0);
+  fprintf(stdout, "%-30s %15.1f\n", "cached libflush_evict", cached_evict / 1000.0);
+  if (n > 1) {
+    fprintf(stdout, "%-30s %15.1f\n", "libflush_evict of a new set",
+        other_evict / 1000.0 / (n - 1));
+  }
+
+  /* Address cache lookups relative to the eviction of a single address */
+  fprintf(stdout, "\n%-30s %15s %15s\n", "Distinct addresses", "Time [ns]", "Overhead [ns]");
+  double single = 0;
+  for (size_t i = 0; i < LENGTH(distinct_addresses); i++) {
+    double average;
+    if (measure_distinct_addresses(libflush_session, distinct_addresses[i], &average) == false) {
+      fprintf(stdout, "%-30zu %15s\n", distinct_addresses[i], "unavailable");
+      continue;
+    }
+
+    if (distinct_addresses[i] == 1) {
+      single = average;
+    }
+
+    fprintf(stdout, "%-30zu %15.1f %15.1f\n", distinct_addresses[i], average, average - single);
+  }
+
+  libflush_terminate(libflush_session);
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char* name;
+  libflush_fence_t fence;
+} fences[] = {
+  { "cpuid",  LIBFLUSH_FENCE_CPUID },
+  { "lfence", LIBFLUSH_FENCE_LFENCE },
+  { "rdtscp", LIBFLUSH_FENCE_RDTSCP },
+  { "mfence", LIBFLUSH_FENCE_MFENCE },
+};
+
+/* Fraction of measurements on the wrong side of the threshold between the
+ * median hit and the median miss. Both arrays must be sorted. */
+static double
+get_error_rate(uint64_t* hits, uint64_t* misses, size_t n, uint64_t threshold)
+{
+  size_t errors = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    if (hits[i] >= threshold) {
+      errors++;
+    }
+    if (misses[i] < threshold) {
+      errors++;
+    }
+  }
+
+  return (double) errors / (2 * n);
+}
+
+int
+benchmark_fence(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_runs * options->number_of_addresses;
+
+  uint64_t* hits = calloc(n, sizeof(uint64_t));
+  uint64_t* misses = calloc(n, sizeof(uint64_t));
+  if (hits == NULL || misses == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(hits);
+    free(misses);
+    return -1;
+  }
+
+  void* address = NULL;
+  void* buffer = benchmark_map_lines(1, &address);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(hits);
+    free(misses);
+    return -1;
+  }
+
+  fprintf(stdout, "%-10s %10s %10s %10s %10s %10s\n", "Fence", "Overhead",
+      "Hit", "Miss", "Threshold", "Error rate");
+
+  for (size_t f = 0; f < LENGTH(fences); f++) {
+    libflush_session_args_t args = { 0 };
+    args.bind_to_cpu = options->thread_cpu;
+    args.time_source = LIBFLUSH_TIME_SOURCE_REGISTER;
+    args.fence = fences[f].fence;
+
+    libflush_session_t* libflush_session;
+    if (libflush_init(&libflush_session, &args) == false) {
+      fprintf(stdout, "%-10s %10s\n", fences[f].name, "unavailable");
+      continue;
+    }
+
+    /* The barriers make sure that the flush has completed before the next
+     * access */
+    for (size_t i = 0; i < n; i++) {
+      libflush_access_memory(address);
+      libflush_memory_barrier();
+      hits[i] = libflush_reload_address_and_flush(libflush_session, address);
+      libflush_memory_barrier();
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      misses[i] = libflush_reload_address_and_flush(libflush_session, address);
+      libflush_memory_barrier();
+    }
+
+    benchmark_statistics_t hit_statistics, miss_statistics;
+    benchmark_get_statistics(hits, n, &hit_statistics);
+    benchmark_get_statistics(misses, n, &miss_statistics);
+
+    uint64_t threshold = (hit_statistics.median + miss_statistics.median) / 2;
+
+    fprintf(stdout, "%-10s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10.4f\n",
+        fences[f].name,
+        libflush_get_overhead(libflush_session, LIBFLUSH_OVERHEAD_TIMING_SERIALIZED),
+        hit_statistics.median, miss_statistics.median, threshold,
+        get_error_rate(hits, misses, n, threshold));
+
+    libflush_terminate(libflush_session);
+  }
+
+  benchmark_unmap_lines(buffer, 1);
+  free(hits);
+  free(misses);
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char* name;
+  libflush_flush_instruction_t instruction;
+} instructions[] = {
+  { "default",    LIBFLUSH_FLUSH_INSTRUCTION_DEFAULT },
+  { "clflush",    LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSH },
+  { "clflushopt", LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSHOPT },
+  { "clwb",       LIBFLUSH_FLUSH_INSTRUCTION_CLWB },
+};
+
+static void
+touch_lines(void** addresses, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    libflush_access_memory(addresses[i]);
+  }
+  libflush_memory_barrier();
+}
+
+int
+benchmark_flush(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+
+  void** addresses = calloc(n, sizeof(void*));
+  if (addresses == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, addresses);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(addresses);
+    return -1;
+  }
+
+  fprintf(stdout, "%-12s %18s %18s %8s\n", "Instruction", "Single [ns/line]",
+      "Range [ns/line]", "Speedup");
+
+  for (size_t f = 0; f < LENGTH(instructions); f++) {
+    libflush_session_args_t args = { 0 };
+    args.bind_to_cpu = options->thread_cpu;
+    args.flush_instruction = instructions[f].instruction;
+
+    libflush_session_t* libflush_session;
+    if (libflush_init(&libflush_session, &args) == false) {
+      fprintf(stdout, "%-12s %18s\n", instructions[f].name, "unavailable");
+      continue;
+    }
+
+    uint64_t single_duration = 0;
+    uint64_t range_duration = 0;
+
+    for (size_t r = 0; r < options->number_of_runs; r++) {
+      touch_lines(addresses, n);
+
+      uint64_t start = benchmark_get_time_ns();
+      for (size_t i = 0; i < n; i++) {
+        libflush_flush(libflush_session, addresses[i]);
+      }
+      libflush_memory_barrier();
+      single_duration += benchmark_get_time_ns() - start;
+
+      touch_lines(addresses, n);
+
+      start = benchmark_get_time_ns();
+      libflush_flush_range(libflush_session, buffer, n * 64);
+      range_duration += benchmark_get_time_ns() - start;
+    }
+
+    size_t lines = n * options->number_of_runs;
+    fprintf(stdout, "%-12s %18.2f %18.2f %8.2f\n", instructions[f].name,
+        (double) single_duration / lines, (double) range_duration / lines,
+        (range_duration == 0) ? 0 : (double) single_duration / range_duration);
+
+    libflush_terminate(libflush_session);
+  }
+
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+
+  return 0;
+}
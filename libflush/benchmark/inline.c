@@ -0,0 +1,135 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <libflush/libflush_inline.h>
+
+#include "benchmark.h"
+
+typedef enum measurement_e {
+  MEASUREMENT_TIMER,
+  MEASUREMENT_RELOAD,
+  MEASUREMENT_RELOAD_AND_FLUSH
+} measurement_t;
+
+static void
+measure_exported(libflush_session_t* session, measurement_t measurement,
+    void* address, uint64_t* values, size_t number_of_values)
+{
+  for (size_t i = 0; i < number_of_values; i++) {
+    switch (measurement) {
+      case MEASUREMENT_TIMER:
+        {
+          uint64_t start = libflush_get_timing(session);
+          values[i] = libflush_get_timing(session) - start;
+        }
+        break;
+      case MEASUREMENT_RELOAD:
+        values[i] = libflush_reload_address(session, address);
+        break;
+      case MEASUREMENT_RELOAD_AND_FLUSH:
+        values[i] = libflush_reload_address_and_flush(session, address);
+        break;
+    }
+  }
+}
+
+static void
+measure_inline(measurement_t measurement, void* address, uint64_t* values,
+    size_t number_of_values)
+{
+  for (size_t i = 0; i < number_of_values; i++) {
+    switch (measurement) {
+      case MEASUREMENT_TIMER:
+        {
+          uint64_t start = libflush_inline_get_timing();
+          values[i] = libflush_inline_get_timing() - start;
+        }
+        break;
+      case MEASUREMENT_RELOAD:
+        values[i] = libflush_inline_reload_address(address);
+        break;
+      case MEASUREMENT_RELOAD_AND_FLUSH:
+#ifdef LIBFLUSH_INLINE_HAVE_FLUSH
+        values[i] = libflush_inline_reload_address_and_flush(address);
+#else
+        values[i] = 0;
+#endif
+        break;
+    }
+  }
+}
+
+static void
+print_statistics(const char* name, const char* variant, uint64_t* values,
+    size_t number_of_values)
+{
+  benchmark_statistics_t statistics;
+  benchmark_get_statistics(values, number_of_values, &statistics);
+
+  fprintf(stdout, "%-20s %-10s %10" PRIu64 " %10" PRIu64 " %10.2f %10.2f\n",
+      name, variant, statistics.minimum, statistics.median, statistics.mean,
+      statistics.standard_deviation);
+}
+
+int
+benchmark_inline(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_runs * options->number_of_addresses;
+
+  uint64_t* values = calloc(n, sizeof(uint64_t));
+  if (values == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    return -1;
+  }
+
+  void* address = NULL;
+  void* buffer = benchmark_map_lines(1, &address);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(values);
+    return -1;
+  }
+
+  libflush_session_t* libflush_session;
+  if (benchmark_init_session(&libflush_session, options) == false) {
+    benchmark_unmap_lines(buffer, 1);
+    free(values);
+    return -1;
+  }
+
+  static const struct {
+    const char* name;
+    measurement_t measurement;
+  } measurements[] = {
+    { "timer",            MEASUREMENT_TIMER },
+    { "reload",           MEASUREMENT_RELOAD },
+    { "reload_and_flush", MEASUREMENT_RELOAD_AND_FLUSH },
+  };
+
+  fprintf(stdout, "%-20s %-10s %10s %10s %10s %10s\n", "Measurement", "Variant",
+      "Minimum", "Median", "Mean", "Std. dev.");
+
+  for (size_t m = 0; m < LENGTH(measurements); m++) {
+#ifndef LIBFLUSH_INLINE_HAVE_FLUSH
+    if (measurements[m].measurement == MEASUREMENT_RELOAD_AND_FLUSH) {
+      continue;
+    }
+#endif
+
+    libflush_access_memory(address);
+    measure_exported(libflush_session, measurements[m].measurement, address, values, n);
+    print_statistics(measurements[m].name, "exported", values, n);
+
+    libflush_access_memory(address);
+    measure_inline(measurements[m].measurement, address, values, n);
+    print_statistics(measurements[m].name, "inline", values, n);
+  }
+
+  libflush_terminate(libflush_session);
+  benchmark_unmap_lines(buffer, 1);
+  free(values);
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char* name;
+  bool jit;
+} backends[] = {
+  { "loop", false },
+  { "jit",  true },
+};
+
+static const struct {
+  const char* name;
+  libflush_eviction_strategy_t strategy;
+} strategies[] = {
+  { "default",  { 28, 5, 4, 1, false } },
+  { "bacon",    { 10, 2, 2, 1, false } },
+  { "zeroflte", { 21, 2, 5, 1, false } },
+  { "generic",  { 20, 3, 3, 1, false } },
+};
+
+#define PROBED_SET 1
+
+int
+benchmark_jit(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_runs * options->number_of_addresses;
+
+  uint64_t* probes = calloc(n, sizeof(uint64_t));
+  if (probes == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    return -1;
+  }
+
+  void* address = NULL;
+  void* buffer = benchmark_map_lines(1, &address);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(probes);
+    return -1;
+  }
+
+  fprintf(stdout, "%-8s %-10s %12s %14s %14s %14s\n", "Backend", "Strategy", "Evict [ns]",
+      "Probe median", "Probe IQR", "Probe stddev");
+
+  for (size_t b = 0; b < LENGTH(backends); b++) {
+    libflush_session_args_t args = { 0 };
+    args.bind_to_cpu = options->thread_cpu;
+    args.eviction_pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+    args.eviction_jit = backends[b].jit;
+    args.fence = LIBFLUSH_FENCE_LFENCE;
+
+    libflush_session_t* libflush_session;
+    if (libflush_init(&libflush_session, &args) == false) {
+      fprintf(stdout, "%-8s %-10s %12s\n", backends[b].name, "", "unavailable");
+      continue;
+    }
+
+    for (size_t s = 0; s < LENGTH(strategies); s++) {
+      if (libflush_set_eviction_strategy(libflush_session, &(strategies[s].strategy)) == false) {
+        fprintf(stdout, "%-8s %-10s %12s\n", backends[b].name, strategies[s].name, "unavailable");
+        continue;
+      }
+
+      /* The first eviction builds and compiles the eviction set */
+      libflush_evict(libflush_session, address);
+
+      uint64_t start = benchmark_get_time_ns();
+      for (size_t i = 0; i < n; i++) {
+        libflush_evict(libflush_session, address);
+      }
+      double evict = (double) (benchmark_get_time_ns() - start) / n;
+
+      /* Probes of a primed set, which should all hit */
+      libflush_prime(libflush_session, PROBED_SET);
+      libflush_probe(libflush_session, PROBED_SET);
+      for (size_t i = 0; i < n; i++) {
+        libflush_prime(libflush_session, PROBED_SET);
+        probes[i] = libflush_probe(libflush_session, PROBED_SET);
+      }
+
+      benchmark_statistics_t statistics;
+      benchmark_get_statistics(probes, n, &statistics);
+
+      /* The interquartile range is not dominated by interrupted probes */
+      uint64_t interquartile_range = probes[(3 * n) / 4] - probes[n / 4];
+
+      fprintf(stdout, "%-8s %-10s %12.1f %14" PRIu64 " %14" PRIu64 " %14.1f\n",
+          backends[b].name, strategies[s].name, evict, statistics.median,
+          interquartile_range, statistics.standard_deviation);
+    }
+
+    libflush_terminate(libflush_session);
+  }
+
+  benchmark_unmap_lines(buffer, 1);
+  free(probes);
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+/* Caches of the geometry that are listed */
+#define NUMBER_OF_CACHES 8
+
+/* Average time of an eviction and median reload time of the address after the
+ * eviction. A level of 0 is the eviction with libflush_evict. */
+static bool
+measure_level(libflush_session_t* libflush_session, void** addresses, size_t n,
+    size_t runs, unsigned int level, uint64_t* reloads, double* average,
+    benchmark_statistics_t* statistics)
+{
+  /* The first round builds the eviction sets and is not measured */
+  for (size_t i = 0; i < n; i++) {
+    if (level == 0) {
+      libflush_evict(libflush_session, addresses[i]);
+    } else if (libflush_evict_level(libflush_session, addresses[i], level) == false) {
+      return false;
+    }
+  }
+
+  uint64_t duration = 0;
+  for (size_t r = 0; r < runs; r++) {
+    for (size_t i = 0; i < n; i++) {
+      libflush_access_memory(addresses[i]);
+      libflush_memory_barrier();
+
+      uint64_t start = benchmark_get_time_ns();
+      if (level == 0) {
+        libflush_evict(libflush_session, addresses[i]);
+      } else {
+        libflush_evict_level(libflush_session, addresses[i], level);
+      }
+      duration += benchmark_get_time_ns() - start;
+
+      reloads[r * n + i] = libflush_reload_address(libflush_session, addresses[i]);
+    }
+  }
+
+  *average = (double) duration / (runs * n);
+  benchmark_get_statistics(reloads, runs * n, statistics);
+
+  return true;
+}
+
+int
+benchmark_level(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+  size_t runs = options->number_of_runs;
+
+  void** addresses = calloc(n, sizeof(void*));
+  uint64_t* reloads = calloc(n * runs, sizeof(uint64_t));
+  if (addresses == NULL || reloads == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(addresses);
+    free(reloads);
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, addresses);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(addresses);
+    free(reloads);
+    return -1;
+  }
+
+  libflush_session_t* libflush_session;
+  if (benchmark_init_session(&libflush_session, options) == false) {
+    benchmark_unmap_lines(buffer, n);
+    free(addresses);
+    free(reloads);
+    return -1;
+  }
+
+  /* Reload time of a cached address as a reference */
+  for (size_t i = 0; i < n * runs; i++) {
+    libflush_access_memory(addresses[i % n]);
+    libflush_memory_barrier();
+    reloads[i] = libflush_reload_address(libflush_session, addresses[i % n]);
+  }
+  benchmark_statistics_t statistics;
+  benchmark_get_statistics(reloads, n * runs, &statistics);
+
+  fprintf(stdout, "%-16s %10s %10s %16s %16s\n", "Level", "Sets", "Counter", "Eviction [ns]",
+      "Reload [median]");
+  fprintf(stdout, "%-16s %10s %10s %16s %16" PRIu64 "\n", "cached", "", "", "",
+      statistics.median);
+
+  libflush_cache_geometry_t caches[NUMBER_OF_CACHES];
+  size_t number_of_caches = libflush_get_cache_geometry(libflush_session, caches,
+      NUMBER_OF_CACHES);
+  if (number_of_caches > NUMBER_OF_CACHES) {
+    number_of_caches = NUMBER_OF_CACHES;
+  }
+
+  for (size_t c = 0; c < number_of_caches; c++) {
+    if (caches[c].type == LIBFLUSH_CACHE_TYPE_INSTRUCTION) {
+      continue;
+    }
+
+    char name[16];
+    snprintf(name, sizeof(name), "L%u", caches[c].level);
+
+    double average;
+    if (measure_level(libflush_session, addresses, n, runs, caches[c].level, reloads,
+          &average, &statistics) == false) {
+      fprintf(stdout, "%-16s %10s\n", name, "unavailable");
+      continue;
+    }
+
+    libflush_eviction_strategy_t strategy;
+    libflush_get_level_eviction_strategy(libflush_session, caches[c].level, &strategy);
+    fprintf(stdout, "%-16s %10zu %10zu %16.1f %16" PRIu64 "\n", name,
+        libflush_get_level_number_of_sets(libflush_session, caches[c].level),
+        strategy.eviction_counter, average, statistics.median);
+  }
+
+  double average;
+  if (measure_level(libflush_session, addresses, n, runs, 0, reloads, &average,
+        &statistics) == true) {
+    fprintf(stdout, "%-16s %10zu %10s %16.1f %16" PRIu64 "\n", "libflush_evict",
+        libflush_get_number_of_sets(libflush_session), "", average, statistics.median);
+  }
+
+  libflush_terminate(libflush_session);
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+  free(reloads);
+
+  return 0;
+}
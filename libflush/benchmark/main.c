@@ -0,0 +1,151 @@
+/* See LICENSE file for license and copyright information */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "benchmark.h"
+
+#define BIND_TO_CPU 0
+#define BIND_THREAD_TO_CPU 1
+#define NUMBER_OF_RUNS 100
+#define NUMBER_OF_ADDRESSES 4096
+
+#define _STR(x) #x
+#define STR(x) _STR(x)
+
+typedef struct benchmark_mapping_s {
+  const char* name;
+  const char* description;
+  benchmark_function_t function;
+} benchmark_mapping_t;
+
+static benchmark_mapping_t benchmark_mapping[] = {
+  { "batch", "Single address API compared to the batch API", benchmark_batch },
+  { "inline", "Exported primitives compared to the inline fast path", benchmark_inline },
+  { "timing", "Resolution and overhead of every time source", benchmark_timing },
+  { "fence", "Overhead and hit/miss separation of every x86 fence profile", benchmark_fence },
+  { "flush", "Single flushes compared to flushing a range with every flush instruction", benchmark_flush },
+  { "translate", "Virtual to physical address translation with and without the translation cache", benchmark_translate },
+  { "eviction", "Initialization and eviction set lookup latency", benchmark_eviction },
+  { "pool", "Construction time and memory overhead of the eviction pool per page size", benchmark_pool },
+  { "strategy", "Eviction time of runtime strategies and a sweep over many strategies", benchmark_strategy },
+  { "jit", "Eviction time and probe timing variance of compiled eviction routines", benchmark_jit },
+  { "chain", "Eviction rate of array and pointer-chasing access of eviction sets", benchmark_chain },
+  { "sweep", "Prime+Probe maps of all sets with a call per set and with a sweep", benchmark_sweep },
+  { "slice", "Eviction rate of slice-aware eviction sets per number of slices", benchmark_slice },
+  { "discovery", "Construction time of eviction sets by timing compared to the pagemap", benchmark_discovery },
+  { "metadata", "Time and resident memory of a session and of the eviction sets of all sets", benchmark_metadata },
+  { "profile", "Cold and warm start of a session with a persistent pool and set index profile", benchmark_profile },
+  { "prepare", "Latency of the first evictions of new sets with and without preparing them", benchmark_prepare },
+  { "level", "Eviction time and reload latency of the eviction sets of every cache level", benchmark_level },
+  { "numa", "Eviction time and reload latency with the eviction pool on every NUMA node", benchmark_numa },
+  { "startup", "Session startup time and resident memory of every population of the eviction pool", benchmark_startup },
+};
+
+static void
+print_help(char* argv[]) {
+  fprintf(stdout, "Usage: %s [OPTIONS] <benchmark>\n", argv[0]);
+  fprintf(stdout, "\t-c, -cpu <value>\t Bind to cpu (default: " STR(BIND_TO_CPU) ")\n");
+  fprintf(stdout, "\t-t, -thread-cpu <value>\t Bind thread to cpu (only for thread counter) (default: " STR(BIND_THREAD_TO_CPU) ")\n");
+  fprintf(stdout, "\t-r, -runs <value>\t Number of runs (default: " STR(NUMBER_OF_RUNS) ")\n");
+  fprintf(stdout, "\t-n, -addresses <value>\t Number of addresses (default: " STR(NUMBER_OF_ADDRESSES) ")\n");
+  fprintf(stdout, "\t-h, -help\t\t Help page\n");
+  fprintf(stdout, "\nBenchmarks:\n");
+  for (size_t i = 0; i < LENGTH(benchmark_mapping); i++) {
+    fprintf(stdout, "\t%-20s %s\n", benchmark_mapping[i].name, benchmark_mapping[i].description);
+  }
+}
+
+int
+main(int argc, char* argv[])
+{
+  /* Define parameters */
+  benchmark_options_t options = {
+    .cpu = BIND_TO_CPU,
+    .thread_cpu = BIND_THREAD_TO_CPU,
+    .number_of_runs = NUMBER_OF_RUNS,
+    .number_of_addresses = NUMBER_OF_ADDRESSES
+  };
+
+  /* Parse arguments */
+  static const char* short_options = "c:t:r:n:h";
+  static struct option long_options[] = {
+    {"cpu",             required_argument, NULL, 'c'},
+    {"thread-cpu",      required_argument, NULL, 't'},
+    {"runs",            required_argument, NULL, 'r'},
+    {"addresses",       required_argument, NULL, 'n'},
+    {"help",            no_argument,       NULL, 'h'},
+    { NULL,             0, NULL, 0}
+  };
+
+  size_t number_of_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  int c;
+  while ((c = getopt_long(argc, argv, short_options, long_options, NULL)) != -1) {
+    switch (c) {
+      case 'c':
+        options.cpu = atoi(optarg);
+        if (options.cpu >= number_of_cpus) {
+          fprintf(stderr, "Error: CPU %zu is not available.\n", options.cpu);
+          return -1;
+        }
+        break;
+      case 't':
+        options.thread_cpu = atoi(optarg);
+        if (options.thread_cpu >= number_of_cpus) {
+          fprintf(stderr, "Error: CPU %zu is not available.\n", options.thread_cpu);
+          return -1;
+        }
+        break;
+      case 'r':
+        options.number_of_runs = atoi(optarg);
+        break;
+      case 'n':
+        options.number_of_addresses = atoi(optarg);
+        break;
+      case 'h':
+        print_help(argv);
+        return 0;
+      case ':':
+        fprintf(stderr, "Error: option `-%c' requires an argument\n", optopt);
+        break;
+      case '?':
+      default:
+        fprintf(stderr, "Error: Invalid option '-%c'\n", optopt);
+        return -1;
+    }
+  }
+
+  if (optind >= argc) {
+    print_help(argv);
+    return -1;
+  }
+
+  if (options.number_of_runs == 0 || options.number_of_addresses == 0) {
+    fprintf(stderr, "Error: Number of runs and addresses must be positive.\n");
+    return -1;
+  }
+
+  /* Bind to CPU */
+  options.cpu = options.cpu % number_of_cpus;
+  options.thread_cpu = options.thread_cpu % number_of_cpus;
+
+  if (libflush_bind_to_cpu(options.cpu) == false) {
+    fprintf(stderr, "Warning: Could not bind to CPU: %zu\n", options.cpu);
+  }
+
+  /* Run benchmark */
+  for (size_t i = 0; i < LENGTH(benchmark_mapping); i++) {
+    if (strcmp(argv[optind], benchmark_mapping[i].name) == 0) {
+      return benchmark_mapping[i].function(&options);
+    }
+  }
+
+  fprintf(stderr, "Error: Invalid benchmark '%s'\n", argv[optind]);
+  return -1;
+}
@@ -0,0 +1,115 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+enum {
+  STAGE_INIT,
+  STAGE_FIRST_SET,
+  STAGE_ALL_SETS,
+  STAGE_TERMINATE,
+  NUMBER_OF_STAGES
+};
+
+static const char* stage_names[NUMBER_OF_STAGES] = {
+  "libflush_init",
+  "first set",
+  "all sets",
+  "libflush_terminate",
+};
+
+/* Huge TLB pages are not part of the resident set */
+static size_t
+get_resident_kilobytes(void)
+{
+  return benchmark_get_status_kilobytes("VmRSS") + benchmark_get_status_kilobytes("HugetlbPages");
+}
+
+/* Median time of every stage of a session. The resident memory is taken from
+ * the first run, as the allocator keeps freed memory for later runs. The pool
+ * is populated by the initialization, so the resident memory that later stages
+ * add is the metadata of the eviction sets. */
+int
+benchmark_metadata(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_runs;
+
+  uint64_t* durations[NUMBER_OF_STAGES];
+  for (size_t s = 0; s < NUMBER_OF_STAGES; s++) {
+    durations[s] = calloc(n, sizeof(uint64_t));
+  }
+
+  size_t resident[NUMBER_OF_STAGES] = { 0 };
+  size_t number_of_sets = 0;
+  int result = 0;
+
+  for (size_t r = 0; r < n && result == 0; r++) {
+    for (size_t s = 0; s < NUMBER_OF_STAGES; s++) {
+      if (durations[s] == NULL) {
+        fprintf(stderr, "Error: Out of memory\n");
+        result = -1;
+      }
+    }
+    if (result != 0) {
+      break;
+    }
+
+    libflush_session_t* libflush_session = NULL;
+    for (size_t s = 0; s < NUMBER_OF_STAGES; s++) {
+      size_t before = get_resident_kilobytes();
+      uint64_t start = benchmark_get_time_ns();
+
+      switch (s) {
+        case STAGE_INIT:
+          if (benchmark_init_session(&libflush_session, options) == false) {
+            result = -1;
+          }
+          break;
+        case STAGE_FIRST_SET:
+          /* The first eviction set computes the set indices of the whole pool */
+          libflush_prime(libflush_session, 0);
+          break;
+        case STAGE_ALL_SETS:
+          number_of_sets = libflush_get_number_of_sets(libflush_session);
+          libflush_prime_all(libflush_session, number_of_sets);
+          break;
+        case STAGE_TERMINATE:
+          libflush_terminate(libflush_session);
+          break;
+      }
+
+      durations[s][r] = benchmark_get_time_ns() - start;
+      if (r == 0 && s != STAGE_TERMINATE) {
+        resident[s] = get_resident_kilobytes() - before;
+      }
+
+      if (result != 0) {
+        break;
+      }
+    }
+  }
+
+  if (result == 0) {
+    fprintf(stdout, "%-30s %12s %16s\n", "Stage", "Time [ms]", "Resident [KiB]");
+    for (size_t s = 0; s < NUMBER_OF_STAGES; s++) {
+      benchmark_statistics_t statistics;
+      benchmark_get_statistics(durations[s], n, &statistics);
+
+      char name[64];
+      if (s == STAGE_ALL_SETS) {
+        snprintf(name, sizeof(name), "all %zu sets", number_of_sets);
+      } else {
+        snprintf(name, sizeof(name), "%s", stage_names[s]);
+      }
+      fprintf(stdout, "%-30s %12.2f %16zu\n", name, statistics.median / 1000000.0, resident[s]);
+    }
+  }
+
+  for (size_t s = 0; s < NUMBER_OF_STAGES; s++) {
+    free(durations[s]);
+  }
+
+  return result;
+}
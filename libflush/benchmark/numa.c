@@ -0,0 +1,119 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+/* Nodes whose pools are measured if they are online */
+#define MAXIMUM_NUMBER_OF_NODES 64
+
+/* Average time of an eviction and median reload time of the address after the
+ * eviction with a pool on the given node. The first round builds the eviction
+ * sets and is not measured. */
+static bool
+measure_node(const benchmark_options_t* options, void** addresses, size_t n,
+    libflush_eviction_node_t node_selection, unsigned int node, uint64_t* reloads,
+    int* pool_node, double* average, benchmark_statistics_t* statistics)
+{
+  libflush_session_args_t args = { 0 };
+  args.bind_to_cpu = options->thread_cpu;
+  args.eviction_node = node_selection;
+  args.eviction_node_id = node;
+
+  libflush_session_t* libflush_session;
+  if (libflush_init(&libflush_session, &args) == false) {
+    return false;
+  }
+
+  *pool_node = libflush_get_eviction_node(libflush_session);
+
+  for (size_t i = 0; i < n; i++) {
+    libflush_evict(libflush_session, addresses[i]);
+  }
+
+  uint64_t duration = 0;
+  for (size_t r = 0; r < options->number_of_runs; r++) {
+    for (size_t i = 0; i < n; i++) {
+      libflush_access_memory(addresses[i]);
+      libflush_memory_barrier();
+
+      uint64_t start = benchmark_get_time_ns();
+      libflush_evict(libflush_session, addresses[i]);
+      duration += benchmark_get_time_ns() - start;
+
+      reloads[r * n + i] = libflush_reload_address(libflush_session, addresses[i]);
+    }
+  }
+
+  *average = (double) duration / (options->number_of_runs * n);
+  benchmark_get_statistics(reloads, options->number_of_runs * n, statistics);
+
+  libflush_terminate(libflush_session);
+
+  return true;
+}
+
+static void
+print_node(const char* name, int pool_node, double average,
+    const benchmark_statistics_t* statistics)
+{
+  fprintf(stdout, "%-10s %10d %16.1f %16" PRIu64 "\n", name, pool_node, average,
+      statistics->median);
+}
+
+int
+benchmark_numa(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+
+  void** addresses = calloc(n, sizeof(void*));
+  uint64_t* reloads = calloc(n * options->number_of_runs, sizeof(uint64_t));
+  if (addresses == NULL || reloads == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(addresses);
+    free(reloads);
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, addresses);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(addresses);
+    free(reloads);
+    return -1;
+  }
+
+  fprintf(stdout, "Node of the targets: %d\n\n", libflush_get_address_node(addresses[0]));
+  fprintf(stdout, "%-10s %10s %16s %16s\n", "Pool", "Node", "Eviction [ns]",
+      "Reload [median]");
+
+  int pool_node;
+  double average;
+  benchmark_statistics_t statistics;
+  if (measure_node(options, addresses, n, LIBFLUSH_EVICTION_NODE_ANY, 0, reloads,
+        &pool_node, &average, &statistics) == true) {
+    print_node("any", pool_node, average, &statistics);
+  }
+
+  if (measure_node(options, addresses, n, LIBFLUSH_EVICTION_NODE_LOCAL, 0, reloads,
+        &pool_node, &average, &statistics) == true) {
+    print_node("local", pool_node, average, &statistics);
+  }
+
+  /* Sessions with a pool on an offline node fail to initialize */
+  for (unsigned int node = 0; node < MAXIMUM_NUMBER_OF_NODES; node++) {
+    if (measure_node(options, addresses, n, LIBFLUSH_EVICTION_NODE_FIXED, node, reloads,
+          &pool_node, &average, &statistics) == true) {
+      char name[16];
+      snprintf(name, sizeof(name), "node %u", node);
+      print_node(name, pool_node, average, &statistics);
+    }
+  }
+
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+  free(reloads);
+
+  return 0;
+}
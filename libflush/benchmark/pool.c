@@ -0,0 +1,68 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char* name;
+  libflush_eviction_pages_t pages;
+} eviction_pages[] = {
+  { "small",            LIBFLUSH_EVICTION_PAGES_SMALL },
+  { "transparent_huge", LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE },
+  { "huge",             LIBFLUSH_EVICTION_PAGES_HUGE },
+};
+
+static const char*
+get_eviction_pages_name(libflush_eviction_pages_t pages)
+{
+  for (size_t i = 0; i < LENGTH(eviction_pages); i++) {
+    if (eviction_pages[i].pages == pages) {
+      return eviction_pages[i].name;
+    }
+  }
+
+  return "unknown";
+}
+
+int
+benchmark_pool(const benchmark_options_t* options)
+{
+  fprintf(stdout, "%-18s %-18s %10s %10s %12s %16s\n", "Pages", "Backing",
+      "Init [ms]", "Index [ms]", "Memory [KiB]", "Page tables [KiB]");
+
+  for (size_t p = 0; p < LENGTH(eviction_pages); p++) {
+    libflush_session_args_t args = { 0 };
+    args.bind_to_cpu = options->thread_cpu;
+    args.eviction_pages = eviction_pages[p].pages;
+
+    /* Huge TLB pages are not part of the resident set */
+    size_t resident = benchmark_get_status_kilobytes("VmRSS") + benchmark_get_status_kilobytes("HugetlbPages");
+    size_t page_tables = benchmark_get_status_kilobytes("VmPTE");
+
+    /* Maps and populates the pool */
+    uint64_t start = benchmark_get_time_ns();
+    libflush_session_t* libflush_session;
+    if (libflush_init(&libflush_session, &args) == false) {
+      fprintf(stdout, "%-18s %-18s\n", eviction_pages[p].name, "unavailable");
+      continue;
+    }
+    uint64_t init = benchmark_get_time_ns() - start;
+
+    /* The first eviction set computes the set indices of the whole pool */
+    start = benchmark_get_time_ns();
+    libflush_prime(libflush_session, 0);
+    uint64_t index = benchmark_get_time_ns() - start;
+
+    fprintf(stdout, "%-18s %-18s %10.2f %10.2f %12zu %16zu\n", eviction_pages[p].name,
+        get_eviction_pages_name(libflush_get_eviction_pages(libflush_session)),
+        init / 1000000.0, index / 1000000.0,
+        benchmark_get_status_kilobytes("VmRSS") + benchmark_get_status_kilobytes("HugetlbPages") - resident,
+        benchmark_get_status_kilobytes("VmPTE") - page_tables);
+
+    libflush_terminate(libflush_session);
+  }
+
+  return 0;
+}
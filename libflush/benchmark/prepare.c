@@ -0,0 +1,89 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+/* Times of the first eviction of every address, optionally after the eviction
+ * sets have been prepared in the background */
+static bool
+measure_first_evictions(const benchmark_options_t* options, void** addresses, size_t n,
+    bool prepare, uint64_t* durations, uint64_t* preparation)
+{
+  libflush_session_t* libflush_session;
+  if (benchmark_init_session(&libflush_session, options) == false) {
+    return false;
+  }
+
+  *preparation = 0;
+  if (prepare == true) {
+    uint64_t start = benchmark_get_time_ns();
+    if (libflush_prepare_eviction_sets(libflush_session, addresses, n) == false) {
+      libflush_terminate(libflush_session);
+      return false;
+    }
+    libflush_wait_eviction_sets(libflush_session);
+    *preparation = benchmark_get_time_ns() - start;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    uint64_t start = benchmark_get_time_ns();
+    libflush_evict(libflush_session, addresses[i]);
+    durations[i] = benchmark_get_time_ns() - start;
+  }
+
+  libflush_terminate(libflush_session);
+
+  return true;
+}
+
+int
+benchmark_prepare(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+
+  void** addresses = calloc(n, sizeof(void*));
+  uint64_t* durations = calloc(n, sizeof(uint64_t));
+  if (addresses == NULL || durations == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(addresses);
+    free(durations);
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, addresses);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(addresses);
+    free(durations);
+    return -1;
+  }
+
+  fprintf(stdout, "%-12s %16s %16s %16s\n", "Sets", "Prepare [us]",
+      "Median [us]", "Maximum [us]");
+
+  for (size_t p = 0; p < 2; p++) {
+    bool prepare = (p == 1);
+    const char* name = prepare ? "prepared" : "on demand";
+
+    uint64_t preparation;
+    if (measure_first_evictions(options, addresses, n, prepare, durations,
+          &preparation) == false) {
+      fprintf(stdout, "%-12s %16s\n", name, "unavailable");
+      continue;
+    }
+
+    benchmark_statistics_t statistics;
+    benchmark_get_statistics(durations, n, &statistics);
+
+    fprintf(stdout, "%-12s %16.1f %16.1f %16.1f\n", name, preparation / 1000.0,
+        statistics.median / 1000.0, statistics.maximum / 1000.0);
+  }
+
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+  free(durations);
+
+  return 0;
+}
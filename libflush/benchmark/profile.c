@@ -0,0 +1,120 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "benchmark.h"
+
+/* Directories of the pool file. The profile is kept in /tmp, as files on
+ * hugetlbfs cannot be written. */
+static const struct {
+  const char* name;
+  const char* directory;
+} pool_directories[] = {
+  { "anonymous", NULL },
+  { "tmpfs",     "/dev/shm" },
+  { "hugetlbfs", "/dev/hugepages" },
+};
+
+static const char* state_names[] = { "none", "missing", "loaded", "invalid" };
+
+/* Time of the initialization and of the first eviction of a session */
+static bool
+measure_start(const benchmark_options_t* options, const char* pool_file,
+    const char* profile_file, uint64_t* init, uint64_t* first,
+    libflush_eviction_profile_state_t* state)
+{
+  libflush_session_args_t args = { 0 };
+  args.bind_to_cpu = options->thread_cpu;
+  args.eviction_pool_file = pool_file;
+  args.eviction_profile_file = profile_file;
+
+  uint64_t start = benchmark_get_time_ns();
+  libflush_session_t* libflush_session;
+  if (libflush_init(&libflush_session, &args) == false) {
+    return false;
+  }
+  *init = benchmark_get_time_ns() - start;
+
+  int x;
+  start = benchmark_get_time_ns();
+  libflush_evict(libflush_session, &x);
+  *first = benchmark_get_time_ns() - start;
+
+  *state = libflush_get_eviction_profile_state(libflush_session);
+  libflush_terminate(libflush_session);
+
+  return true;
+}
+
+/* Cold start with a new pool file and profile, followed by warm starts that
+ * reuse both */
+int
+benchmark_profile(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_runs;
+
+  uint64_t* inits = calloc(n, sizeof(uint64_t));
+  uint64_t* firsts = calloc(n, sizeof(uint64_t));
+  if (inits == NULL || firsts == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(inits);
+    free(firsts);
+    return -1;
+  }
+
+  fprintf(stdout, "%-12s %-6s %-8s %10s %18s\n", "Pool", "Start", "Profile", "Init [ms]",
+      "First evict [ms]");
+
+  for (size_t d = 0; d < LENGTH(pool_directories); d++) {
+    char pool_file[64] = { 0 };
+    char profile_file[64];
+    snprintf(profile_file, sizeof(profile_file), "/tmp/libflush-profile-%d", (int) getpid());
+    unlink(profile_file);
+
+    if (pool_directories[d].directory != NULL) {
+      snprintf(pool_file, sizeof(pool_file), "%s/libflush-pool-%d",
+          pool_directories[d].directory, (int) getpid());
+    }
+
+    uint64_t init, first;
+    libflush_eviction_profile_state_t state;
+    if (measure_start(options, (pool_file[0] != 0) ? pool_file : NULL, profile_file, &init,
+          &first, &state) == false) {
+      fprintf(stdout, "%-12s %-6s\n", pool_directories[d].name, "unavailable");
+      unlink(profile_file);
+      continue;
+    }
+
+    fprintf(stdout, "%-12s %-6s %-8s %10.2f %18.2f\n", pool_directories[d].name, "cold",
+        state_names[state], init / 1000000.0, first / 1000000.0);
+
+    size_t runs = 0;
+    for (size_t r = 0; r < n; r++) {
+      if (measure_start(options, (pool_file[0] != 0) ? pool_file : NULL, profile_file,
+            &(inits[runs]), &(firsts[runs]), &state) == true) {
+        runs++;
+      }
+    }
+
+    benchmark_statistics_t init_statistics, first_statistics;
+    benchmark_get_statistics(inits, runs, &init_statistics);
+    benchmark_get_statistics(firsts, runs, &first_statistics);
+
+    fprintf(stdout, "%-12s %-6s %-8s %10.2f %18.2f\n", pool_directories[d].name, "warm",
+        state_names[state], init_statistics.median / 1000000.0,
+        first_statistics.median / 1000000.0);
+
+    if (pool_file[0] != 0) {
+      unlink(pool_file);
+    }
+    unlink(profile_file);
+  }
+
+  free(inits);
+  free(firsts);
+
+  return 0;
+}
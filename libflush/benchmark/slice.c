@@ -0,0 +1,101 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char* name;
+  libflush_slice_hash_t slice_hash;
+  size_t number_of_slices;
+} slice_hashes[] = {
+  { "none",     LIBFLUSH_SLICE_HASH_NONE,  1 },
+  { "intel 2",  LIBFLUSH_SLICE_HASH_INTEL, 2 },
+  { "intel 4",  LIBFLUSH_SLICE_HASH_INTEL, 4 },
+  { "intel 8",  LIBFLUSH_SLICE_HASH_INTEL, 8 },
+};
+
+/* Eviction counters from the associativity of a slice up to the default
+ * strategy */
+static const size_t eviction_counters[] = { 12, 16, 20, 24, 28 };
+
+#define NUMBER_OF_ACCESSES_IN_LOOP 5
+#define DIFFERENT_ADDRESSES_IN_LOOP 4
+
+int
+benchmark_slice(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_runs * options->number_of_addresses;
+
+  uint64_t* values = calloc(n, sizeof(uint64_t));
+  if (values == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    return -1;
+  }
+
+  void* address = NULL;
+  void* buffer = benchmark_map_lines(1, &address);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(values);
+    return -1;
+  }
+
+  fprintf(stdout, "%-10s %8s %14s %12s %14s\n", "Slices", "Counter", "Eviction rate",
+      "Time [ns]", "Rate per us");
+
+  for (size_t s = 0; s < LENGTH(slice_hashes); s++) {
+    libflush_session_args_t args = { 0 };
+    args.bind_to_cpu = options->thread_cpu;
+    args.fence = LIBFLUSH_FENCE_LFENCE;
+    args.slice_hash = slice_hashes[s].slice_hash;
+    args.number_of_slices = slice_hashes[s].number_of_slices;
+
+    libflush_session_t* libflush_session;
+    if (libflush_init(&libflush_session, &args) == false) {
+      fprintf(stdout, "%-10s %8s\n", slice_hashes[s].name, "unavailable");
+      continue;
+    }
+
+    uint64_t threshold = benchmark_get_threshold(libflush_session, address, values, n);
+
+    for (size_t c = 0; c < LENGTH(eviction_counters); c++) {
+      libflush_eviction_strategy_t strategy = { eviction_counters[c],
+        NUMBER_OF_ACCESSES_IN_LOOP, DIFFERENT_ADDRESSES_IN_LOOP, 1, false };
+      if (libflush_set_eviction_strategy(libflush_session, &strategy) == false) {
+        continue;
+      }
+
+      /* The first eviction builds the eviction set */
+      libflush_evict(libflush_session, address);
+
+      size_t evicted = 0;
+      uint64_t duration = 0;
+      for (size_t i = 0; i < n; i++) {
+        libflush_access_memory(address);
+        libflush_memory_barrier();
+
+        uint64_t start = benchmark_get_time_ns();
+        libflush_evict(libflush_session, address);
+        duration += benchmark_get_time_ns() - start;
+
+        if (libflush_reload_address(libflush_session, address) >= threshold) {
+          evicted++;
+        }
+      }
+
+      double rate = (double) evicted / n;
+      double time = (double) duration / n;
+      fprintf(stdout, "%-10s %8zu %14.3f %12.1f %14.3f\n", slice_hashes[s].name,
+          eviction_counters[c], rate, time, (time == 0) ? 0 : rate * 1000 / time);
+    }
+
+    libflush_terminate(libflush_session);
+  }
+
+  benchmark_unmap_lines(buffer, 1);
+  free(values);
+
+  return 0;
+}
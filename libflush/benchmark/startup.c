@@ -0,0 +1,130 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char* name;
+  libflush_eviction_population_t population;
+  bool touch;
+} populations[] = {
+  { "serial+touch", LIBFLUSH_EVICTION_POPULATION_SERIAL,      true },
+  { "serial",       LIBFLUSH_EVICTION_POPULATION_SERIAL,      false },
+  { "parallel",     LIBFLUSH_EVICTION_POPULATION_PARALLEL,    false },
+  { "incremental",  LIBFLUSH_EVICTION_POPULATION_INCREMENTAL, false },
+};
+
+/* Every start maps a new pool, which takes long for large pools, so at most
+ * this many starts are measured */
+#define MAXIMUM_NUMBER_OF_STARTS 16
+
+/* Time of the initialization, of the first eviction and of the eviction of
+ * the given addresses, and the resident memory after the first eviction */
+static bool
+measure_start(const benchmark_options_t* options, libflush_eviction_population_t population,
+    bool touch, void** addresses, size_t n, uint64_t* init, uint64_t* first,
+    uint64_t* all, size_t* resident)
+{
+  libflush_session_args_t args = { 0 };
+  args.bind_to_cpu = options->thread_cpu;
+  args.eviction_population = population;
+  args.eviction_touch = touch;
+
+  size_t resident_before = benchmark_get_status_kilobytes("VmRSS");
+
+  uint64_t start = benchmark_get_time_ns();
+  libflush_session_t* libflush_session;
+  if (libflush_init(&libflush_session, &args) == false) {
+    return false;
+  }
+  *init = benchmark_get_time_ns() - start;
+
+  start = benchmark_get_time_ns();
+  libflush_evict(libflush_session, addresses[0]);
+  *first = benchmark_get_time_ns() - start;
+
+  *resident = benchmark_get_status_kilobytes("VmRSS") - resident_before;
+
+  start = benchmark_get_time_ns();
+  for (size_t i = 1; i < n; i++) {
+    libflush_evict(libflush_session, addresses[i]);
+  }
+  *all = benchmark_get_time_ns() - start;
+
+  libflush_terminate(libflush_session);
+
+  return true;
+}
+
+int
+benchmark_startup(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_addresses;
+  size_t runs = options->number_of_runs;
+  if (runs > MAXIMUM_NUMBER_OF_STARTS) {
+    runs = MAXIMUM_NUMBER_OF_STARTS;
+  }
+
+  void** addresses = calloc(n, sizeof(void*));
+  uint64_t* inits = calloc(runs, sizeof(uint64_t));
+  uint64_t* firsts = calloc(runs, sizeof(uint64_t));
+  uint64_t* alls = calloc(runs, sizeof(uint64_t));
+  if (addresses == NULL || inits == NULL || firsts == NULL || alls == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    free(addresses);
+    free(inits);
+    free(firsts);
+    free(alls);
+    return -1;
+  }
+
+  void* buffer = benchmark_map_lines(n, addresses);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(addresses);
+    free(inits);
+    free(firsts);
+    free(alls);
+    return -1;
+  }
+
+  fprintf(stdout, "%-14s %12s %18s %18s %14s\n", "Population", "Init [ms]",
+      "First evict [ms]", "Other evicts [ms]", "Resident [MB]");
+
+  for (size_t p = 0; p < LENGTH(populations); p++) {
+    size_t resident = 0;
+    size_t r = 0;
+    for (; r < runs; r++) {
+      if (measure_start(options, populations[p].population, populations[p].touch, addresses,
+            n, &(inits[r]), &(firsts[r]), &(alls[r]), &resident) == false) {
+        break;
+      }
+    }
+
+    if (r < runs) {
+      fprintf(stdout, "%-14s %12s\n", populations[p].name, "unavailable");
+      continue;
+    }
+
+    benchmark_statistics_t init;
+    benchmark_statistics_t first;
+    benchmark_statistics_t all;
+    benchmark_get_statistics(inits, runs, &init);
+    benchmark_get_statistics(firsts, runs, &first);
+    benchmark_get_statistics(alls, runs, &all);
+
+    fprintf(stdout, "%-14s %12.2f %18.2f %18.2f %14.1f\n", populations[p].name,
+        init.median / 1000000.0, first.median / 1000000.0, all.median / 1000000.0,
+        resident / 1024.0);
+  }
+
+  benchmark_unmap_lines(buffer, n);
+  free(addresses);
+  free(inits);
+  free(firsts);
+  free(alls);
+
+  return 0;
+}
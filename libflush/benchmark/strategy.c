@@ -0,0 +1,108 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+/* Strategies of the shipped device configurations */
+static const struct {
+  const char* name;
+  libflush_eviction_strategy_t strategy;
+} strategies[] = {
+  { "default",    { 28, 5, 4, 1, false } },
+  { "alto45",     { 16, 1, 6, 1, false } },
+  { "bacon",      { 10, 2, 2, 1, false } },
+  { "mako",       { 12, 1, 2, 1, false } },
+  { "zeroflte",   { 21, 2, 5, 1, false } },
+  { "generic",    { 20, 3, 3, 1, false } },
+  { "mirrored",   { 10, 2, 2, 1, true } },
+};
+
+#define MAXIMUM_EVICTION_COUNTER 32
+#define MAXIMUM_ACCESSES_IN_LOOP 6
+#define MAXIMUM_DIFFERENT_ADDRESSES_IN_LOOP 6
+#define MAXIMUM_STEP_SIZE 2
+
+static double
+measure_strategy(libflush_session_t* libflush_session, void* address, size_t runs)
+{
+  libflush_evict(libflush_session, address);
+
+  uint64_t start = benchmark_get_time_ns();
+  for (size_t r = 0; r < runs; r++) {
+    libflush_evict(libflush_session, address);
+  }
+
+  return (double) (benchmark_get_time_ns() - start) / runs;
+}
+
+int
+benchmark_strategy(const benchmark_options_t* options)
+{
+  void* address = NULL;
+  void* buffer = benchmark_map_lines(1, &address);
+  if (buffer == NULL) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    return -1;
+  }
+
+  libflush_session_args_t args = { 0 };
+  args.bind_to_cpu = options->thread_cpu;
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+
+  libflush_session_t* libflush_session;
+  if (libflush_init(&libflush_session, &args) == false) {
+    fprintf(stderr, "Error: Could not initialize libflush.\n");
+    benchmark_unmap_lines(buffer, 1);
+    return -1;
+  }
+
+  size_t runs = options->number_of_runs * options->number_of_addresses;
+
+  fprintf(stdout, "%-12s %-20s %15s\n", "Strategy", "C-A-D-S", "Time [ns]");
+  for (size_t i = 0; i < LENGTH(strategies); i++) {
+    const libflush_eviction_strategy_t* strategy = &(strategies[i].strategy);
+    if (libflush_set_eviction_strategy(libflush_session, strategy) == false) {
+      fprintf(stdout, "%-12s %-20s %15s\n", strategies[i].name, "", "unavailable");
+      continue;
+    }
+
+    char shape[32];
+    snprintf(shape, sizeof(shape), "%zu-%zu-%zu-%zu%s", strategy->eviction_counter,
+        strategy->number_of_accesses_in_loop, strategy->different_addresses_in_loop,
+        strategy->step_size, strategy->mirroring ? "-M" : "");
+
+    fprintf(stdout, "%-12s %-20s %15.1f\n", strategies[i].name, shape,
+        measure_strategy(libflush_session, address, runs));
+  }
+
+  /* Sweep over all strategies within the bounds in a single binary */
+  size_t number_of_strategies = 0;
+  uint64_t start = benchmark_get_time_ns();
+  for (size_t c = 1; c <= MAXIMUM_EVICTION_COUNTER; c++) {
+    for (size_t a = 1; a <= MAXIMUM_ACCESSES_IN_LOOP; a++) {
+      for (size_t d = 1; d <= MAXIMUM_DIFFERENT_ADDRESSES_IN_LOOP; d++) {
+        for (size_t s = 1; s <= MAXIMUM_STEP_SIZE; s++) {
+          for (size_t m = 0; m < 2; m++) {
+            libflush_eviction_strategy_t strategy = { c, a, d, s, m == 1 };
+            if (libflush_evict_strategy(libflush_session, address, &strategy) == true) {
+              number_of_strategies++;
+            }
+          }
+        }
+      }
+    }
+  }
+  uint64_t duration = benchmark_get_time_ns() - start;
+
+  fprintf(stdout, "\nSwept %zu strategies in %.2f ms (%.1f us per strategy)\n",
+      number_of_strategies, duration / 1000000.0,
+      (number_of_strategies == 0) ? 0 : duration / 1000.0 / number_of_strategies);
+
+  libflush_set_eviction_strategy(libflush_session, NULL);
+  libflush_terminate(libflush_session);
+  benchmark_unmap_lines(buffer, 1);
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "benchmark.h"
+
+/* Sets whose probe takes longer than this multiple of the median probe of the
+ * map are counted as evicted by the sweep itself */
+#define SLOW_PROBE_FACTOR 2
+
+typedef bool (*sample_function_t)(libflush_session_t* session, uint64_t* times,
+    size_t number_of_sets);
+
+/* Primes and probes every set with a call per set in ascending order */
+static bool
+sample_per_set(libflush_session_t* session, uint64_t* times, size_t number_of_sets)
+{
+  for (size_t i = 0; i < number_of_sets; i++) {
+    libflush_prime(session, i);
+  }
+
+  for (size_t i = 0; i < number_of_sets; i++) {
+    times[i] = libflush_probe(session, i);
+  }
+
+  return true;
+}
+
+static bool
+sample_sweep(libflush_session_t* session, uint64_t* times, size_t number_of_sets)
+{
+  return libflush_prime_all(session, number_of_sets) == true &&
+    libflush_probe_all(session, times, number_of_sets) == true;
+}
+
+static const struct {
+  const char* name;
+  sample_function_t sample;
+} methods[] = {
+  { "per set", sample_per_set },
+  { "sweep",   sample_sweep },
+};
+
+int
+benchmark_sweep(const benchmark_options_t* options)
+{
+  libflush_session_args_t args = { 0 };
+  args.bind_to_cpu = options->thread_cpu;
+  args.fence = LIBFLUSH_FENCE_LFENCE;
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+
+  libflush_session_t* libflush_session;
+  if (libflush_init(&libflush_session, &args) == false) {
+    fprintf(stderr, "Error: Could not initialize libflush.\n");
+    return -1;
+  }
+
+  size_t number_of_sets = libflush_get_number_of_sets(libflush_session);
+  uint64_t* times = calloc(number_of_sets, sizeof(uint64_t));
+  if (times == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    libflush_terminate(libflush_session);
+    return -1;
+  }
+
+  fprintf(stdout, "%-10s %14s %14s %14s %12s\n", "Method", "Map [us]", "Maps/s",
+      "Probe median", "Slow sets");
+
+  for (size_t m = 0; m < LENGTH(methods); m++) {
+    /* The first map builds the eviction sets of all sets */
+    methods[m].sample(libflush_session, times, number_of_sets);
+
+    size_t slow = 0;
+    uint64_t median = 0;
+    uint64_t duration = 0;
+    for (size_t r = 0; r < options->number_of_runs; r++) {
+      uint64_t start = benchmark_get_time_ns();
+      methods[m].sample(libflush_session, times, number_of_sets);
+      duration += benchmark_get_time_ns() - start;
+
+      benchmark_statistics_t statistics;
+      benchmark_get_statistics(times, number_of_sets, &statistics);
+      median += statistics.median;
+      for (size_t i = 0; i < number_of_sets; i++) {
+        if (times[i] > SLOW_PROBE_FACTOR * statistics.median) {
+          slow++;
+        }
+      }
+    }
+
+    double map = (double) duration / options->number_of_runs / 1000.0;
+    fprintf(stdout, "%-10s %14.1f %14.0f %14" PRIu64 " %11.2f%%\n", methods[m].name, map,
+        (map == 0) ? 0 : 1000 * 1000 / map, median / options->number_of_runs,
+        100.0 * slow / (number_of_sets * options->number_of_runs));
+  }
+
+  free(times);
+  libflush_terminate(libflush_session);
+
+  return 0;
+}
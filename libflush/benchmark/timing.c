@@ -0,0 +1,165 @@
+/* See LICENSE file for license and copyright information */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "benchmark.h"
+
+static const struct {
+  const char* name;
+  libflush_time_source_t source;
+} time_sources[] = {
+  { "register",         LIBFLUSH_TIME_SOURCE_REGISTER },
+  { "perf",             LIBFLUSH_TIME_SOURCE_PERF },
+  { "monotonic_clock",  LIBFLUSH_TIME_SOURCE_MONOTONIC_CLOCK },
+  { "thread_counter",   LIBFLUSH_TIME_SOURCE_THREAD_COUNTER },
+};
+
+static const char*
+get_time_source_name(libflush_time_source_t source)
+{
+  for (size_t i = 0; i < LENGTH(time_sources); i++) {
+    if (time_sources[i].source == source) {
+      return time_sources[i].name;
+    }
+  }
+
+  return "unknown";
+}
+
+/* Reads the cycle counter with a read system call per time stamp, which is
+ * what the perf time source falls back to without rdpmc access. */
+static bool
+measure_perf_read(uint64_t* values, size_t number_of_values, uint64_t* duration)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_CPU_CYCLES;
+  attr.size = sizeof(attr);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  uint64_t start = benchmark_get_time_ns();
+  for (size_t i = 0; i < number_of_values; i++) {
+    uint64_t first = 0, second = 0;
+    if (read(fd, &first, sizeof(first)) != sizeof(first) ||
+        read(fd, &second, sizeof(second)) != sizeof(second)) {
+      close(fd);
+      return false;
+    }
+    values[i] = second - first;
+  }
+  *duration = benchmark_get_time_ns() - start;
+
+  close(fd);
+
+  return true;
+}
+
+static void
+print_statistics(const char* name, uint64_t* values, size_t number_of_values,
+    uint64_t duration, double ns_per_tick)
+{
+  benchmark_statistics_t statistics;
+  benchmark_get_statistics(values, number_of_values, &statistics);
+
+  fprintf(stdout, "%-20s %10" PRIu64 " %10" PRIu64 " %10.2f %10.2f %12.2f %10.4f\n",
+      name, statistics.minimum, statistics.median, statistics.mean,
+      statistics.standard_deviation, (double) duration / (2 * number_of_values),
+      ns_per_tick);
+}
+
+int
+benchmark_timing(const benchmark_options_t* options)
+{
+  size_t n = options->number_of_runs * options->number_of_addresses;
+
+  uint64_t* values = calloc(n, sizeof(uint64_t));
+  if (values == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    return -1;
+  }
+
+  fprintf(stdout, "%-20s %10s %10s %10s %10s %12s %10s\n", "Time source", "Minimum",
+      "Median", "Mean", "Std. dev.", "ns per read", "ns/tick");
+
+  for (size_t s = 0; s < LENGTH(time_sources); s++) {
+    libflush_session_args_t args = { 0 };
+    args.bind_to_cpu = options->thread_cpu;
+    args.time_source = time_sources[s].source;
+
+    libflush_session_t* libflush_session;
+    if (libflush_init(&libflush_session, &args) == false) {
+      fprintf(stdout, "%-20s %10s\n", time_sources[s].name, "unavailable");
+      continue;
+    }
+
+    /* Difference of two consecutive reads */
+    uint64_t start = benchmark_get_time_ns();
+    for (size_t i = 0; i < n; i++) {
+      uint64_t time = libflush_get_timing(libflush_session);
+      values[i] = libflush_get_timing(libflush_session) - time;
+    }
+    uint64_t duration = benchmark_get_time_ns() - start;
+
+    print_statistics(time_sources[s].name, values, n, duration,
+        libflush_timing_to_ns(libflush_session, 1000*1000) / (1000.0*1000));
+
+    libflush_terminate(libflush_session);
+  }
+
+  uint64_t duration;
+  if (measure_perf_read(values, n, &duration) == true) {
+    print_statistics("perf (read)", values, n, duration, 0);
+  } else {
+    fprintf(stdout, "%-20s %10s\n", "perf (read)", "unavailable");
+  }
+
+  /* Calibrated overhead of the measurement windows */
+  fprintf(stdout, "\n%-20s %10s %10s\n", "Time source", "Overhead", "Serialized");
+
+  for (size_t s = 0; s < LENGTH(time_sources); s++) {
+    libflush_session_args_t args = { 0 };
+    args.bind_to_cpu = options->thread_cpu;
+    args.time_source = time_sources[s].source;
+
+    libflush_session_t* libflush_session;
+    if (libflush_init(&libflush_session, &args) == false) {
+      continue;
+    }
+
+    fprintf(stdout, "%-20s %10" PRIu64 " %10" PRIu64 "\n", time_sources[s].name,
+        libflush_get_overhead(libflush_session, LIBFLUSH_OVERHEAD_TIMING),
+        libflush_get_overhead(libflush_session, LIBFLUSH_OVERHEAD_TIMING_SERIALIZED));
+
+    libflush_terminate(libflush_session);
+  }
+
+  /* Automatic selection */
+  libflush_session_args_t args = { 0 };
+  args.bind_to_cpu = options->thread_cpu;
+  args.time_source = LIBFLUSH_TIME_SOURCE_AUTO;
+
+  libflush_session_t* libflush_session;
+  if (libflush_init(&libflush_session, &args) == true) {
+    fprintf(stdout, "\nAutomatically selected time source: %s\n",
+        get_time_source_name(libflush_get_time_source(libflush_session)));
+    libflush_terminate(libflush_session);
+  }
+
+  free(values);
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+
+#include "benchmark.h"
+
+#define PAGE_SIZE 4096
+#define LINES_PER_PAGE (PAGE_SIZE / 64)
+
+static double
+translations_per_second(size_t translations, uint64_t duration)
+{
+  return (duration == 0) ? 0 : (double) translations * 1000*1000*1000ULL / duration;
+}
+
+int
+benchmark_translate(const benchmark_options_t* options)
+{
+  size_t number_of_pages = options->number_of_addresses;
+  size_t size = number_of_pages * PAGE_SIZE;
+
+  uint64_t* page_frame_numbers = calloc(number_of_pages, sizeof(uint64_t));
+  if (page_frame_numbers == NULL) {
+    fprintf(stderr, "Error: Out of memory\n");
+    return -1;
+  }
+
+  uint8_t* buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+      MAP_POPULATE | MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (buffer == MAP_FAILED) {
+    fprintf(stderr, "Error: Could not map memory.\n");
+    free(page_frame_numbers);
+    return -1;
+  }
+
+  libflush_session_t* libflush_session;
+  if (benchmark_init_session(&libflush_session, options) == false) {
+    munmap(buffer, size);
+    free(page_frame_numbers);
+    return -1;
+  }
+
+  if (libflush_translate_range(libflush_session, (uintptr_t) buffer, number_of_pages,
+        page_frame_numbers) == false) {
+    fprintf(stderr, "Error: Could not read the pagemap.\n");
+    libflush_terminate(libflush_session);
+    munmap(buffer, size);
+    free(page_frame_numbers);
+    return -1;
+  }
+
+  size_t lines = number_of_pages * LINES_PER_PAGE * options->number_of_runs;
+
+  /* One pagemap read per line, as without the translation cache */
+  uint64_t start = benchmark_get_time_ns();
+  for (size_t r = 0; r < options->number_of_runs; r++) {
+    for (size_t i = 0; i < size; i += 64) {
+      libflush_invalidate_translations(libflush_session, buffer + i, 64);
+      libflush_get_physical_address(libflush_session, (uintptr_t) buffer + i);
+    }
+  }
+  uint64_t uncached = benchmark_get_time_ns() - start;
+
+  /* One pagemap read per page */
+  start = benchmark_get_time_ns();
+  for (size_t r = 0; r < options->number_of_runs; r++) {
+    libflush_invalidate_translations(libflush_session, NULL, 0);
+    for (size_t i = 0; i < size; i += 64) {
+      libflush_get_physical_address(libflush_session, (uintptr_t) buffer + i);
+    }
+  }
+  uint64_t cached = benchmark_get_time_ns() - start;
+
+  /* One pagemap read per range */
+  start = benchmark_get_time_ns();
+  for (size_t r = 0; r < options->number_of_runs; r++) {
+    libflush_translate_range(libflush_session, (uintptr_t) buffer, number_of_pages,
+        page_frame_numbers);
+  }
+  uint64_t range = benchmark_get_time_ns() - start;
+
+  fprintf(stdout, "%-30s %20s\n", "Method", "Translations/s");
+  fprintf(stdout, "%-30s %20.0f\n", "per line (uncached)", translations_per_second(lines, uncached));
+  fprintf(stdout, "%-30s %20.0f\n", "per line (cached)", translations_per_second(lines, cached));
+  fprintf(stdout, "%-30s %20.0f\n", "translate_range (pages)",
+      translations_per_second(number_of_pages * options->number_of_runs, range));
+
+  libflush_terminate(libflush_session);
+  munmap(buffer, size);
+  free(page_frame_numbers);
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+/* See LICENSE file for license and copyright information */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "benchmark.h"
+
+#define LINE_LENGTH 64
+#define PAGE_SIZE 4096
+
+uint64_t
+benchmark_get_time_ns(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000*1000*1000ULL + t.tv_nsec;
+}
+
+void*
+benchmark_map_lines(size_t number_of_lines, void** addresses)
+{
+  void* buffer = mmap(NULL, number_of_lines * LINE_LENGTH, PROT_READ | PROT_WRITE,
+      MAP_POPULATE | MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (buffer == MAP_FAILED) {
+    return NULL;
+  }
+
+  for (size_t i = 0; i < number_of_lines; i++) {
+    addresses[i] = (uint8_t*) buffer + i * LINE_LENGTH;
+  }
+
+  return buffer;
+}
+
+void*
+benchmark_map_aliased_lines(size_t number_of_lines, void** addresses)
+{
+  size_t size = ((number_of_lines * LINE_LENGTH + PAGE_SIZE - 1) / PAGE_SIZE) * PAGE_SIZE;
+
+  int fd = memfd_create("benchmark", 0);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  if (ftruncate(fd, PAGE_SIZE) != 0) {
+    close(fd);
+    return NULL;
+  }
+
+  uint8_t* buffer = mmap(NULL, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (buffer == MAP_FAILED) {
+    close(fd);
+    return NULL;
+  }
+
+  for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+    if (mmap(buffer + offset, PAGE_SIZE, PROT_READ | PROT_WRITE,
+          MAP_FIXED | MAP_POPULATE | MAP_SHARED, fd, 0) == MAP_FAILED) {
+      munmap(buffer, size);
+      close(fd);
+      return NULL;
+    }
+  }
+
+  close(fd);
+
+  for (size_t i = 0; i < number_of_lines; i++) {
+    addresses[i] = buffer + i * LINE_LENGTH;
+  }
+
+  return buffer;
+}
+
+void
+benchmark_unmap_lines(void* buffer, size_t number_of_lines)
+{
+  if (buffer != NULL) {
+    munmap(buffer, number_of_lines * LINE_LENGTH);
+  }
+}
+
+static int
+compare_values(const void* a, const void* b)
+{
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
+
+  return (x > y) - (x < y);
+}
+
+void
+benchmark_get_statistics(uint64_t* values, size_t number_of_values,
+    benchmark_statistics_t* statistics)
+{
+  memset(statistics, 0, sizeof(benchmark_statistics_t));
+
+  if (number_of_values == 0) {
+    return;
+  }
+
+  qsort(values, number_of_values, sizeof(uint64_t), compare_values);
+
+  double sum = 0;
+  for (size_t i = 0; i < number_of_values; i++) {
+    sum += values[i];
+  }
+
+  statistics->minimum = values[0];
+  statistics->median = values[number_of_values / 2];
+  statistics->maximum = values[number_of_values - 1];
+  statistics->mean = sum / number_of_values;
+
+  double variance = 0;
+  for (size_t i = 0; i < number_of_values; i++) {
+    double delta = values[i] - statistics->mean;
+    variance += delta * delta;
+  }
+
+  statistics->standard_deviation = sqrt(variance / number_of_values);
+}
+
+uint64_t
+benchmark_get_threshold(libflush_session_t* session, void* address, uint64_t* values,
+    size_t number_of_values)
+{
+  benchmark_statistics_t hit_statistics, miss_statistics;
+
+  for (size_t i = 0; i < number_of_values; i++) {
+    libflush_access_memory(address);
+    libflush_memory_barrier();
+    values[i] = libflush_reload_address(session, address);
+  }
+  benchmark_get_statistics(values, number_of_values, &hit_statistics);
+
+  for (size_t i = 0; i < number_of_values; i++) {
+    libflush_flush(session, address);
+    libflush_memory_barrier();
+    values[i] = libflush_reload_address(session, address);
+  }
+  benchmark_get_statistics(values, number_of_values, &miss_statistics);
+
+  return (hit_statistics.median + miss_statistics.median) / 2;
+}
+
+size_t
+benchmark_get_status_kilobytes(const char* field)
+{
+  FILE* status = fopen("/proc/self/status", "r");
+  if (status == NULL) {
+    return 0;
+  }
+
+  size_t length = strlen(field);
+  size_t kilobytes = 0;
+
+  char line[256];
+  while (fgets(line, sizeof(line), status) != NULL) {
+    if (strncmp(line, field, length) == 0 && line[length] == ':') {
+      sscanf(line + length + 1, "%zu", &kilobytes);
+      break;
+    }
+  }
+
+  fclose(status);
+
+  return kilobytes;
+}
+
+bool
+benchmark_init_session(libflush_session_t** session, const benchmark_options_t* options)
+{
+  libflush_session_args_t args = { 0 };
+  args.bind_to_cpu = options->thread_cpu;
+
+  if (libflush_init(session, &args) == false) {
+    fprintf(stderr, "Error: Could not initialize libflush\n");
+    return false;
+  }
+
+  return true;
+}
@@ -10,10 +10,10 @@ LIBFLUSH_VERSION_REV   = 1
 VERSION = ${LIBFLUSH_VERSION_MAJOR}.${LIBFLUSH_VERSION_MINOR}.${LIBFLUSH_VERSION_REV}
 
 # If the API changes, the API version and the ABI version have to be bumped.
-LIBFLUSH_VERSION_API = 1
+LIBFLUSH_VERSION_API = 2
 
 # If the ABI breaks for any reason, this has to be bumped.
-LIBFLUSH_VERSION_ABI = 1
+LIBFLUSH_VERSION_ABI = 2
 
 # Rules for the SOMAJOR and SOMINOR.
 # Before a release check perform the following checks against the last release:
@@ -23,7 +23,7 @@ LIBFLUSH_VERSION_ABI = 1
 # 	bump SOMAJOR and set SOMINOR to 0.
 # * If a function has been added bump SOMINOR.
 
-SOMAJOR = 1
+SOMAJOR = 2
 SOMINOR = 0
 SOVERSION = ${SOMAJOR}.${SOMINOR}
 
@@ -96,11 +96,11 @@ WITH_PTHREAD ?= 0
 HAVE_PAGEMAP_ACCESS ?= 1
 
 # time sources
-TIME_SOURCES = (register perf monotonic_clock thread_counter)
+TIME_SOURCES = (register perf monotonic_clock thread_counter auto)
 TIME_SOURCE ?= register
 
 # use eviction instead of flush
 USE_EVICTION ?= 0
 
-# Define device
-DEVICE_CONFIGURATION ?= default
+# Define device (0: detect the cache geometry at runtime)
+DEVICE_CONFIGURATION ?= 0
@@ -3,7 +3,7 @@
 #ifndef ARM_V8_FLUSH_H
 #define ARM_V8_FLUSH_H
 
-inline void arm_v8_flush(void* address)
+static inline void arm_v8_flush(void* address)
 {
   asm volatile ("DC CIVAC, %0" :: "r"(address));
   asm volatile ("DSB ISH");
@@ -3,10 +3,55 @@
 #ifndef LIBFLUSH_EVICTION_CONFIGURATION_H
 #define LIBFLUSH_EVICTION_CONFIGURATION_H
 
+/* Initial and maximal number of slots of the virtual address cache (powers of
+ * two). The cache grows while it is filled up to three quarters and replaces
+ * entries once it has reached its maximal size, where it is only filled up to
+ * three eighths. Entries of discovered eviction sets are not replaced, so it
+ * only grows further if it holds nothing else. */
 #define ADDRESS_CACHE_SIZE 128
+#define ADDRESS_CACHE_MAX_SIZE (128 * 1024)
 
+/* Geometry of the evicted cache if the device configuration does not define
+ * it and the last-level cache is not detected (powers of two) */
+#define DEFAULT_LINE_LENGTH_LOG2 6
+#define DEFAULT_NUMBER_OF_SETS 4096
+
+/* A fixed size pool holds this many lines of every set, otherwise the pool is
+ * a fraction of the physical memory */
+#ifndef USE_FIXED_MEMORY_SIZE
 #define USE_FIXED_MEMORY_SIZE 1
-#define PHYSICAL_MEMORY_MAPPED_SIZE (10 * 1024 * 1024)
+#endif
+#define PHYSICAL_MEMORY_MAPPED_LINES_PER_SET 64
+
+/* Default strategy of the eviction sets of the cache levels below the evicted
+ * cache. The eviction counter is the associativity of the level. */
+#define LEVEL_ES_NUMBER_OF_ACCESSES_IN_LOOP 2
+#define LEVEL_ES_DIFFERENT_ADDRESSES_IN_LOOP 2
 #define FRACTION_OF_PHYSICAL_MEMORY 0.1
 
+/* Number of threads that populate the eviction pool if built with pthread
+ * support (0: number of online CPUs), and size of the chunks of the pool that
+ * are populated at once, which is also the first region of an incrementally
+ * populated pool (multiple of the huge page size) */
+#define POPULATE_NUMBER_OF_THREADS 0
+#define POPULATE_CHUNK_SIZE (16 * 1024 * 1024)
+
+/* Number of threads that build the set index table of the eviction pool if
+ * built with pthread support (0: number of online CPUs) */
+#define SET_INDEX_NUMBER_OF_THREADS 0
+
+/* Number of sets whose lines are translated to validate a loaded profile of
+ * the set indices of the eviction pool */
+#define PROFILE_VALIDATION_SAMPLES 64
+
+/* Timing-based discovery of eviction sets: maximal number of discovered sets of
+ * a session, default upper bound of the associativity, number of attempts and
+ * verification rounds, and number of rounds of every eviction test, of which
+ * the majority decides */
+#define DISCOVERY_MAXIMUM_SETS 1024
+#define DISCOVERY_ASSOCIATIVITY 24
+#define DISCOVERY_NUMBER_OF_ATTEMPTS 4
+#define DISCOVERY_VERIFICATION_ROUNDS 16
+#define DISCOVERY_TEST_ROUNDS 5
+
 #endif // LIBFLUSH_EVICTION_CONFIGURATION_H
@@ -0,0 +1,379 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "discovery.h"
+#include "configuration.h"
+
+/* Passes over a candidate set in every eviction test */
+#define DISCOVERY_TRAVERSALS 4
+
+#define DISCOVERY_PAGE_SIZE 4096
+
+/* Retried reduction steps after which a reduction is given up */
+#define DISCOVERY_MAXIMUM_BACKTRACKS 32
+
+/* Reload times measured for the calibration of the threshold */
+#define DISCOVERY_CALIBRATION_ROUNDS 31
+
+static uint64_t
+get_time_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t) now.tv_sec * 1000 * 1000 * 1000 + now.tv_nsec;
+}
+
+/* xorshift64* */
+static uint64_t
+next_random(uint64_t* state)
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545f4914f6cdd1dULL;
+}
+
+static int
+compare_times(const void* a, const void* b)
+{
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
+
+  return (x > y) - (x < y);
+}
+
+/* Accesses the lines of the set except the ones from skip_begin to skip_end */
+static void
+traverse(void** lines, size_t number_of_lines, size_t skip_begin, size_t skip_end)
+{
+  for (size_t pass = 0; pass < DISCOVERY_TRAVERSALS; pass++) {
+    for (size_t i = 0; i < skip_begin; i++) {
+      libflush_access_memory(lines[i]);
+    }
+    for (size_t i = skip_end; i < number_of_lines; i++) {
+      libflush_access_memory(lines[i]);
+    }
+  }
+}
+
+/* Reload time of the line after the set has been accessed. The set spans many
+ * pages, so a line in the other half of the page of the line, which belongs to
+ * another set, is accessed first to reload its translation. Otherwise the TLB
+ * miss would be taken for an eviction. */
+static uint64_t
+measure(libflush_eviction_discovery_t* discovery, void* line, void** lines,
+    size_t number_of_lines, size_t skip_begin, size_t skip_end)
+{
+  libflush_access_memory(line);
+  libflush_memory_barrier();
+  traverse(lines, number_of_lines, skip_begin, skip_end);
+  libflush_access_memory((void*) ((uintptr_t) line ^ (DISCOVERY_PAGE_SIZE / 2)));
+  libflush_memory_barrier();
+
+  return libflush_reload_address(discovery->session, line);
+}
+
+static bool
+is_expired(libflush_eviction_discovery_t* discovery)
+{
+  if (discovery->aborted == false && discovery->deadline != 0 &&
+      get_time_ns() >= discovery->deadline) {
+    discovery->aborted = true;
+  }
+
+  return discovery->aborted;
+}
+
+/* Whether the set evicts the line in the majority of DISCOVERY_TEST_ROUNDS */
+static bool
+evicts(libflush_eviction_discovery_t* discovery, void* line, void** lines,
+    size_t number_of_lines, size_t skip_begin, size_t skip_end)
+{
+  if (is_expired(discovery) == true) {
+    return false;
+  }
+
+  discovery->result.number_of_tests++;
+
+  unsigned int evicted = 0;
+  for (unsigned int i = 0; i < DISCOVERY_TEST_ROUNDS; i++) {
+    if (measure(discovery, line, lines, number_of_lines, skip_begin, skip_end) >
+        discovery->result.threshold) {
+      evicted++;
+    }
+  }
+
+  return 2 * evicted > DISCOVERY_TEST_ROUNDS;
+}
+
+/* The threshold lies between the median reload time of the target after the
+ * lines in the other half of the pages of the candidates have been accessed
+ * and the one after all candidates have been accessed. The former belong to
+ * other sets, but cause the same number of TLB misses and memory accesses.
+ * All candidates may evict the target from further cache levels than a
+ * minimal set, so the threshold is closer to the former. */
+static bool
+calibrate(libflush_eviction_discovery_t* discovery, void** candidates,
+    size_t number_of_candidates)
+{
+  uint64_t hits[DISCOVERY_CALIBRATION_ROUNDS];
+  uint64_t misses[DISCOVERY_CALIBRATION_ROUNDS];
+
+  void** lines = calloc(number_of_candidates, sizeof(void*));
+  if (lines == NULL) {
+    return false;
+  }
+
+  for (size_t i = 0; i < number_of_candidates; i++) {
+    lines[i] = (void*) ((uintptr_t) candidates[i] ^ (DISCOVERY_PAGE_SIZE / 2));
+  }
+
+  for (size_t i = 0; i < DISCOVERY_CALIBRATION_ROUNDS; i++) {
+    hits[i] = measure(discovery, discovery->target, lines, number_of_candidates,
+        number_of_candidates, number_of_candidates);
+    misses[i] = measure(discovery, discovery->target, candidates, number_of_candidates,
+        number_of_candidates, number_of_candidates);
+  }
+
+  free(lines);
+
+  qsort(hits, DISCOVERY_CALIBRATION_ROUNDS, sizeof(uint64_t), compare_times);
+  qsort(misses, DISCOVERY_CALIBRATION_ROUNDS, sizeof(uint64_t), compare_times);
+
+  uint64_t hit = hits[DISCOVERY_CALIBRATION_ROUNDS / 2];
+  uint64_t miss = misses[DISCOVERY_CALIBRATION_ROUNDS / 2];
+  if (miss <= hit) {
+    return false;
+  }
+
+  discovery->result.threshold = (3 * hit + miss) / 4;
+
+  return true;
+}
+
+/* Group testing: the set is split into associativity + 1 groups, of which at
+ * least one only holds lines that are not needed for the eviction of the
+ * target if the associativity is large enough, and the first group without
+ * which the set still evicts the target is removed. If no group can be
+ * removed, the set is split into single lines, and once no single line can be
+ * removed the set is minimal. Removed groups are kept behind the set in the
+ * order of their removal, so that the last ones are restored if a wrong test
+ * result left a set that does not evict the target anymore. Returns the size
+ * of the reduced set or 0. */
+static size_t
+reduce(libflush_eviction_discovery_t* discovery, void** set, size_t size)
+{
+  size_t number_of_groups = discovery->associativity + 1;
+  size_t* removed = calloc(size, sizeof(size_t));
+  void** group = calloc(size / number_of_groups + 1, sizeof(void*));
+  if (removed == NULL || group == NULL) {
+    free(removed);
+    free(group);
+    return 0;
+  }
+
+  size_t number_of_removed = 0;
+  unsigned int number_of_backtracks = 0;
+  bool reduced = evicts(discovery, discovery->target, set, size, size, size);
+  bool minimal = false;
+
+  while (reduced == true && minimal == false && size > discovery->associativity) {
+    size_t groups = (number_of_groups < size) ? number_of_groups : size;
+
+    bool found = false;
+    for (size_t g = 0; g < groups && found == false; g++) {
+      size_t begin = size * g / groups;
+      size_t end = size * (g + 1) / groups;
+      if (evicts(discovery, discovery->target, set, size, begin, end) == false) {
+        continue;
+      }
+
+      // Move the group behind the remaining set
+      size_t length = end - begin;
+      memcpy(group, &(set[begin]), length * sizeof(void*));
+      memmove(&(set[begin]), &(set[end]), (size - end) * sizeof(void*));
+      memcpy(&(set[size - length]), group, length * sizeof(void*));
+
+      size -= length;
+      removed[number_of_removed++] = length;
+      found = true;
+    }
+
+    // Without a removable group either a test of a group failed or the set
+    // does not evict the target anymore after a wrong test result. Both are
+    // retried a limited number of times. Small sets are split into single
+    // lines instead.
+    if (discovery->aborted == true) {
+      reduced = false;
+    } else if (found == false) {
+      bool full = evicts(discovery, discovery->target, set, size, size, size);
+      if (full == true && groups == size) {
+        minimal = true;
+      } else if (full == true && size <= 2 * discovery->associativity) {
+        number_of_groups = size;
+      } else if (number_of_backtracks == DISCOVERY_MAXIMUM_BACKTRACKS) {
+        reduced = false;
+      } else {
+        number_of_backtracks++;
+        if (full == false && number_of_removed > 0) {
+          size += removed[--number_of_removed];
+        }
+      }
+    }
+
+    discovery->result.number_of_candidates = size;
+    discovery->result.duration = get_time_ns() - discovery->start;
+    if (reduced == true && discovery->progress != NULL &&
+        discovery->progress(&(discovery->result), discovery->progress_data) == false) {
+      discovery->aborted = true;
+      reduced = false;
+    }
+  }
+
+  free(removed);
+  free(group);
+
+  return (reduced == true) ? size : 0;
+}
+
+/* A minimal set evicts the target less reliably than larger sets, so the
+ * reduced set has to evict the target in the majority of the verification
+ * rounds */
+static bool
+verify(libflush_eviction_discovery_t* discovery, void** set, size_t size)
+{
+  unsigned int evicted = 0;
+  for (unsigned int i = 0; i < discovery->verification_rounds; i++) {
+    if (is_expired(discovery) == true) {
+      return false;
+    }
+
+    discovery->result.number_of_tests++;
+    if (measure(discovery, discovery->target, set, size, size, size) >
+        discovery->result.threshold) {
+      evicted++;
+    }
+  }
+
+  return 2 * evicted > discovery->verification_rounds;
+}
+
+void
+libflush_eviction_discovery_init(libflush_eviction_discovery_t* discovery,
+    libflush_session_t* session, void* target, const libflush_discovery_args_t* args)
+{
+  static const libflush_discovery_args_t defaults = { 0 };
+  if (args == NULL) {
+    args = &defaults;
+  }
+
+  memset(discovery, 0, sizeof(libflush_eviction_discovery_t));
+  discovery->session = session;
+  discovery->target = target;
+  discovery->associativity = (args->associativity != 0) ? args->associativity :
+    DISCOVERY_ASSOCIATIVITY;
+  discovery->number_of_attempts = (args->number_of_attempts != 0) ? args->number_of_attempts :
+    DISCOVERY_NUMBER_OF_ATTEMPTS;
+  discovery->verification_rounds = (args->verification_rounds != 0) ?
+    args->verification_rounds : DISCOVERY_VERIFICATION_ROUNDS;
+  discovery->progress = args->progress;
+  discovery->progress_data = args->progress_data;
+  discovery->result.threshold = args->threshold;
+
+  discovery->start = get_time_ns();
+  if (args->time_budget != 0) {
+    discovery->deadline = discovery->start + args->time_budget;
+  }
+
+  discovery->seed = discovery->start ^ (uintptr_t) target;
+  if (discovery->seed == 0) {
+    discovery->seed = 1;
+  }
+}
+
+/* Fills the addresses with the minimal set followed by the candidates it
+ * evicts, which are congruent to the target */
+static size_t
+collect(libflush_eviction_discovery_t* discovery, void** candidates,
+    size_t number_of_candidates, void** set, size_t size, void** addresses,
+    size_t number_of_addresses)
+{
+  memcpy(addresses, set, size * sizeof(void*));
+  size_t found = size;
+
+  for (size_t i = 0; i < number_of_candidates && found < number_of_addresses; i++) {
+    bool minimal = false;
+    for (size_t j = 0; j < size && minimal == false; j++) {
+      minimal = (candidates[i] == set[j]);
+    }
+
+    if (minimal == false && evicts(discovery, candidates[i], set, size, size, size) == true) {
+      addresses[found++] = candidates[i];
+    }
+  }
+
+  return found;
+}
+
+/* Reduces the candidates to a minimal eviction set of the target and fills the
+ * addresses with the minimal set followed by the candidates it evicts. Returns
+ * the number of addresses or 0. */
+size_t
+libflush_eviction_discovery_run(libflush_eviction_discovery_t* discovery,
+    void** candidates, size_t number_of_candidates, void** addresses,
+    size_t number_of_addresses)
+{
+  libflush_discovery_result_t* result = &(discovery->result);
+  size_t found = 0;
+
+  void** set = calloc(number_of_candidates, sizeof(void*));
+  if (set == NULL) {
+    return 0;
+  }
+
+  if (result->threshold == 0 && calibrate(discovery, candidates, number_of_candidates) == false) {
+    free(set);
+    return 0;
+  }
+
+  // Every attempt reduces the candidates in another random order
+  while (found == 0 && result->number_of_attempts < discovery->number_of_attempts &&
+      discovery->aborted == false) {
+    result->number_of_attempts++;
+
+    memcpy(set, candidates, number_of_candidates * sizeof(void*));
+    for (size_t i = number_of_candidates - 1; i > 0; i--) {
+      size_t j = next_random(&(discovery->seed)) % (i + 1);
+      void* line = set[i];
+      set[i] = set[j];
+      set[j] = line;
+    }
+
+    result->number_of_candidates = number_of_candidates;
+    size_t size = reduce(discovery, set, number_of_candidates);
+    if (size == 0 || size > number_of_addresses || verify(discovery, set, size) == false) {
+      continue;
+    }
+
+    // The complete eviction set has to evict the target as well
+    found = collect(discovery, candidates, number_of_candidates, set, size, addresses,
+        number_of_addresses);
+    if (verify(discovery, addresses, found) == false) {
+      found = 0;
+    }
+  }
+
+  if (discovery->aborted == true) {
+    found = 0;
+  }
+
+  result->number_of_addresses = found;
+  result->duration = get_time_ns() - discovery->start;
+  free(set);
+
+  return found;
+}
@@ -0,0 +1,35 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef LIBFLUSH_EVICTION_DISCOVERY_H
+#define LIBFLUSH_EVICTION_DISCOVERY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../libflush.h"
+
+/* Discovery of the eviction set of a target line among candidate lines, which
+ * only relies on the reload time of the target */
+typedef struct libflush_eviction_discovery_s {
+  libflush_session_t* session;
+  void* target;
+  size_t associativity;
+  unsigned int number_of_attempts;
+  unsigned int verification_rounds;
+  uint64_t start;
+  uint64_t deadline;
+  libflush_discovery_progress_t progress;
+  void* progress_data;
+  uint64_t seed;
+  bool aborted;
+  libflush_discovery_result_t result;
+} libflush_eviction_discovery_t;
+
+void libflush_eviction_discovery_init(libflush_eviction_discovery_t* discovery,
+    libflush_session_t* session, void* target, const libflush_discovery_args_t* args);
+size_t libflush_eviction_discovery_run(libflush_eviction_discovery_t* discovery,
+    void** candidates, size_t number_of_candidates, void** addresses,
+    size_t number_of_addresses);
+
+#endif // LIBFLUSH_EVICTION_DISCOVERY_H
@@ -9,7 +9,10 @@
 #include <assert.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
 #include <sched.h>
+#include <time.h>
 #include <sys/sysinfo.h>
 
 #ifdef PTHREAD_ENABLE
@@ -18,124 +21,458 @@
 
 #include "../libflush.h"
 #include "../internal.h"
+#include "../geometry.h"
+#include "../numa.h"
 #include "eviction.h"
+#include "jit.h"
+#include "slice.h"
+#include "discovery.h"
+#include "profile.h"
 
 #define __include_strategy(x) #x
 #define _include_strategy(x) __include_strategy(x)
 #define include_strategy(x) _include_strategy(x)
 
+#ifdef DEVICE_CONFIGURATION
 #include include_strategy(DEVICE_CONFIGURATION)
+#endif
 
 #include "configuration.h"
 
-#define ADDRESS_COUNT ((ES_EVICTION_COUNTER) + (ES_DIFFERENT_ADDRESSES_IN_LOOP) - 1)
+/* A device configuration that defines the geometry overrides the detected one */
+#if defined(NUMBER_OF_SETS) && (NUMBER_OF_SETS & (NUMBER_OF_SETS - 1)) != 0
+#error NUMBER_OF_SETS has to be a power of two
+#endif
+
+#ifndef ES_EVICTION_COUNTER
+#define ES_EVICTION_COUNTER 28
+#endif
+
+#ifndef ES_NUMBER_OF_ACCESSES_IN_LOOP
+#define ES_NUMBER_OF_ACCESSES_IN_LOOP 5
+#endif
+
+#ifndef ES_DIFFERENT_ADDRESSES_IN_LOOP
+#define ES_DIFFERENT_ADDRESSES_IN_LOOP 4
+#endif
+
+#ifndef ES_STEP_SIZE
+#define ES_STEP_SIZE 1
+#endif
+
+#ifndef ES_MIRRORING
+#define ES_MIRRORING false
+#endif
+
+#define PAGE_SIZE_LOG2 12
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+#ifndef HUGETLBFS_MAGIC
+#define HUGETLBFS_MAGIC 0x958458f6
+#endif
 
+/* Entry of the virtual address cache, which maps a virtual line number to the
+ * set index of its physical address or to a discovered eviction set. Empty
+ * slots have a line number of 0. */
 typedef struct virtual_address_cache_entry_s {
+  uintptr_t line;
+  uint32_t index;
+  uint32_t referenced;
+} virtual_address_cache_entry_t;
+
+/* Open-addressed hash table with linear probing. Tables replaced by a larger
+ * one are kept in the list of previous tables until the session is terminated,
+ * as lock-free readers may still access them. */
+typedef struct virtual_address_cache_table_s {
+  struct virtual_address_cache_table_s* previous;
+  size_t size;
+  unsigned int shift;
+  virtual_address_cache_entry_t entries[];
+} virtual_address_cache_table_t;
+
+/* Referenced flag of entries that are never replaced */
+#define VIRTUAL_ADDRESS_CACHE_PINNED 2
+
+typedef struct virtual_address_cache_s {
 #ifdef PTHREAD_ENABLE
   pthread_mutex_t lock;
+  unsigned int sequence;
 #endif
-  bool used;
-  void* virtual_address;
-  size_t index;
-} virtual_address_cache_entry_t;
-
+  virtual_address_cache_table_t* table;
+  size_t number_of_entries;
+  size_t hand;
+} virtual_address_cache_t;
+
+/* Eviction and probe routine of an eviction set, compiled for the session
+ * strategy of the given generation. The code of a routine is NULL if it could
+ * not be compiled. */
+typedef struct jit_routines_s {
+  unsigned int generation;
+  libflush_eviction_jit_routine_t evict;
+  libflush_eviction_jit_routine_t probe;
+} jit_routines_t;
+
+/* Eviction set of a cache set, allocated on the first use of the set. It holds
+ * as many lines as the largest strategy used with the set required so far. The
+ * lines are stored as line numbers within the pool, which the set index table
+ * limits to 32 bits as well. They only change while both the lock of the set
+ * and the lock of the memory are held, so sweeps over many sets only lock the
+ * memory. */
 typedef struct congruent_address_cache_entry_s {
 #ifdef PTHREAD_ENABLE
   pthread_mutex_t lock;
 #endif
-  bool used;
-  void* congruent_virtual_addresses[ADDRESS_COUNT];
+  uint32_t number_of_addresses;
+  uint32_t* lines;
+  jit_routines_t* jit_routines;
 } congruent_address_cache_entry_t;
 
+/* Start of every line of an eviction set that is accessed as a chain. The
+ * addresses of the eviction set are kept in the order of the chain. */
+typedef struct chain_link_s {
+  struct chain_link_s* next;
+  struct chain_link_s* previous;
+} chain_link_t;
+
+typedef void (*eviction_function_t)(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters);
+
+/* Validated eviction strategy and the loop that implements it */
+typedef struct eviction_strategy_s {
+  libflush_eviction_strategy_t parameters;
+  size_t number_of_addresses;
+  eviction_function_t function;
+} eviction_strategy_t;
+
+/* Lines of the eviction pool bucketed by their set index. The lines of set s
+ * are lines[offsets[s]] to lines[offsets[s + 1] - 1] in ascending order. */
+/* The table is unavailable if the pool cannot be translated, which is the case
+ * for small pages without the pagemap */
+typedef struct set_index_table_s {
+  uint32_t* offsets;
+  uint32_t* lines;
+  bool unavailable;
+} set_index_table_t;
+
+/* The sets of all slices are numbered consecutively, so the set index of a
+ * line is slice * sets per slice + set within the slice. The line length and
+ * the sets per slice are powers of two chosen on initialization. */
 typedef struct memory_s {
 #ifdef PTHREAD_ENABLE
   pthread_mutex_t lock;
 #endif
   size_t mapping_size;
+  size_t populated_size;
   void* mapping;
+  libflush_eviction_pages_t pages;
+  bool incremental;
+  bool touch;
+  int node;
   int pagemap;
+  unsigned int line_length_log2;
+  unsigned int sets_per_slice_log2;
+  size_t number_of_sets;
+  libflush_eviction_slice_hash_t slice_hash;
+  set_index_table_t set_index_table;
+  char* profile_file;
+  libflush_eviction_profile_state_t profile_state;
 } memory_t;
 
-typedef struct libflush_eviction_s {
-  congruent_address_cache_entry_t congruent_address_cache[NUMBER_OF_SETS];
-  virtual_address_cache_entry_t virtual_address_cache[ADDRESS_CACHE_SIZE];
+/* Eviction set requested from the builder. The physical address of a requested
+ * address rules out the address itself, it is 0 for requested sets. */
+typedef struct builder_request_s {
+  size_t index;
+  uintptr_t physical_address;
+} builder_request_t;
+
+/* Builds requested eviction sets ahead of their use. Requests are served in
+ * their order, a request of all sets only after all other requests. With
+ * pthread support a background thread builds the sets, otherwise they are
+ * built before libflush_eviction_prepare returns. */
+typedef struct builder_s {
 #ifdef PTHREAD_ENABLE
-    pthread_mutex_t virtual_address_cache_lock;
+  pthread_mutex_t lock;
+  pthread_cond_t requested;
+  pthread_cond_t finished;
+  pthread_t thread;
+  bool running;
+  bool stop;
+  bool busy;
 #endif
+  libflush_session_t* session;
+  builder_request_t* requests;
+  size_t first_request;
+  size_t number_of_requests;
+  size_t capacity;
+  size_t next_set;
+  size_t number_of_sets;
+} builder_t;
+
+/* Eviction sets of a cache level below the evicted cache. A set of the level
+ * holds lines of all sets of the evicted cache that map to it, so the levels
+ * share the pool and its set index table. The lines are accessed as an array
+ * and the sets are not compiled, as chain links and compiled routines belong
+ * to the sets of the evicted cache. */
+typedef struct eviction_level_s {
+  unsigned int level;
+  unsigned int number_of_sets_log2;
+  size_t associativity;
+  eviction_strategy_t strategy;
+  congruent_address_cache_entry_t** congruent_address_cache;
+} eviction_level_t;
+
+/* The eviction set of set i is congruent_address_cache[i], which is NULL until
+ * the set is used. Eviction sets found by timing have the indices
+ * number_of_sets + i. They hold the congruent lines that were found in the
+ * pool, which is at least discovered_number_of_addresses. */
+typedef struct libflush_eviction_s {
+  congruent_address_cache_entry_t** congruent_address_cache;
+  congruent_address_cache_entry_t* discovered_sets;
+  size_t number_of_discovered_sets;
+  size_t discovered_number_of_addresses;
+  virtual_address_cache_t virtual_address_cache;
   memory_t memory;
+  builder_t builder;
+  eviction_strategy_t strategy;
+  unsigned int strategy_generation;
+  bool jit;
+  libflush_eviction_access_t access;
+  uint64_t chain_seed;
+  unsigned int last_level;
+  eviction_level_t levels[MAXIMUM_NUMBER_OF_CACHES];
+  size_t number_of_levels;
 } libflush_eviction_t;
 
 #if USE_FIXED_MEMORY_SIZE == 0
 static size_t get_physical_memory_size(void);
 #endif
 
-void evict(congruent_address_cache_entry_t* address_cache_entry);
-void find_congruent_addresses(libflush_session_t* session, libflush_eviction_t*
-    eviction, size_t index, uintptr_t physical_address);
+static bool map_memory(memory_t* memory, libflush_eviction_pages_t pages, bool populate);
+static bool map_pool_file(memory_t* memory, const char* path, bool populate);
+static void populate_pool(memory_t* memory, size_t size);
+static bool populate_next_region(memory_t* memory);
+static bool build_set_index_table(libflush_session_t* session, memory_t* memory);
+static libflush_eviction_profile_state_t load_set_index_table(libflush_session_t* session,
+    memory_t* memory);
+static void store_set_index_table(memory_t* memory);
+
+static bool virtual_address_cache_init(virtual_address_cache_t* cache);
+static void virtual_address_cache_terminate(virtual_address_cache_t* cache);
+static bool virtual_address_cache_lookup(virtual_address_cache_t* cache, uintptr_t line,
+    size_t* index);
+static bool virtual_address_cache_insert(virtual_address_cache_t* cache, uintptr_t line,
+    size_t index, uint32_t referenced);
+
+static bool eviction_strategy_init(libflush_eviction_t* eviction, eviction_strategy_t* strategy,
+    const libflush_eviction_strategy_t* parameters);
+static bool select_strategy(eviction_strategy_t* strategy,
+    const libflush_eviction_strategy_t* parameters, size_t maximum_number_of_addresses,
+    bool chain);
+
+static void levels_init(libflush_session_t* session, libflush_eviction_t* eviction);
+static bool level_strategy_init(libflush_eviction_t* eviction, eviction_level_t* level,
+    const libflush_eviction_strategy_t* parameters);
+static eviction_level_t* get_level(libflush_eviction_t* eviction, unsigned int level);
+static bool get_level_set_index(libflush_session_t* session, libflush_eviction_t* eviction,
+    const eviction_level_t* level, void* address, size_t* set_index,
+    uintptr_t* physical_address);
+
+static congruent_address_cache_entry_t* get_congruent_addresses(libflush_session_t* session,
+    libflush_eviction_t* eviction, size_t index, uintptr_t physical_address,
+    size_t number_of_addresses);
+static void put_congruent_addresses(congruent_address_cache_entry_t* entry);
+static jit_routines_t* get_jit_routines(libflush_eviction_t* eviction,
+    congruent_address_cache_entry_t* entry);
+static void destroy_jit_routines(congruent_address_cache_entry_t* entry);
+static bool find_congruent_addresses(libflush_session_t* session, libflush_eviction_t*
+    eviction, size_t index, uintptr_t physical_address, size_t number_of_addresses);
+static congruent_address_cache_entry_t* get_level_congruent_addresses(libflush_session_t*
+    session, libflush_eviction_t* eviction, eviction_level_t* level, size_t set_index,
+    uintptr_t physical_address);
+static bool find_level_congruent_addresses(libflush_session_t* session,
+    libflush_eviction_t* eviction, eviction_level_t* level, size_t set_index,
+    uintptr_t physical_address, size_t number_of_addresses);
+static void link_congruent_addresses(libflush_eviction_t* eviction, size_t index,
+    uint32_t* lines, size_t number_of_addresses);
+static void probe_chain(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, size_t number_of_addresses);
+
+static void builder_init(libflush_session_t* session, builder_t* builder);
+static void builder_terminate(builder_t* builder);
+
+static inline bool
+is_power_of_two(size_t value)
+{
+  return value != 0 && (value & (value - 1)) == 0;
+}
 
-void
-libflush_eviction_evict(libflush_session_t* session, void* address)
+/* Line length of the evicted cache: the one of the device configuration, of
+ * the detected last-level cache or the default */
+static unsigned int
+get_line_length_log2(libflush_session_t* session)
 {
-  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+#ifdef LINE_LENGTH_LOG2
+  (void) session;
+  return LINE_LENGTH_LOG2;
+#else
+  const libflush_cache_geometry_t* cache = libflush_geometry_get_last_level(session);
+  if (cache != NULL && is_power_of_two(cache->line_length) == true &&
+      cache->line_length < (1 << PAGE_SIZE_LOG2)) {
+    return __builtin_ctzl(cache->line_length);
+  }
 
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_lock(&(eviction->virtual_address_cache_lock));
+  return DEFAULT_LINE_LENGTH_LOG2;
 #endif
-  // Check if address is cached and run eviction
-  for (unsigned int i = 0; i < ADDRESS_CACHE_SIZE; i++) {
-    if (eviction->virtual_address_cache[i].virtual_address == address) {
-      evict(&(eviction->congruent_address_cache[eviction->virtual_address_cache[i].index]));
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_unlock(&(eviction->virtual_address_cache_lock));
+}
+
+/* Sets of a slice of the evicted cache. The detected sets of the last-level
+ * cache are split among the slices of the slice hash. If they are not a power
+ * of two per slice, the cache is sliced by an unknown hash and the default
+ * is used. */
+static unsigned int
+get_sets_per_slice_log2(libflush_session_t* session, size_t number_of_slices)
+{
+#ifdef NUMBER_OF_SETS
+  (void) session;
+  (void) number_of_slices;
+  return __builtin_ctzl(NUMBER_OF_SETS);
+#else
+  const libflush_cache_geometry_t* cache = libflush_geometry_get_last_level(session);
+  if (cache != NULL && cache->number_of_sets % number_of_slices == 0 &&
+      is_power_of_two(cache->number_of_sets / number_of_slices) == true) {
+    return __builtin_ctzl(cache->number_of_sets / number_of_slices);
+  }
+
+  return __builtin_ctzl(DEFAULT_NUMBER_OF_SETS);
 #endif
-      return;
-    }
+}
+
+/* Address of a line of the pool */
+static inline __attribute__((always_inline)) void*
+get_line_address(const uint8_t* pool, uint32_t line, unsigned int line_length_log2)
+{
+  return (void*) (pool + ((uintptr_t) line << line_length_log2));
+}
+
+static inline size_t
+get_set_index(const memory_t* memory, uintptr_t physical_address)
+{
+  size_t set_mask = ((size_t) 1 << memory->sets_per_slice_log2) - 1;
+
+  return (libflush_eviction_slice_hash_get_slice(&(memory->slice_hash), physical_address) <<
+      memory->sets_per_slice_log2) + ((physical_address >> memory->line_length_log2) & set_mask);
+}
+
+/* Gets the index of the eviction set of an address. The physical address is
+ * only translated if the address is not cached, otherwise it is 0. Returns
+ * false if the address cannot be translated, as without pagemap access. */
+static bool
+get_address_set_index(libflush_session_t* session, libflush_eviction_t* eviction,
+    void* address, size_t* index, uintptr_t* physical_address)
+{
+  uintptr_t line = (uintptr_t) address >> eviction->memory.line_length_log2;
+  *physical_address = 0;
+
+  // Check if address is cached
+  if (virtual_address_cache_lookup(&(eviction->virtual_address_cache), line, index) == true) {
+    return true;
   }
 
-  // Find free cache entry
-  virtual_address_cache_entry_t* virtual_address_cache_entry = NULL;
-  for (unsigned int i = 0; i < ADDRESS_CACHE_SIZE; i++) {
-    if (eviction->virtual_address_cache[i].used == false) {
-      virtual_address_cache_entry = &(eviction->virtual_address_cache[i]);
-      break;
-    }
+  // A failed translation yields the first frame, which would map every address
+  // to the same set. It is not cached, so a discovered set can still be used.
+  uintptr_t translated = libflush_get_physical_address(session, (size_t) address);
+  if ((translated >> PAGE_SIZE_LOG2) == 0) {
+    return false;
   }
 
-  // If there is no free cache entry, we chose a random one
-  if (virtual_address_cache_entry == NULL) {
-#if defined(__ARM_ARCH_7A__)
-    virtual_address_cache_entry = &(eviction->virtual_address_cache[lrand48() % ADDRESS_CACHE_SIZE]);
-#else
-    virtual_address_cache_entry = &(eviction->virtual_address_cache[rand() % ADDRESS_CACHE_SIZE]);
-#endif
+  *physical_address = translated;
+  *index = get_set_index(&(eviction->memory), translated);
+  virtual_address_cache_insert(&(eviction->virtual_address_cache), line, *index, 0);
+
+  return true;
+}
+
+/* Returns false if the address has neither a discovered eviction set nor one
+ * from the pool */
+static bool
+evict_address(libflush_session_t* session, libflush_eviction_t* eviction, void* address,
+    const eviction_strategy_t* strategy)
+{
+  size_t index;
+  uintptr_t physical_address;
+  if (get_address_set_index(session, eviction, address, &index, &physical_address) == false) {
+    return false;
   }
 
-  uintptr_t physical_address = libflush_get_physical_address(session, (size_t) address);
-  uint64_t index = (physical_address >> LINE_LENGTH_LOG2) % NUMBER_OF_SETS;
+  // Run eviction. Only the session strategy is compiled, as the routines of a
+  // strategy passed to a single call would not be used again.
+  congruent_address_cache_entry_t* entry = get_congruent_addresses(session, eviction, index,
+      physical_address, strategy->number_of_addresses);
+  if (entry == NULL) {
+    return false;
+  }
 
-  // Set cache entry information
-  virtual_address_cache_entry->virtual_address  = address;
-  virtual_address_cache_entry->used = true;
-  virtual_address_cache_entry->index = index;
+  jit_routines_t* routines = NULL;
+  if (strategy == &(eviction->strategy)) {
+    routines = get_jit_routines(eviction, entry);
+  }
 
-#ifdef PTHREAD_ENABLE
-    pthread_mutex_lock(&(eviction->congruent_address_cache[index].lock));
-#endif
+  if (routines != NULL && routines->evict.code != NULL) {
+    libflush_eviction_jit_call(&(routines->evict));
+  } else {
+    strategy->function(eviction->memory.mapping, entry->lines,
+        eviction->memory.line_length_log2, &(strategy->parameters));
+  }
+  put_congruent_addresses(entry);
+
+  return true;
+}
+
+void
+libflush_eviction_evict(libflush_session_t* session, void* address)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  evict_address(session, eviction, address, &(eviction->strategy));
+}
+
+bool
+libflush_eviction_evict_strategy(libflush_session_t* session, void* address,
+    const libflush_eviction_strategy_t* strategy)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
 
-  if (eviction->congruent_address_cache[index].used == false) {
-    find_congruent_addresses(session, eviction, index, physical_address);
+  eviction_strategy_t eviction_strategy;
+  if (eviction_strategy_init(eviction, &eviction_strategy, strategy) == false) {
+    return false;
   }
 
-#ifdef PTHREAD_ENABLE
-    pthread_mutex_unlock(&(eviction->congruent_address_cache[index].lock));
-#endif
+  return evict_address(session, eviction, address, &eviction_strategy);
+}
 
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_unlock(&(eviction->virtual_address_cache_lock));
-#endif
+bool
+libflush_eviction_set_strategy(libflush_session_t* session,
+    const libflush_eviction_strategy_t* strategy)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
 
-  // Run eviction
-  evict(&(eviction->congruent_address_cache[virtual_address_cache_entry->index]));
+  if (eviction_strategy_init(eviction, &(eviction->strategy), strategy) == false) {
+    return false;
+  }
+
+  // Compiled routines of the previous strategy are replaced on their next use
+  eviction->strategy_generation++;
+
+  return true;
+}
+
+void
+libflush_eviction_get_strategy(libflush_session_t* session,
+    libflush_eviction_strategy_t* strategy)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  *strategy = eviction->strategy.parameters;
 }
 
 bool
@@ -145,52 +482,199 @@ libflush_eviction_init(libflush_session_t* session, libflush_session_args_t* arg
     return false;
   }
 
-  (void) args;
+  libflush_eviction_pages_t pages = LIBFLUSH_EVICTION_PAGES_DEFAULT;
+  libflush_eviction_node_t node_selection = LIBFLUSH_EVICTION_NODE_LOCAL;
+  libflush_eviction_population_t population = LIBFLUSH_EVICTION_POPULATION_DEFAULT;
+  bool jit = false;
+  libflush_eviction_access_t access = LIBFLUSH_EVICTION_ACCESS_DEFAULT;
+  if (args != NULL) {
+    pages = args->eviction_pages;
+    node_selection = args->eviction_node;
+    population = args->eviction_population;
+    jit = args->eviction_jit;
+    access = args->eviction_access;
+  }
+
+  if (pages > LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE) {
+    return false;
+  }
+
+  // The set indices of an incremental pool change as it is populated, so they
+  // cannot be kept in a profile
+  if (population == LIBFLUSH_EVICTION_POPULATION_DEFAULT) {
+    population = LIBFLUSH_EVICTION_POPULATION_PARALLEL;
+  } else if (population > LIBFLUSH_EVICTION_POPULATION_INCREMENTAL ||
+      (population == LIBFLUSH_EVICTION_POPULATION_INCREMENTAL &&
+       args->eviction_profile_file != NULL)) {
+    return false;
+  }
+
+  // The pool is bound to the node of the CPU that initializes the session,
+  // which is unknown without NUMA support, or to the given node
+  int node = -1;
+  if (node_selection == LIBFLUSH_EVICTION_NODE_LOCAL) {
+    node = libflush_numa_get_local_node();
+  } else if (node_selection == LIBFLUSH_EVICTION_NODE_FIXED) {
+    if (libflush_numa_is_node_online(args->eviction_node_id) == false) {
+      return false;
+    }
+    node = args->eviction_node_id;
+  } else if (node_selection != LIBFLUSH_EVICTION_NODE_ANY) {
+    return false;
+  }
+
+  if (access == LIBFLUSH_EVICTION_ACCESS_DEFAULT) {
+    access = LIBFLUSH_EVICTION_ACCESS_ARRAY;
+  } else if (access > LIBFLUSH_EVICTION_ACCESS_RANDOM_CHAIN) {
+    return false;
+  }
+
+  // Compiled routines load the addresses as immediates, which is the array
+  // access
+  if (jit == true && (libflush_eviction_jit_is_available() == false ||
+        access != LIBFLUSH_EVICTION_ACCESS_ARRAY)) {
+    return false;
+  }
 
   libflush_eviction_t* eviction = calloc(1, sizeof(libflush_eviction_t));
   if (eviction == NULL) {
     return false;
   }
 
+  // The slice of a line depends on the upper bits of its physical address, so
+  // the pool has to be translated
+  memory_t* memory = &(eviction->memory);
+  memory->line_length_log2 = get_line_length_log2(session);
+  if (libflush_eviction_slice_hash_init(&(memory->slice_hash),
+        (args != NULL) ? args->slice_hash : LIBFLUSH_SLICE_HASH_NONE,
+        (args != NULL) ? args->number_of_slices : 0,
+        (args != NULL) ? args->slice_hash_file : NULL, memory->line_length_log2) == false) {
+    free(eviction);
+    return false;
+  }
+
+  size_t number_of_slices = memory->slice_hash.number_of_slices;
+#if HAVE_PAGEMAP_ACCESS == 0
+  if (number_of_slices > 1) {
+    libflush_eviction_slice_hash_terminate(&(memory->slice_hash));
+    free(eviction);
+    return false;
+  }
+#endif
+
+  memory->sets_per_slice_log2 = get_sets_per_slice_log2(session, number_of_slices);
+  memory->number_of_sets = number_of_slices << memory->sets_per_slice_log2;
+  eviction->congruent_address_cache = calloc(memory->number_of_sets,
+      sizeof(congruent_address_cache_entry_t*));
+  if (eviction->congruent_address_cache == NULL) {
+    libflush_eviction_slice_hash_terminate(&(memory->slice_hash));
+    free(eviction);
+    return false;
+  }
+
   session->data = eviction;
+  builder_init(session, &(eviction->builder));
+  eviction->jit = jit;
+  eviction->access = access;
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  eviction->chain_seed = (uint64_t) now.tv_sec * 1000 * 1000 * 1000 + now.tv_nsec;
 
 #ifdef PTHREAD_ENABLE
   assert(pthread_mutex_init(&(eviction->memory.lock), NULL) == 0);
-  assert(pthread_mutex_init(&(eviction->virtual_address_cache_lock), NULL) == 0);
   pthread_mutex_lock(&(eviction->memory.lock));
 #endif
 
-  // Calculate mapping size
+  // Calculate mapping size. A fixed size pool holds the same number of lines
+  // of every set of every slice.
 #if USE_FIXED_MEMORY_SIZE == 1
-  eviction->memory.mapping_size = PHYSICAL_MEMORY_MAPPED_SIZE;
+  eviction->memory.mapping_size = ((size_t) PHYSICAL_MEMORY_MAPPED_LINES_PER_SET *
+      memory->number_of_sets) << memory->line_length_log2;
 #else
   eviction->memory.mapping_size = get_physical_memory_size() * FRACTION_OF_PHYSICAL_MEMORY;
+
+  // Lines of the pool are numbered with 32 bits
+  if (((uint64_t) eviction->memory.mapping_size >> memory->line_length_log2) > UINT32_MAX) {
+    eviction->memory.mapping_size = (size_t) (((uint64_t) UINT32_MAX + 1) <<
+        memory->line_length_log2);
+  }
 #endif
 
-  // Map memory
-  eviction->memory.mapping = mmap(NULL, eviction->memory.mapping_size, PROT_READ | PROT_WRITE,
-                       MAP_POPULATE | MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
-  assert(eviction->memory.mapping != (void *) -1);
+  // Map memory. The pages are allocated on the node of the pool as the mapping
+  // populates them. A pool file is created by the user, so it may fail to map.
+  libflush_numa_policy_t policy;
+  bool bound = (node >= 0 && libflush_numa_bind_thread(node, &policy) == true);
+
+  bool mapped;
+  bool populate = (population == LIBFLUSH_EVICTION_POPULATION_SERIAL);
+  const char* pool_file = (args != NULL) ? args->eviction_pool_file : NULL;
+  if (pool_file != NULL) {
+    mapped = map_pool_file(&(eviction->memory), pool_file, populate);
+  } else {
+    mapped = map_memory(&(eviction->memory), pages, populate);
+    assert(mapped == true);
+  }
 
-  // Initialize the mapping so that the pages are non-empty.
-  for (uint64_t index = 0; index < eviction->memory.mapping_size; index += 0x400) {
-      uint64_t* temporary = (uint64_t*) (((uint8_t*) eviction->memory.mapping) + index);
-      temporary[0] = index;
+  // Later faults of the pool allocate on the node as well
+  if (bound == true) {
+    libflush_numa_restore_thread(&policy);
+    bound = (mapped == true && libflush_numa_bind_range(eviction->memory.mapping,
+          eviction->memory.mapping_size, node) == true);
   }
+  memory->node = (bound == true) ? node : -1;
 
-  // Clean address cache
-  memset(eviction->virtual_address_cache, 0, ADDRESS_CACHE_SIZE * sizeof(virtual_address_cache_entry_t));
-  memset(eviction->congruent_address_cache, 0, NUMBER_OF_SETS * sizeof(congruent_address_cache_entry_t));
+  if (mapped == false || (node_selection == LIBFLUSH_EVICTION_NODE_FIXED && bound == false)) {
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+    libflush_eviction_terminate(session);
+    return false;
+  }
+
+  // Populate the pool, which the threads of a parallel population do on the
+  // node of the pool as well. An incremental pool is populated as its sets
+  // are built.
+  memory->incremental = (population == LIBFLUSH_EVICTION_POPULATION_INCREMENTAL);
+  memory->touch = (args != NULL) ? args->eviction_touch : false;
+  if (memory->incremental == false) {
+    populate_pool(memory, memory->mapping_size);
+  }
 
+  // Select eviction strategy
+  if (eviction_strategy_init(eviction, &(eviction->strategy),
+        (args != NULL) ? &(args->eviction_strategy) : NULL) == false) {
 #ifdef PTHREAD_ENABLE
-  for (unsigned int i = 0; i < ADDRESS_CACHE_SIZE; i++) {
-    assert(pthread_mutex_init(&(eviction->virtual_address_cache[i].lock), NULL) == 0);
+    pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+    libflush_eviction_terminate(session);
+    return false;
   }
 
-  for (unsigned int i = 0; i < ADDRESS_CACHE_SIZE; i++) {
-    assert(pthread_mutex_init(&(eviction->congruent_address_cache[i].lock), NULL) == 0);
+  // Eviction sets of the cache levels below the evicted cache
+  levels_init(session, eviction);
+
+  // Clean address cache
+  bool initialized = virtual_address_cache_init(&(eviction->virtual_address_cache));
+  assert(initialized == true);
+  (void) initialized;
+
+  // Reuse the set indices of a previous session with the same pool
+  const char* profile_file = (args != NULL) ? args->eviction_profile_file : NULL;
+  if (profile_file != NULL) {
+    memory->profile_file = strdup(profile_file);
+    if (memory->profile_file == NULL) {
+#ifdef PTHREAD_ENABLE
+      pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+      libflush_eviction_terminate(session);
+      return false;
+    }
+
+    memory->profile_state = load_set_index_table(session, memory);
   }
 
+#ifdef PTHREAD_ENABLE
   pthread_mutex_unlock(&(eviction->memory.lock));
 #endif
 
@@ -210,160 +694,2570 @@ libflush_eviction_terminate(libflush_session_t* session)
     return true;
   }
 
+  // The builder uses the pool until it has stopped
+  builder_terminate(&(eviction->builder));
+
 #ifdef PTHREAD_ENABLE
   pthread_mutex_lock(&(eviction->memory.lock));
 #endif
 
   if (eviction->memory.mapping != NULL) {
     munmap(eviction->memory.mapping, eviction->memory.mapping_size);
+    libflush_invalidate_translations(session, eviction->memory.mapping,
+        eviction->memory.mapping_size);
   }
 
   eviction->memory.mapping_size = 0;
   eviction->memory.mapping = NULL;
 
+  free(eviction->memory.set_index_table.offsets);
+  free(eviction->memory.set_index_table.lines);
+  eviction->memory.set_index_table.offsets = NULL;
+  eviction->memory.set_index_table.lines = NULL;
+
+  virtual_address_cache_terminate(&(eviction->virtual_address_cache));
+
+  for (size_t i = 0; i < eviction->memory.number_of_sets; i++) {
+    congruent_address_cache_entry_t* entry = eviction->congruent_address_cache[i];
+    if (entry == NULL) {
+      continue;
+    }
+
+    destroy_jit_routines(entry);
+    free(entry->lines);
 #ifdef PTHREAD_ENABLE
-  for (unsigned int i = 0; i < ADDRESS_CACHE_SIZE; i++) {
-    pthread_mutex_destroy(&(eviction->virtual_address_cache[i].lock));
+    pthread_mutex_destroy(&(entry->lock));
+#endif
+    free(entry);
+    eviction->congruent_address_cache[i] = NULL;
   }
 
-  for (unsigned int i = 0; i < ADDRESS_CACHE_SIZE; i++) {
-    pthread_mutex_destroy(&(eviction->congruent_address_cache[i].lock));
+  for (size_t l = 0; l < eviction->number_of_levels; l++) {
+    eviction_level_t* level = &(eviction->levels[l]);
+    for (size_t i = 0; i < ((size_t) 1 << level->number_of_sets_log2); i++) {
+      congruent_address_cache_entry_t* entry = level->congruent_address_cache[i];
+      if (entry == NULL) {
+        continue;
+      }
+
+      free(entry->lines);
+#ifdef PTHREAD_ENABLE
+      pthread_mutex_destroy(&(entry->lock));
+#endif
+      free(entry);
+    }
+    free(level->congruent_address_cache);
   }
+  eviction->number_of_levels = 0;
 
+#ifdef PTHREAD_ENABLE
   pthread_mutex_unlock(&(eviction->memory.lock));
   pthread_mutex_destroy(&(eviction->memory.lock));
 #endif
 
+  for (size_t i = 0; i < eviction->number_of_discovered_sets; i++) {
+    destroy_jit_routines(&(eviction->discovered_sets[i]));
+    free(eviction->discovered_sets[i].lines);
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_destroy(&(eviction->discovered_sets[i].lock));
+#endif
+  }
+  free(eviction->discovered_sets);
+
+  libflush_eviction_slice_hash_terminate(&(eviction->memory.slice_hash));
+  free(eviction->memory.profile_file);
+
   /* Free eviction data */
+  free(eviction->congruent_address_cache);
   free(eviction);
   session->data = NULL;
 
   return true;
 }
 
-void
-libflush_eviction_prime(libflush_session_t* session, size_t set_index)
+/* Returns false if the set has no eviction set from the pool */
+static bool
+prime_set(libflush_session_t* session, libflush_eviction_t* eviction, size_t set_index)
 {
-  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
-
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_lock(&(eviction->virtual_address_cache_lock));
-  pthread_mutex_lock(&(eviction->congruent_address_cache[set_index].lock));
-#endif
+  const eviction_strategy_t* strategy = &(eviction->strategy);
 
-  if (eviction->congruent_address_cache[set_index].used == false) {
-    find_congruent_addresses(session, eviction, set_index, (uintptr_t) NULL);
+  congruent_address_cache_entry_t* entry = get_congruent_addresses(session, eviction,
+      set_index, 0, strategy->number_of_addresses);
+  if (entry == NULL) {
+    return false;
   }
 
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_unlock(&(eviction->congruent_address_cache[set_index].lock));
-  pthread_mutex_unlock(&(eviction->virtual_address_cache_lock));
-#endif
+  jit_routines_t* routines = get_jit_routines(eviction, entry);
+  if (routines != NULL && routines->evict.code != NULL) {
+    libflush_eviction_jit_call(&(routines->evict));
+  } else {
+    strategy->function(eviction->memory.mapping, entry->lines,
+        eviction->memory.line_length_log2, &(strategy->parameters));
+  }
+  put_congruent_addresses(entry);
 
-  evict(&(eviction->congruent_address_cache[set_index]));
+  return true;
 }
 
-void libflush_eviction_probe(libflush_session_t* session, size_t set_index)
+void
+libflush_eviction_prime(libflush_session_t* session, size_t set_index)
 {
-  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
-
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_lock(&(eviction->congruent_address_cache[set_index].lock));
-#endif
+  prime_set(session, (libflush_eviction_t*) session->data, set_index);
+}
 
-  congruent_address_cache_entry_t congruent_address_cache_entry =
-    eviction->congruent_address_cache[set_index];
+/* Returns false if the set has no eviction set from the pool */
+static bool
+probe_set(libflush_session_t* session, libflush_eviction_t* eviction, size_t set_index)
+{
+  size_t number_of_addresses = eviction->strategy.number_of_addresses;
 
-  if (congruent_address_cache_entry.used == false) {
-    find_congruent_addresses(session, eviction, set_index, (uintptr_t) NULL);
+  congruent_address_cache_entry_t* entry = get_congruent_addresses(session, eviction,
+      set_index, 0, number_of_addresses);
+  if (entry == NULL) {
+    return false;
   }
 
-  for (int i = ADDRESS_COUNT - 1; i >= 0; i -= 1) {
-    libflush_access_memory(congruent_address_cache_entry.congruent_virtual_addresses[i]);
+  jit_routines_t* routines = get_jit_routines(eviction, entry);
+  if (routines != NULL && routines->probe.code != NULL) {
+    libflush_eviction_jit_call(&(routines->probe));
+  } else if (eviction->access != LIBFLUSH_EVICTION_ACCESS_ARRAY) {
+    probe_chain(eviction->memory.mapping, entry->lines,
+        eviction->memory.line_length_log2, number_of_addresses);
+  } else {
+    for (size_t i = number_of_addresses; i > 0; i--) {
+      libflush_access_memory(get_line_address(eviction->memory.mapping, entry->lines[i - 1],
+          eviction->memory.line_length_log2));
+    }
   }
 
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_unlock(&(eviction->congruent_address_cache[set_index].lock));
-#endif
-}
-
-size_t
-libflush_eviction_get_number_of_sets(libflush_session_t* session)
-{
-  (void) session;
+  put_congruent_addresses(entry);
 
-  return NUMBER_OF_SETS;
+  return true;
 }
 
-size_t
-libflush_eviction_get_set_index(libflush_session_t* session, void* address)
+void
+libflush_eviction_probe(libflush_session_t* session, size_t set_index)
 {
-  uintptr_t physical_address = libflush_get_physical_address(session, (uintptr_t) address);
-  return (physical_address >> LINE_LENGTH_LOG2) % NUMBER_OF_SETS;
+  probe_set(session, (libflush_eviction_t*) session->data, set_index);
 }
 
-#if USE_FIXED_MEMORY_SIZE == 0
-static size_t
-get_physical_memory_size(void)
+bool
+libflush_eviction_sweep_begin(libflush_session_t* session, const size_t* set_indices,
+    size_t number_of_sets)
 {
-  struct sysinfo info;
-  sysinfo(&info);
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+  size_t number_of_addresses = eviction->strategy.number_of_addresses;
 
-  return info.totalram * info.mem_unit;
-}
-#endif
+  if (set_indices == NULL && number_of_sets > eviction->memory.number_of_sets) {
+    return false;
+  }
 
-inline void
-evict(congruent_address_cache_entry_t* congruent_address_cache_entry)
-{
-#ifdef PTHREAD_ENABLE
-  pthread_mutex_lock(&(congruent_address_cache_entry->lock));
-  if (congruent_address_cache_entry->used == false) {
-    pthread_mutex_unlock(&(congruent_address_cache_entry->lock));
-    return;
+  for (size_t i = 0; set_indices != NULL && i < number_of_sets; i++) {
+    if (set_indices[i] >= eviction->memory.number_of_sets) {
+      return false;
+    }
   }
+
+  // Sets without a large enough eviction set are built one by one before the
+  // memory is locked for the sweep
+  size_t first = 0;
+  while (true) {
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_lock(&(eviction->memory.lock));
 #endif
-  for (unsigned int i = 0; i < ES_EVICTION_COUNTER; i += 1) {
-    for (unsigned int j = 0; j < ES_NUMBER_OF_ACCESSES_IN_LOOP; j++) {
-      for (unsigned int k = 0; k < ES_DIFFERENT_ADDRESSES_IN_LOOP; k++) {
-        libflush_access_memory(congruent_address_cache_entry->congruent_virtual_addresses[i+k]);
+    for (; first < number_of_sets; first++) {
+      size_t index = (set_indices != NULL) ? set_indices[first] : first;
+      congruent_address_cache_entry_t* entry = eviction->congruent_address_cache[index];
+      if (entry == NULL || entry->number_of_addresses < number_of_addresses) {
+        break;
       }
     }
-  }
+
+    if (first == number_of_sets) {
+      return true;
+    }
+
 #ifdef PTHREAD_ENABLE
-  pthread_mutex_unlock(&(congruent_address_cache_entry->lock));
+    pthread_mutex_unlock(&(eviction->memory.lock));
 #endif
+
+    for (size_t i = first; i < number_of_sets; i++) {
+      size_t index = (set_indices != NULL) ? set_indices[i] : i;
+      congruent_address_cache_entry_t* entry = get_congruent_addresses(session, eviction,
+          index, 0, number_of_addresses);
+      if (entry == NULL) {
+        return false;
+      }
+      put_congruent_addresses(entry);
+    }
+  }
 }
 
-inline void
-find_congruent_addresses(libflush_session_t* session, libflush_eviction_t*
-    eviction, size_t index, uintptr_t physical_address)
+void
+libflush_eviction_sweep_end(libflush_session_t* session)
 {
-  // Find congruent addresses
-  unsigned int found = 0;
-  for (unsigned int i = 0; i < eviction->memory.mapping_size; i += LINE_LENGTH) {
-#ifdef PTHREAD_ENABLE
-    pthread_mutex_lock(&(eviction->memory.lock));
-#endif
-    uint8_t* virtual_address_2 = (uint8_t*) eviction->memory.mapping + i;
 #ifdef PTHREAD_ENABLE
-    pthread_mutex_unlock(&(eviction->memory.lock));
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+  pthread_mutex_unlock(&(eviction->memory.lock));
+#else
+  (void) session;
 #endif
-    uintptr_t physical_address_2 = libflush_get_physical_address(session, (uintptr_t) virtual_address_2);
-    uint64_t index_2 = (physical_address_2 >> LINE_LENGTH_LOG2) % NUMBER_OF_SETS;
+}
 
-    if (index == index_2 && physical_address != physical_address_2) {
-      eviction->congruent_address_cache[index].congruent_virtual_addresses[found++] =
-        virtual_address_2;
-    }
+void
+libflush_eviction_sweep_prime(libflush_session_t* session, size_t set_index)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+  const eviction_strategy_t* strategy = &(eviction->strategy);
+
+  strategy->function(eviction->memory.mapping,
+      eviction->congruent_address_cache[set_index]->lines, eviction->memory.line_length_log2,
+      &(strategy->parameters));
+}
 
-    if (found == ADDRESS_COUNT) {
-      break;
+void
+libflush_eviction_sweep_probe(libflush_session_t* session, size_t set_index)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+  size_t number_of_addresses = eviction->strategy.number_of_addresses;
+  const uint8_t* pool = eviction->memory.mapping;
+  unsigned int line_length_log2 = eviction->memory.line_length_log2;
+  const uint32_t* lines = eviction->congruent_address_cache[set_index]->lines;
+
+  if (eviction->access != LIBFLUSH_EVICTION_ACCESS_ARRAY) {
+    probe_chain(pool, lines, line_length_log2, number_of_addresses);
+  } else {
+    for (size_t i = number_of_addresses; i > 0; i--) {
+      libflush_access_memory(get_line_address(pool, lines[i - 1], line_length_log2));
     }
   }
+}
+
+bool
+libflush_eviction_evict_level(libflush_session_t* session, void* address, unsigned int level)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (level != 0 && level == eviction->last_level) {
+    return evict_address(session, eviction, address, &(eviction->strategy));
+  }
+
+  eviction_level_t* eviction_level = get_level(eviction, level);
+  if (eviction_level == NULL) {
+    return false;
+  }
+
+  size_t set_index;
+  uintptr_t physical_address;
+  if (get_level_set_index(session, eviction, eviction_level, address, &set_index,
+        &physical_address) == false) {
+    return false;
+  }
+
+  congruent_address_cache_entry_t* entry = get_level_congruent_addresses(session, eviction,
+      eviction_level, set_index, physical_address);
+  if (entry == NULL) {
+    return false;
+  }
+
+  eviction_level->strategy.function(eviction->memory.mapping, entry->lines,
+      eviction->memory.line_length_log2, &(eviction_level->strategy.parameters));
+  put_congruent_addresses(entry);
+
+  return true;
+}
+
+bool
+libflush_eviction_prime_level(libflush_session_t* session, size_t set_index,
+    unsigned int level)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (level != 0 && level == eviction->last_level) {
+    if (set_index >= eviction->memory.number_of_sets) {
+      return false;
+    }
+
+    return prime_set(session, eviction, set_index);
+  }
+
+  eviction_level_t* eviction_level = get_level(eviction, level);
+  if (eviction_level == NULL || set_index >= ((size_t) 1 << eviction_level->number_of_sets_log2)) {
+    return false;
+  }
+
+  congruent_address_cache_entry_t* entry = get_level_congruent_addresses(session, eviction,
+      eviction_level, set_index, 0);
+  if (entry == NULL) {
+    return false;
+  }
+
+  eviction_level->strategy.function(eviction->memory.mapping, entry->lines,
+      eviction->memory.line_length_log2, &(eviction_level->strategy.parameters));
+  put_congruent_addresses(entry);
+
+  return true;
+}
+
+bool
+libflush_eviction_probe_level(libflush_session_t* session, size_t set_index,
+    unsigned int level)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (level != 0 && level == eviction->last_level) {
+    if (set_index >= eviction->memory.number_of_sets) {
+      return false;
+    }
+
+    return probe_set(session, eviction, set_index);
+  }
+
+  eviction_level_t* eviction_level = get_level(eviction, level);
+  if (eviction_level == NULL || set_index >= ((size_t) 1 << eviction_level->number_of_sets_log2)) {
+    return false;
+  }
+
+  congruent_address_cache_entry_t* entry = get_level_congruent_addresses(session, eviction,
+      eviction_level, set_index, 0);
+  if (entry == NULL) {
+    return false;
+  }
+
+  for (size_t i = eviction_level->strategy.number_of_addresses; i > 0; i--) {
+    libflush_access_memory(get_line_address(eviction->memory.mapping, entry->lines[i - 1],
+        eviction->memory.line_length_log2));
+  }
+  put_congruent_addresses(entry);
+
+  return true;
+}
+
+bool
+libflush_eviction_get_level_set_index(libflush_session_t* session, void* address,
+    unsigned int level, size_t* set_index)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (level != 0 && level == eviction->last_level) {
+    *set_index = libflush_eviction_get_set_index(session, address);
+    return true;
+  }
+
+  eviction_level_t* eviction_level = get_level(eviction, level);
+  if (eviction_level == NULL) {
+    return false;
+  }
+
+  uintptr_t physical_address;
+  return get_level_set_index(session, eviction, eviction_level, address, set_index,
+      &physical_address);
+}
+
+size_t
+libflush_eviction_get_level_number_of_sets(libflush_session_t* session, unsigned int level)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (level != 0 && level == eviction->last_level) {
+    return eviction->memory.number_of_sets;
+  }
+
+  eviction_level_t* eviction_level = get_level(eviction, level);
+  if (eviction_level == NULL) {
+    return 0;
+  }
+
+  return (size_t) 1 << eviction_level->number_of_sets_log2;
+}
+
+bool
+libflush_eviction_set_level_strategy(libflush_session_t* session, unsigned int level,
+    const libflush_eviction_strategy_t* strategy)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (level != 0 && level == eviction->last_level) {
+    return libflush_eviction_set_strategy(session, strategy);
+  }
+
+  eviction_level_t* eviction_level = get_level(eviction, level);
+  if (eviction_level == NULL) {
+    return false;
+  }
+
+  return level_strategy_init(eviction, eviction_level, strategy);
+}
+
+bool
+libflush_eviction_get_level_strategy(libflush_session_t* session, unsigned int level,
+    libflush_eviction_strategy_t* strategy)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (level != 0 && level == eviction->last_level) {
+    libflush_eviction_get_strategy(session, strategy);
+    return true;
+  }
+
+  eviction_level_t* eviction_level = get_level(eviction, level);
+  if (eviction_level == NULL) {
+    return false;
+  }
+
+  *strategy = eviction_level->strategy.parameters;
+
+  return true;
+}
+
+/* Builds the eviction set of a request for the session strategy, including
+ * its compiled routines */
+static void
+build_requested_set(libflush_eviction_t* eviction, const builder_request_t* request)
+{
+  // Discovered eviction sets are complete
+  if (request->index >= eviction->memory.number_of_sets) {
+    return;
+  }
+
+  congruent_address_cache_entry_t* entry = get_congruent_addresses(eviction->builder.session,
+      eviction, request->index, request->physical_address,
+      eviction->strategy.number_of_addresses);
+  if (entry == NULL) {
+    return;
+  }
+
+  get_jit_routines(eviction, entry);
+  put_congruent_addresses(entry);
+}
+
+static bool
+builder_push(builder_t* builder, size_t index, uintptr_t physical_address)
+{
+  if (builder->first_request + builder->number_of_requests == builder->capacity) {
+    // Move the pending requests to the front before the array grows
+    memmove(builder->requests, builder->requests + builder->first_request,
+        builder->number_of_requests * sizeof(builder_request_t));
+    builder->first_request = 0;
+
+    if (builder->number_of_requests == builder->capacity) {
+      size_t capacity = (builder->capacity == 0) ? 64 : builder->capacity * 2;
+      builder_request_t* requests = realloc(builder->requests,
+          capacity * sizeof(builder_request_t));
+      if (requests == NULL) {
+        return false;
+      }
+      builder->requests = requests;
+      builder->capacity = capacity;
+    }
+  }
+
+  builder_request_t* request = &(builder->requests[builder->first_request +
+      builder->number_of_requests++]);
+  request->index = index;
+  request->physical_address = physical_address;
+
+  return true;
+}
+
+static bool
+builder_pop(builder_t* builder, builder_request_t* request)
+{
+  if (builder->number_of_requests > 0) {
+    *request = builder->requests[builder->first_request++];
+    if (--builder->number_of_requests == 0) {
+      builder->first_request = 0;
+    }
+    return true;
+  }
+
+  if (builder->next_set < builder->number_of_sets) {
+    request->index = builder->next_set++;
+    request->physical_address = 0;
+    return true;
+  }
+
+  return false;
+}
+
+#ifdef PTHREAD_ENABLE
+static void*
+builder_run(void* data)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) data;
+  builder_t* builder = &(eviction->builder);
+
+  pthread_mutex_lock(&(builder->lock));
+  while (builder->stop == false) {
+    builder_request_t request;
+    if (builder_pop(builder, &request) == false) {
+      builder->busy = false;
+      pthread_cond_broadcast(&(builder->finished));
+      pthread_cond_wait(&(builder->requested), &(builder->lock));
+      continue;
+    }
+
+    builder->busy = true;
+    pthread_mutex_unlock(&(builder->lock));
+    build_requested_set(eviction, &request);
+    pthread_mutex_lock(&(builder->lock));
+  }
+  builder->busy = false;
+  pthread_cond_broadcast(&(builder->finished));
+  pthread_mutex_unlock(&(builder->lock));
+
+  return NULL;
+}
+#endif
+
+static void
+builder_init(libflush_session_t* session, builder_t* builder)
+{
+  builder->session = session;
+
+#ifdef PTHREAD_ENABLE
+  bool initialized = (pthread_mutex_init(&(builder->lock), NULL) == 0 &&
+      pthread_cond_init(&(builder->requested), NULL) == 0 &&
+      pthread_cond_init(&(builder->finished), NULL) == 0);
+  assert(initialized == true);
+  (void) initialized;
+#endif
+}
+
+static void
+builder_terminate(builder_t* builder)
+{
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(builder->lock));
+  builder->stop = true;
+  pthread_cond_broadcast(&(builder->requested));
+  pthread_mutex_unlock(&(builder->lock));
+
+  if (builder->running == true) {
+    pthread_join(builder->thread, NULL);
+    builder->running = false;
+  }
+
+  pthread_cond_destroy(&(builder->finished));
+  pthread_cond_destroy(&(builder->requested));
+  pthread_mutex_destroy(&(builder->lock));
+#endif
+
+  free(builder->requests);
+  builder->requests = NULL;
+  builder->number_of_requests = 0;
+  builder->capacity = 0;
+}
+
+bool
+libflush_eviction_prepare(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+  builder_t* builder = &(eviction->builder);
+
+  // Addresses are translated by the caller, so the builder only uses the pool
+  size_t* indices = NULL;
+  uintptr_t* physical_addresses = NULL;
+  if (addresses != NULL) {
+    indices = calloc(number_of_addresses, sizeof(size_t));
+    physical_addresses = calloc(number_of_addresses, sizeof(uintptr_t));
+    if (indices == NULL || physical_addresses == NULL) {
+      free(indices);
+      free(physical_addresses);
+      return false;
+    }
+
+    for (size_t i = 0; i < number_of_addresses; i++) {
+      if (get_address_set_index(session, eviction, addresses[i], &(indices[i]),
+            &(physical_addresses[i])) == false) {
+        free(indices);
+        free(physical_addresses);
+        return false;
+      }
+    }
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(builder->lock));
+#endif
+
+  bool result = true;
+  if (addresses == NULL) {
+    builder->number_of_sets = eviction->memory.number_of_sets;
+  }
+  for (size_t i = 0; addresses != NULL && i < number_of_addresses && result == true; i++) {
+    result = builder_push(builder, indices[i], physical_addresses[i]);
+  }
+
+  free(indices);
+  free(physical_addresses);
+
+#ifdef PTHREAD_ENABLE
+  if (builder->running == false && builder->stop == false) {
+    builder->running = (pthread_create(&(builder->thread), NULL, builder_run, eviction) == 0);
+  }
+
+  if (builder->running == true) {
+    pthread_cond_signal(&(builder->requested));
+    pthread_mutex_unlock(&(builder->lock));
+    return result;
+  }
+
+  pthread_mutex_unlock(&(builder->lock));
+#endif
+
+  // Without a thread the sets are built by the caller
+  libflush_eviction_wait(session);
+
+  return result;
+}
+
+void
+libflush_eviction_wait(libflush_session_t* session)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+  builder_t* builder = &(eviction->builder);
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(builder->lock));
+  if (builder->running == true) {
+    while (builder->busy == true || builder->number_of_requests > 0 ||
+        builder->next_set < builder->number_of_sets) {
+      pthread_cond_wait(&(builder->finished), &(builder->lock));
+    }
+    pthread_mutex_unlock(&(builder->lock));
+    return;
+  }
+#endif
+
+  builder_request_t request;
+  while (builder_pop(builder, &request) == true) {
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_unlock(&(builder->lock));
+#endif
+    build_requested_set(eviction, &request);
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_lock(&(builder->lock));
+#endif
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(builder->lock));
+#endif
+}
+
+static bool
+is_set_ready(libflush_eviction_t* eviction, size_t index)
+{
+  if (index >= eviction->memory.number_of_sets) {
+    return true;
+  }
+
+  congruent_address_cache_entry_t* entry =
+    __atomic_load_n(&(eviction->congruent_address_cache[index]), __ATOMIC_ACQUIRE);
+
+  return entry != NULL && __atomic_load_n(&(entry->number_of_addresses), __ATOMIC_ACQUIRE) >=
+    eviction->strategy.number_of_addresses;
+}
+
+bool
+libflush_eviction_is_ready(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  if (addresses == NULL) {
+    for (size_t i = 0; i < eviction->memory.number_of_sets; i++) {
+      if (is_set_ready(eviction, i) == false) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Addresses that have not been prepared or evicted yet are not translated
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    uintptr_t line = (uintptr_t) addresses[i] >> eviction->memory.line_length_log2;
+    size_t index;
+    if (virtual_address_cache_lookup(&(eviction->virtual_address_cache), line, &index) == false ||
+        is_set_ready(eviction, index) == false) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Makes the discovered eviction set the one of the line. A set discovered
+ * again for the same line replaces the previous one. */
+static bool
+store_discovered_set(libflush_eviction_t* eviction, uintptr_t line, uint32_t* lines,
+    size_t number_of_addresses)
+{
+  size_t number_of_sets = eviction->memory.number_of_sets;
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(eviction->memory.lock));
+#endif
+
+  size_t index;
+  congruent_address_cache_entry_t* entry = NULL;
+  if (virtual_address_cache_lookup(&(eviction->virtual_address_cache), line, &index) == true &&
+      index >= number_of_sets) {
+    entry = &(eviction->discovered_sets[index - number_of_sets]);
+  } else {
+    if (eviction->discovered_sets == NULL) {
+      eviction->discovered_sets = calloc(DISCOVERY_MAXIMUM_SETS,
+          sizeof(congruent_address_cache_entry_t));
+    }
+
+    if (eviction->discovered_sets == NULL ||
+        eviction->number_of_discovered_sets == DISCOVERY_MAXIMUM_SETS) {
+#ifdef PTHREAD_ENABLE
+      pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+      return false;
+    }
+
+    index = number_of_sets + eviction->number_of_discovered_sets;
+    entry = &(eviction->discovered_sets[eviction->number_of_discovered_sets]);
+#ifdef PTHREAD_ENABLE
+    bool initialized = (pthread_mutex_init(&(entry->lock), NULL) == 0);
+    assert(initialized == true);
+    (void) initialized;
+#endif
+
+    // The line is cached before its set is filled, so a reader that finds it
+    // meanwhile sees an empty set and does not evict
+    if (virtual_address_cache_insert(&(eviction->virtual_address_cache), line, index,
+          VIRTUAL_ADDRESS_CACHE_PINNED) == false) {
+#ifdef PTHREAD_ENABLE
+      pthread_mutex_destroy(&(entry->lock));
+      pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+      return false;
+    }
+    eviction->number_of_discovered_sets++;
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(entry->lock));
+#endif
+  destroy_jit_routines(entry);
+  free(entry->lines);
+  entry->lines = lines;
+  entry->number_of_addresses = number_of_addresses;
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(entry->lock));
+#endif
+
+  eviction->discovered_number_of_addresses = number_of_addresses;
+  for (size_t i = 0; i < eviction->number_of_discovered_sets; i++) {
+    if (eviction->discovered_sets[i].number_of_addresses < eviction->discovered_number_of_addresses) {
+      eviction->discovered_number_of_addresses = eviction->discovered_sets[i].number_of_addresses;
+    }
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+
+  return true;
+}
+
+bool
+libflush_eviction_discover(libflush_session_t* session, void* address,
+    const libflush_discovery_args_t* args, libflush_discovery_result_t* result)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+  memory_t* memory = &(eviction->memory);
+
+  // Chains would link lines that belong to the eviction set of a set index as
+  // well
+  if (eviction->access != LIBFLUSH_EVICTION_ACCESS_ARRAY) {
+    return false;
+  }
+
+  // The page offset is part of the set index, so only the lines of the pool
+  // with the page offset of the address are candidates. The pool holds up to
+  // number_of_addresses lines of every set.
+  uintptr_t target = (uintptr_t) address & ~(((uintptr_t) 1 << memory->line_length_log2) - 1);
+  uintptr_t offset = target & ((1 << PAGE_SIZE_LOG2) - 1);
+  size_t number_of_candidates = memory->mapping_size >> PAGE_SIZE_LOG2;
+  size_t number_of_addresses = (memory->mapping_size >> memory->line_length_log2) /
+    memory->number_of_sets;
+
+  void** candidates = calloc(number_of_candidates, sizeof(void*));
+  void** addresses = calloc(number_of_addresses, sizeof(void*));
+  if (candidates == NULL || addresses == NULL) {
+    free(candidates);
+    free(addresses);
+    return false;
+  }
+
+  for (size_t i = 0; i < number_of_candidates; i++) {
+    candidates[i] = (uint8_t*) memory->mapping + (i << PAGE_SIZE_LOG2) + offset;
+  }
+
+  libflush_eviction_discovery_t discovery;
+  libflush_eviction_discovery_init(&discovery, session, (void*) target, args);
+  size_t found = libflush_eviction_discovery_run(&discovery, candidates, number_of_candidates,
+      addresses, number_of_addresses);
+  free(candidates);
+
+  if (result != NULL) {
+    *result = discovery.result;
+  }
+
+  // The eviction set has to be large enough for the session strategy
+  if (found == 0 || found < eviction->strategy.number_of_addresses) {
+    free(addresses);
+    return false;
+  }
+
+  uint32_t* lines = calloc(found, sizeof(uint32_t));
+  if (lines == NULL) {
+    free(addresses);
+    return false;
+  }
+
+  for (size_t i = 0; i < found; i++) {
+    lines[i] = ((uint8_t*) addresses[i] - (uint8_t*) memory->mapping) >> memory->line_length_log2;
+  }
+  free(addresses);
+
+  if (store_discovered_set(eviction, target >> memory->line_length_log2, lines, found) == false) {
+    free(lines);
+    return false;
+  }
+
+  return true;
+}
+
+size_t
+libflush_eviction_get_number_of_sets(libflush_session_t* session)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  return eviction->memory.number_of_sets;
+}
+
+size_t
+libflush_eviction_get_number_of_slices(libflush_session_t* session)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  return eviction->memory.slice_hash.number_of_slices;
+}
+
+size_t
+libflush_eviction_get_set_index(libflush_session_t* session, void* address)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  uintptr_t physical_address = libflush_get_physical_address(session, (uintptr_t) address);
+  return get_set_index(&(eviction->memory), physical_address);
+}
+
+libflush_eviction_pages_t
+libflush_eviction_get_pages(libflush_session_t* session)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  return eviction->memory.pages;
+}
+
+int
+libflush_eviction_get_node(libflush_session_t* session)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  return eviction->memory.node;
+}
+
+libflush_eviction_profile_state_t
+libflush_eviction_get_profile_state(libflush_session_t* session)
+{
+  libflush_eviction_t* eviction = (libflush_eviction_t*) session->data;
+
+  return eviction->memory.profile_state;
+}
+
+#if USE_FIXED_MEMORY_SIZE == 0
+static size_t
+get_physical_memory_size(void)
+{
+  struct sysinfo info;
+  sysinfo(&info);
+
+  return info.totalram * info.mem_unit;
+}
+#endif
+
+/* Eviction strategies */
+
+typedef void (*access_function_t)(void* address, void* data);
+
+/* The access pattern of every strategy. Instantiated with constant numbers of
+ * accesses and different addresses, the inner loops are unrolled by the
+ * compiler. The access function is inlined as well, so the same pattern both
+ * evicts and is compiled to a routine. */
+static inline __attribute__((always_inline)) void
+strategy_loop(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters,
+    size_t number_of_accesses_in_loop, size_t different_addresses_in_loop,
+    access_function_t access, void* data)
+{
+  for (size_t i = 0; i < parameters->eviction_counter; i += parameters->step_size) {
+    for (size_t j = 0; j < number_of_accesses_in_loop; j++) {
+      for (size_t k = 0; k < different_addresses_in_loop; k++) {
+        access(get_line_address(pool, lines[i + k], line_length_log2), data);
+      }
+    }
+  }
+
+  if (parameters->mirroring == true) {
+    size_t last = ((parameters->eviction_counter - 1) / parameters->step_size) * parameters->step_size;
+    for (size_t i = last + parameters->step_size; i > 0; i -= parameters->step_size) {
+      for (size_t j = 0; j < number_of_accesses_in_loop; j++) {
+        for (size_t k = different_addresses_in_loop; k > 0; k--) {
+          access(get_line_address(pool, lines[i - parameters->step_size + k - 1],
+                line_length_log2), data);
+        }
+      }
+    }
+  }
+}
+
+static inline __attribute__((always_inline)) void
+access_address(void* address, void* data)
+{
+  (void) data;
+
+  libflush_access_memory(address);
+}
+
+static inline __attribute__((always_inline)) void
+evict_loop(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters,
+    size_t number_of_accesses_in_loop, size_t different_addresses_in_loop)
+{
+  strategy_loop(pool, lines, line_length_log2, parameters, number_of_accesses_in_loop,
+      different_addresses_in_loop, access_address, NULL);
+}
+
+/* Volatile loads, so that the walks are kept although their final link is not
+ * used */
+static inline chain_link_t*
+chain_next(chain_link_t* link)
+{
+  return *((chain_link_t* volatile*) &(link->next));
+}
+
+static inline chain_link_t*
+chain_previous(chain_link_t* link)
+{
+  return *((chain_link_t* volatile*) &(link->previous));
+}
+
+/* The access pattern of strategy_loop as walks along the chain. Every round
+ * starts at a link that the previous round reached, so the first access of a
+ * line depends on the load of its predecessor and misses are serialized. If
+ * the step skips lines, the next round starts at the address of the array
+ * instead of walking over lines the strategy does not access. */
+static inline __attribute__((always_inline)) void
+evict_chain_loop(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters,
+    size_t number_of_accesses_in_loop, size_t different_addresses_in_loop)
+{
+  size_t step_size = parameters->step_size;
+  chain_link_t* round = get_line_address(pool, lines[0], line_length_log2);
+
+  for (size_t i = 0; i < parameters->eviction_counter; i += step_size) {
+    for (size_t j = 0; j < number_of_accesses_in_loop; j++) {
+      chain_link_t* link = round;
+      for (size_t k = 0; k < different_addresses_in_loop; k++) {
+        link = chain_next(link);
+      }
+    }
+    if (i + step_size < parameters->eviction_counter) {
+      if (step_size > different_addresses_in_loop) {
+        round = get_line_address(pool, lines[i + step_size], line_length_log2);
+      } else {
+        for (size_t k = 0; k < step_size; k++) {
+          round = chain_next(round);
+        }
+      }
+    }
+  }
+
+  if (parameters->mirroring == true) {
+    // The last round is walked from its last line backwards
+    size_t last = ((parameters->eviction_counter - 1) / step_size) * step_size;
+    for (size_t k = 1; k < different_addresses_in_loop; k++) {
+      round = chain_next(round);
+    }
+
+    for (size_t i = last + step_size; i > 0; i -= step_size) {
+      for (size_t j = 0; j < number_of_accesses_in_loop; j++) {
+        chain_link_t* link = round;
+        for (size_t k = 0; k < different_addresses_in_loop; k++) {
+          link = chain_previous(link);
+        }
+      }
+      if (i > step_size) {
+        if (step_size > different_addresses_in_loop) {
+          round = get_line_address(pool,
+              lines[i - 2 * step_size + different_addresses_in_loop - 1], line_length_log2);
+        } else {
+          for (size_t k = 0; k < step_size; k++) {
+            round = chain_previous(round);
+          }
+        }
+      }
+    }
+  }
+}
+
+static void
+probe_chain(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, size_t number_of_addresses)
+{
+  chain_link_t* link = get_line_address(pool, lines[number_of_addresses - 1],
+      line_length_log2);
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    link = chain_previous(link);
+  }
+}
+
+static void
+evict_generic(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters)
+{
+  evict_loop(pool, lines, line_length_log2, parameters,
+      parameters->number_of_accesses_in_loop, parameters->different_addresses_in_loop);
+}
+
+static void
+evict_configured(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters)
+{
+  evict_loop(pool, lines, line_length_log2, parameters, ES_NUMBER_OF_ACCESSES_IN_LOOP,
+      ES_DIFFERENT_ADDRESSES_IN_LOOP);
+}
+
+static void
+evict_chain_generic(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters)
+{
+  evict_chain_loop(pool, lines, line_length_log2, parameters,
+      parameters->number_of_accesses_in_loop, parameters->different_addresses_in_loop);
+}
+
+static void
+evict_chain_configured(const uint8_t* pool, const uint32_t* lines,
+    unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters)
+{
+  evict_chain_loop(pool, lines, line_length_log2, parameters, ES_NUMBER_OF_ACCESSES_IN_LOOP,
+      ES_DIFFERENT_ADDRESSES_IN_LOOP);
+}
+
+/* Shapes (accesses, different addresses) of the shipped device configurations */
+#define EVICTION_VARIANTS(X) \
+  X(1, 1) X(1, 2) X(1, 6) X(2, 2) X(2, 5) X(5, 4) X(10, 10)
+
+#define EVICTION_VARIANT_FUNCTION(a, d) \
+  static void \
+  evict_##a##_##d(const uint8_t* pool, const uint32_t* lines, \
+      unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters) \
+  { \
+    evict_loop(pool, lines, line_length_log2, parameters, a, d); \
+  } \
+  static void \
+  evict_chain_##a##_##d(const uint8_t* pool, const uint32_t* lines, \
+      unsigned int line_length_log2, const libflush_eviction_strategy_t* parameters) \
+  { \
+    evict_chain_loop(pool, lines, line_length_log2, parameters, a, d); \
+  }
+
+EVICTION_VARIANTS(EVICTION_VARIANT_FUNCTION)
+
+#define EVICTION_VARIANT_ENTRY(a, d) { a, d, evict_##a##_##d, evict_chain_##a##_##d },
+
+static const struct {
+  size_t number_of_accesses_in_loop;
+  size_t different_addresses_in_loop;
+  eviction_function_t function;
+  eviction_function_t chain_function;
+} eviction_variants[] = {
+  EVICTION_VARIANTS(EVICTION_VARIANT_ENTRY)
+};
+
+static bool
+eviction_strategy_init(libflush_eviction_t* eviction, eviction_strategy_t* strategy,
+    const libflush_eviction_strategy_t* parameters)
+{
+  static const libflush_eviction_strategy_t configured = {
+    .eviction_counter = ES_EVICTION_COUNTER,
+    .number_of_accesses_in_loop = ES_NUMBER_OF_ACCESSES_IN_LOOP,
+    .different_addresses_in_loop = ES_DIFFERENT_ADDRESSES_IN_LOOP,
+    .step_size = ES_STEP_SIZE,
+    .mirroring = ES_MIRRORING
+  };
+
+  if (parameters == NULL || parameters->eviction_counter == 0) {
+    parameters = &configured;
+  }
+
+  // The pool holds this many lines of every set
+  eviction_strategy_t selected;
+  if (select_strategy(&selected, parameters, (eviction->memory.mapping_size >>
+          eviction->memory.line_length_log2) / eviction->memory.number_of_sets,
+        eviction->access != LIBFLUSH_EVICTION_ACCESS_ARRAY) == false) {
+    return false;
+  }
+
+  // Discovered eviction sets cannot be extended
+  if (eviction->number_of_discovered_sets > 0 &&
+      selected.number_of_addresses > eviction->discovered_number_of_addresses) {
+    return false;
+  }
+
+  *strategy = selected;
+
+  return true;
+}
+
+/* Validates a strategy for eviction sets of at most the given number of lines
+ * and selects the loop that implements it */
+static bool
+select_strategy(eviction_strategy_t* strategy, const libflush_eviction_strategy_t* parameters,
+    size_t maximum_number_of_addresses, bool chain)
+{
+  if (parameters->number_of_accesses_in_loop == 0 || parameters->different_addresses_in_loop == 0) {
+    return false;
+  }
+
+  size_t number_of_addresses = parameters->eviction_counter +
+    parameters->different_addresses_in_loop - 1;
+  if (number_of_addresses > maximum_number_of_addresses) {
+    return false;
+  }
+
+  strategy->parameters = *parameters;
+  if (strategy->parameters.step_size == 0) {
+    strategy->parameters.step_size = 1;
+  }
+  strategy->number_of_addresses = number_of_addresses;
+  strategy->function = chain ? evict_chain_generic : evict_generic;
+
+  if (parameters->number_of_accesses_in_loop == ES_NUMBER_OF_ACCESSES_IN_LOOP &&
+      parameters->different_addresses_in_loop == ES_DIFFERENT_ADDRESSES_IN_LOOP) {
+    strategy->function = chain ? evict_chain_configured : evict_configured;
+  } else {
+    for (size_t i = 0; i < sizeof(eviction_variants) / sizeof(eviction_variants[0]); i++) {
+      if (eviction_variants[i].number_of_accesses_in_loop == parameters->number_of_accesses_in_loop &&
+          eviction_variants[i].different_addresses_in_loop == parameters->different_addresses_in_loop) {
+        strategy->function = chain ? eviction_variants[i].chain_function :
+          eviction_variants[i].function;
+        break;
+      }
+    }
+  }
+
+  return true;
+}
+
+/* Congruent addresses */
+
+/* Returns the eviction set in the given slot, which is allocated on first use.
+ * Allocation is serialized by the lock of the memory, lookups are lock-free. */
+static congruent_address_cache_entry_t*
+get_congruent_address_cache_entry(libflush_eviction_t* eviction,
+    congruent_address_cache_entry_t** slot)
+{
+  congruent_address_cache_entry_t* entry = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+  if (entry != NULL) {
+    return entry;
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(eviction->memory.lock));
+#else
+  (void) eviction;
+#endif
+
+  entry = *slot;
+  if (entry == NULL) {
+    entry = calloc(1, sizeof(congruent_address_cache_entry_t));
+    assert(entry != NULL);
+#ifdef PTHREAD_ENABLE
+    bool initialized = (pthread_mutex_init(&(entry->lock), NULL) == 0);
+    assert(initialized == true);
+    (void) initialized;
+#endif
+    __atomic_store_n(slot, entry, __ATOMIC_RELEASE);
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+
+  return entry;
+}
+
+/* Returns the locked eviction set of the given set with at least the given
+ * number of addresses, or NULL if the pool cannot be translated or the set has
+ * fewer lines */
+static congruent_address_cache_entry_t*
+get_congruent_addresses(libflush_session_t* session, libflush_eviction_t* eviction,
+    size_t index, uintptr_t physical_address, size_t number_of_addresses)
+{
+  if (index >= eviction->memory.number_of_sets) {
+    congruent_address_cache_entry_t* entry =
+      &(eviction->discovered_sets[index - eviction->memory.number_of_sets]);
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_lock(&(entry->lock));
+#endif
+    if (entry->number_of_addresses < number_of_addresses) {
+      put_congruent_addresses(entry);
+      return NULL;
+    }
+    return entry;
+  }
+
+  congruent_address_cache_entry_t* entry = get_congruent_address_cache_entry(eviction,
+      &(eviction->congruent_address_cache[index]));
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(entry->lock));
+#endif
+
+  if (entry->number_of_addresses < number_of_addresses &&
+      find_congruent_addresses(session, eviction, index, physical_address,
+        number_of_addresses) == false) {
+    put_congruent_addresses(entry);
+    return NULL;
+  }
+
+  return entry;
+}
+
+static void
+put_congruent_addresses(congruent_address_cache_entry_t* entry)
+{
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(entry->lock));
+#else
+  (void) entry;
+#endif
+}
+
+/* Compiled routines */
+
+static void
+count_access(void* address, void* data)
+{
+  (void) address;
+
+  (*(size_t*) data)++;
+}
+
+static void
+emit_access(void* address, void* data)
+{
+  libflush_eviction_jit_emit_access((libflush_eviction_jit_routine_t*) data, address);
+}
+
+static void
+compile_jit_routines(const eviction_strategy_t* strategy, const uint8_t* pool,
+    const uint32_t* lines, unsigned int line_length_log2, jit_routines_t* routines)
+{
+  const libflush_eviction_strategy_t* parameters = &(strategy->parameters);
+
+  size_t number_of_accesses = 0;
+  strategy_loop(pool, lines, line_length_log2, parameters,
+      parameters->number_of_accesses_in_loop, parameters->different_addresses_in_loop,
+      count_access, &number_of_accesses);
+
+  if (libflush_eviction_jit_begin(&(routines->evict), number_of_accesses) == true) {
+    strategy_loop(pool, lines, line_length_log2, parameters,
+        parameters->number_of_accesses_in_loop, parameters->different_addresses_in_loop,
+        emit_access, &(routines->evict));
+    libflush_eviction_jit_finish(&(routines->evict));
+  }
+
+  // The probe accesses the eviction set once in reverse order
+  if (libflush_eviction_jit_begin(&(routines->probe), strategy->number_of_addresses) == true) {
+    for (size_t i = strategy->number_of_addresses; i > 0; i--) {
+      libflush_eviction_jit_emit_access(&(routines->probe),
+          get_line_address(pool, lines[i - 1], line_length_log2));
+    }
+    libflush_eviction_jit_finish(&(routines->probe));
+  }
+}
+
+/* Returns the routines of the locked eviction set for the session strategy,
+ * compiling them on first use, or NULL if compilation is disabled */
+static jit_routines_t*
+get_jit_routines(libflush_eviction_t* eviction, congruent_address_cache_entry_t* entry)
+{
+  if (eviction->jit == false) {
+    return NULL;
+  }
+
+  jit_routines_t* routines = entry->jit_routines;
+  if (routines != NULL && routines->generation == eviction->strategy_generation) {
+    return routines;
+  }
+
+  destroy_jit_routines(entry);
+
+  routines = calloc(1, sizeof(jit_routines_t));
+  if (routines == NULL) {
+    return NULL;
+  }
+
+  routines->generation = eviction->strategy_generation;
+  compile_jit_routines(&(eviction->strategy), eviction->memory.mapping, entry->lines,
+      eviction->memory.line_length_log2, routines);
+  entry->jit_routines = routines;
+
+  return routines;
+}
+
+static void
+destroy_jit_routines(congruent_address_cache_entry_t* entry)
+{
+  if (entry->jit_routines == NULL) {
+    return;
+  }
+
+  libflush_eviction_jit_destroy(&(entry->jit_routines->evict));
+  libflush_eviction_jit_destroy(&(entry->jit_routines->probe));
+  free(entry->jit_routines);
+  entry->jit_routines = NULL;
+}
+
+/* Returns the set index table of the pool, which buckets all lines of the
+ * populated pool by their set index on first use. An incremental pool is
+ * populated on first use as well. Returns NULL if the pool cannot be
+ * translated. The lock of the memory has to be held. */
+static const set_index_table_t*
+get_set_index_table(libflush_session_t* session, memory_t* memory)
+{
+  set_index_table_t* table = &(memory->set_index_table);
+  if (table->unavailable == true) {
+    return NULL;
+  }
+
+  if (table->lines == NULL) {
+    if (memory->populated_size == 0) {
+      populate_next_region(memory);
+    }
+
+    // Without the pagemap every further attempt would fail as well
+    if (build_set_index_table(session, memory) == false) {
+      table->unavailable = true;
+      return NULL;
+    }
+    store_set_index_table(memory);
+  }
+
+  return table;
+}
+
+/* Populates the next region of an incremental pool and rebuilds the set index
+ * table over the populated pool, which is the same table the previous one
+ * extends. Returns false if the pool is fully populated or the table cannot be
+ * rebuilt. The lock of the memory has to be held. */
+static bool
+grow_set_index_table(libflush_session_t* session, memory_t* memory)
+{
+  if (populate_next_region(memory) == false) {
+    return false;
+  }
+
+  free(memory->set_index_table.offsets);
+  free(memory->set_index_table.lines);
+  memory->set_index_table.offsets = NULL;
+  memory->set_index_table.lines = NULL;
+
+  return get_set_index_table(session, memory) != NULL;
+}
+
+/* Returns false if the set index table of the pool is unavailable or the set
+ * has fewer lines than requested */
+static bool
+find_congruent_addresses(libflush_session_t* session, libflush_eviction_t*
+    eviction, size_t index, uintptr_t physical_address, size_t number_of_addresses)
+{
+  congruent_address_cache_entry_t* entry = eviction->congruent_address_cache[index];
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(eviction->memory.lock));
+#endif
+
+  const set_index_table_t* table = get_set_index_table(session, &(eviction->memory));
+  if (table == NULL) {
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+    return false;
+  }
+
+  uint32_t* lines = realloc(entry->lines, number_of_addresses * sizeof(uint32_t));
+  assert(lines != NULL);
+  entry->lines = lines;
+
+  // Find congruent addresses. The lines are always taken in the same order, so
+  // a larger set extends the previous one. An incremental pool is populated
+  // further until the set has enough lines.
+  size_t found;
+  do {
+    found = 0;
+    for (uint32_t i = table->offsets[index]; i < table->offsets[index + 1]; i++) {
+      // The pool is private, so only small pages are translated to rule out the
+      // target itself
+      bool congruent = true;
+      if (eviction->memory.pages == LIBFLUSH_EVICTION_PAGES_SMALL) {
+        void* virtual_address_2 = get_line_address(eviction->memory.mapping, table->lines[i],
+            eviction->memory.line_length_log2);
+        congruent = (libflush_get_physical_address(session, (uintptr_t) virtual_address_2)
+            != physical_address);
+      }
+
+      if (congruent == true) {
+        lines[found++] = table->lines[i];
+      }
+
+      if (found == number_of_addresses) {
+        break;
+      }
+    }
+  } while (found < number_of_addresses &&
+      grow_set_index_table(session, &(eviction->memory)) == true);
+
+  // A failed rebuild leaves no table. The pages of the pool are not spread
+  // evenly over the sets, so a set may also have fewer lines than the strategy
+  // needs although the pool has enough on average. The set keeps its previous
+  // size then.
+  if (table->lines == NULL || found < number_of_addresses) {
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+    return false;
+  }
+
+  // Readiness queries read the size without the lock of the set
+  __atomic_store_n(&(entry->number_of_addresses), found, __ATOMIC_RELEASE);
+
+  if (eviction->access != LIBFLUSH_EVICTION_ACCESS_ARRAY) {
+    link_congruent_addresses(eviction, index, lines, found);
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(eviction->memory.lock));
+#endif
+
+  return true;
+}
+
+/* xorshift64* */
+static uint64_t
+next_random(uint64_t* state)
+{
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 0x2545f4914f6cdd1dULL;
+}
+
+/* Links the lines of an eviction set in their order, which is shuffled first
+ * for random chains. Every set draws from its own sequence, so sets can be
+ * linked concurrently. */
+static void
+link_congruent_addresses(libflush_eviction_t* eviction, size_t index, uint32_t* lines,
+    size_t number_of_addresses)
+{
+  if (eviction->access == LIBFLUSH_EVICTION_ACCESS_RANDOM_CHAIN) {
+    uint64_t state = eviction->chain_seed ^ ((index + 1) * 0x9e3779b97f4a7c15ULL);
+    if (state == 0) {
+      state = 1;
+    }
+
+    for (size_t i = number_of_addresses - 1; i > 0; i--) {
+      size_t j = next_random(&state) % (i + 1);
+      uint32_t line = lines[i];
+      lines[i] = lines[j];
+      lines[j] = line;
+    }
+  }
+
+  const uint8_t* pool = eviction->memory.mapping;
+  unsigned int line_length_log2 = eviction->memory.line_length_log2;
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    chain_link_t* link = get_line_address(pool, lines[i], line_length_log2);
+    link->next = (i + 1 < number_of_addresses) ?
+      get_line_address(pool, lines[i + 1], line_length_log2) : NULL;
+    link->previous = (i > 0) ? get_line_address(pool, lines[i - 1], line_length_log2) : NULL;
+  }
+}
+
+/* Cache levels */
+
+/* Adds the data and unified caches below the evicted cache whose sets are
+ * unions of its sets: they have the same line length and at most as many sets
+ * as a slice of the evicted cache. The set index table requires the pagemap. */
+static void
+levels_init(libflush_session_t* session, libflush_eviction_t* eviction)
+{
+  const libflush_cache_geometry_t* last_level = libflush_geometry_get_last_level(session);
+  if (last_level == NULL) {
+    return;
+  }
+
+  eviction->last_level = last_level->level;
+
+#if HAVE_PAGEMAP_ACCESS == 1
+  const memory_t* memory = &(eviction->memory);
+  for (size_t i = 0; i < session->geometry.number_of_caches; i++) {
+    const libflush_cache_geometry_t* cache = &(session->geometry.caches[i]);
+    if (cache->type == LIBFLUSH_CACHE_TYPE_INSTRUCTION || cache->level >= last_level->level ||
+        get_level(eviction, cache->level) != NULL ||
+        cache->line_length != ((size_t) 1 << memory->line_length_log2) ||
+        is_power_of_two(cache->number_of_sets) == false ||
+        cache->number_of_sets > ((size_t) 1 << memory->sets_per_slice_log2) ||
+        cache->associativity == 0) {
+      continue;
+    }
+
+    eviction_level_t* level = &(eviction->levels[eviction->number_of_levels]);
+    level->level = cache->level;
+    level->number_of_sets_log2 = __builtin_ctzl(cache->number_of_sets);
+    level->associativity = cache->associativity;
+    if (level_strategy_init(eviction, level, NULL) == false) {
+      continue;
+    }
+
+    level->congruent_address_cache = calloc(cache->number_of_sets,
+        sizeof(congruent_address_cache_entry_t*));
+    if (level->congruent_address_cache == NULL) {
+      continue;
+    }
+
+    eviction->number_of_levels++;
+  }
+#endif
+}
+
+/* Validates a strategy for the sets of a level. Without an eviction counter the
+ * default strategy of the level is used. */
+static bool
+level_strategy_init(libflush_eviction_t* eviction, eviction_level_t* level,
+    const libflush_eviction_strategy_t* parameters)
+{
+  libflush_eviction_strategy_t configured = {
+    .eviction_counter = level->associativity,
+    .number_of_accesses_in_loop = LEVEL_ES_NUMBER_OF_ACCESSES_IN_LOOP,
+    .different_addresses_in_loop = LEVEL_ES_DIFFERENT_ADDRESSES_IN_LOOP,
+    .step_size = 1,
+    .mirroring = false
+  };
+
+  if (parameters == NULL || parameters->eviction_counter == 0) {
+    parameters = &configured;
+  }
+
+  return select_strategy(&(level->strategy), parameters,
+      (eviction->memory.mapping_size >> eviction->memory.line_length_log2) >>
+      level->number_of_sets_log2, false);
+}
+
+static eviction_level_t*
+get_level(libflush_eviction_t* eviction, unsigned int level)
+{
+  for (size_t i = 0; i < eviction->number_of_levels; i++) {
+    if (eviction->levels[i].level == level) {
+      return &(eviction->levels[i]);
+    }
+  }
+
+  return NULL;
+}
+
+/* Returns the set of an address within a level. Sets that are indexed by the
+ * page offset are not translated, otherwise the physical address is
+ * translated unless the address is cached, as for the evicted cache.
+ * Addresses with a discovered eviction set or that cannot be translated have no
+ * set index. */
+static bool
+get_level_set_index(libflush_session_t* session, libflush_eviction_t* eviction,
+    const eviction_level_t* level, void* address, size_t* set_index,
+    uintptr_t* physical_address)
+{
+  unsigned int line_length_log2 = eviction->memory.line_length_log2;
+  size_t set_mask = ((size_t) 1 << level->number_of_sets_log2) - 1;
+
+  if (level->number_of_sets_log2 + line_length_log2 <= PAGE_SIZE_LOG2) {
+    *physical_address = 0;
+    *set_index = ((uintptr_t) address >> line_length_log2) & set_mask;
+    return true;
+  }
+
+  size_t index;
+  if (get_address_set_index(session, eviction, address, &index, physical_address) == false ||
+      index >= eviction->memory.number_of_sets) {
+    return false;
+  }
+
+  // The sets of the level divide the sets of a slice
+  *set_index = index & set_mask;
+
+  return true;
+}
+
+static congruent_address_cache_entry_t*
+get_level_congruent_addresses(libflush_session_t* session, libflush_eviction_t* eviction,
+    eviction_level_t* level, size_t set_index, uintptr_t physical_address)
+{
+  congruent_address_cache_entry_t* entry = get_congruent_address_cache_entry(eviction,
+      &(level->congruent_address_cache[set_index]));
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(entry->lock));
+#endif
+
+  if (entry->number_of_addresses < level->strategy.number_of_addresses &&
+      find_level_congruent_addresses(session, eviction, level, set_index, physical_address,
+        level->strategy.number_of_addresses) == false) {
+    put_congruent_addresses(entry);
+    return NULL;
+  }
+
+  return entry;
+}
+
+/* Takes the lines of a set of a level in rounds from the sets of the evicted
+ * cache that map to it, one line of every set per round. The eviction set then
+ * fills none of these sets, and a larger set extends the previous one. Returns
+ * false if the set index table of the pool is unavailable or the set has fewer
+ * lines than requested. */
+static bool
+find_level_congruent_addresses(libflush_session_t* session, libflush_eviction_t* eviction,
+    eviction_level_t* level, size_t set_index, uintptr_t physical_address,
+    size_t number_of_addresses)
+{
+  congruent_address_cache_entry_t* entry = level->congruent_address_cache[set_index];
+  memory_t* memory = &(eviction->memory);
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(memory->lock));
+#endif
+
+  const set_index_table_t* table = get_set_index_table(session, memory);
+  if (table == NULL) {
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_unlock(&(memory->lock));
+#endif
+    return false;
+  }
+
+  uint32_t* lines = realloc(entry->lines, number_of_addresses * sizeof(uint32_t));
+  assert(lines != NULL);
+  entry->lines = lines;
+
+  size_t stride = (size_t) 1 << level->number_of_sets_log2;
+  size_t found;
+  do {
+    found = 0;
+    bool exhausted = false;
+    for (uint32_t round = 0; found < number_of_addresses && exhausted == false; round++) {
+      exhausted = true;
+      for (size_t index = set_index; index < memory->number_of_sets &&
+          found < number_of_addresses; index += stride) {
+        if (table->offsets[index] + round >= table->offsets[index + 1]) {
+          continue;
+        }
+        exhausted = false;
+
+        // As for the evicted cache, only small pages are translated to rule out
+        // the target itself
+        uint32_t line = table->lines[table->offsets[index] + round];
+        if (memory->pages == LIBFLUSH_EVICTION_PAGES_SMALL &&
+            libflush_get_physical_address(session, (uintptr_t) get_line_address(memory->mapping,
+                line, memory->line_length_log2)) == physical_address) {
+          continue;
+        }
+
+        lines[found++] = line;
+      }
+    }
+  } while (found < number_of_addresses && grow_set_index_table(session, memory) == true);
+
+  // A failed rebuild leaves no table, and the sets of the evicted cache may
+  // not hold enough lines, as for the evicted cache
+  if (table->lines == NULL || found < number_of_addresses) {
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_unlock(&(memory->lock));
+#endif
+    return false;
+  }
+
+  __atomic_store_n(&(entry->number_of_addresses), found, __ATOMIC_RELEASE);
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(memory->lock));
+#endif
+
+  return true;
+}
+
+/* Eviction pool */
+
+/* Checks in /proc/self/smaps that the range is backed by transparent huge
+ * pages, which the kernel may refuse to allocate despite the advice. */
+static bool
+is_backed_by_transparent_huge_pages(void* mapping, size_t size)
+{
+  FILE* smaps = fopen("/proc/self/smaps", "r");
+  if (smaps == NULL) {
+    return false;
+  }
+
+  uintptr_t first = (uintptr_t) mapping;
+  uintptr_t last = first + size;
+  bool in_range = false;
+  size_t huge = 0;
+
+  char line[256];
+  while (fgets(line, sizeof(line), smaps) != NULL) {
+    unsigned long start, end;
+    size_t kilobytes;
+
+    if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+      in_range = (start < last && end > first);
+    } else if (in_range == true && sscanf(line, "AnonHugePages: %zu kB", &kilobytes) == 1) {
+      huge += kilobytes * 1024;
+    }
+  }
+
+  fclose(smaps);
+
+  return huge >= size;
+}
+
+static void*
+map_transparent_huge_pages(size_t size)
+{
+#ifdef MADV_HUGEPAGE
+  // Map one additional huge page to align the mapping
+  size_t aligned_size = size + HUGE_PAGE_SIZE;
+  uint8_t* mapping = mmap(NULL, aligned_size, PROT_READ | PROT_WRITE,
+      MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (mapping == MAP_FAILED) {
+    return NULL;
+  }
+
+  uint8_t* aligned = (uint8_t*) (((uintptr_t) mapping + HUGE_PAGE_SIZE - 1) &
+      ~((uintptr_t) HUGE_PAGE_SIZE - 1));
+  if (aligned != mapping) {
+    munmap(mapping, aligned - mapping);
+  }
+  munmap(aligned + size, (mapping + aligned_size) - (aligned + size));
+
+  // Pages are populated after the advice, so that they are allocated huge
+  if (madvise(aligned, size, MADV_HUGEPAGE) == 0) {
+    for (size_t offset = 0; offset < size; offset += 1 << PAGE_SIZE_LOG2) {
+      aligned[offset] = 0;
+    }
+
+    if (is_backed_by_transparent_huge_pages(aligned, size) == true) {
+      return aligned;
+    }
+  }
+
+  munmap(aligned, size);
+#else
+  (void) size;
+#endif
+
+  return NULL;
+}
+
+/* Maps the pool, which is only populated on request. Transparent huge pages are
+ * always populated to check that they are backed by huge pages. */
+static bool
+map_memory(memory_t* memory, libflush_eviction_pages_t pages, bool populate)
+{
+  int flags = MAP_ANONYMOUS | MAP_PRIVATE | (populate ? MAP_POPULATE : 0);
+
+  if (pages == LIBFLUSH_EVICTION_PAGES_HUGE || pages == LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE) {
+    size_t size = ((memory->mapping_size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+
+#ifdef MAP_HUGETLB
+    if (pages == LIBFLUSH_EVICTION_PAGES_HUGE) {
+      void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+      if (mapping != MAP_FAILED) {
+        memory->mapping = mapping;
+        memory->mapping_size = size;
+        memory->populated_size = populate ? size : 0;
+        memory->pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+        return true;
+      }
+    }
+#endif
+
+    void* mapping = map_transparent_huge_pages(size);
+    if (mapping != NULL) {
+      memory->mapping = mapping;
+      memory->mapping_size = size;
+      memory->populated_size = size;
+      memory->pages = LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE;
+      return true;
+    }
+  }
+
+  void* mapping = mmap(NULL, memory->mapping_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  memory->mapping = mapping;
+  memory->populated_size = populate ? memory->mapping_size : 0;
+  memory->pages = LIBFLUSH_EVICTION_PAGES_SMALL;
+
+  return true;
+}
+
+/* Maps the pool from a shared file, whose pages are kept by the kernel until
+ * the file is removed. Files on hugetlbfs are backed by huge pages, all other
+ * files are treated as backed by small pages. */
+static bool
+map_pool_file(memory_t* memory, const char* path, bool populate)
+{
+  int fd = open(path, O_RDWR | O_CREAT, 0600);
+  if (fd == -1) {
+    return false;
+  }
+
+  size_t size = memory->mapping_size;
+  struct statfs file_system;
+  bool huge = (fstatfs(fd, &file_system) == 0 &&
+      (uint32_t) file_system.f_type == HUGETLBFS_MAGIC);
+  if (huge == true) {
+    size = ((size + file_system.f_bsize - 1) / file_system.f_bsize) * file_system.f_bsize;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || ((size_t) status.st_size < size && ftruncate(fd, size) != 0)) {
+    close(fd);
+    return false;
+  }
+
+  void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | (populate ? MAP_POPULATE : 0), fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  memory->mapping = mapping;
+  memory->mapping_size = size;
+  memory->populated_size = populate ? size : 0;
+  memory->pages = huge ? LIBFLUSH_EVICTION_PAGES_HUGE : LIBFLUSH_EVICTION_PAGES_SMALL;
+
+  return true;
+}
+
+/* Runs every worker of an array of workers of the given size on a thread of
+ * its own, the last one on the calling thread */
+static void
+run_workers(void* (*function)(void*), void* workers, size_t worker_size,
+    size_t number_of_workers)
+{
+  uint8_t* worker = (uint8_t*) workers;
+
+#ifdef PTHREAD_ENABLE
+  pthread_t* threads = calloc(number_of_workers, sizeof(pthread_t));
+  size_t started = 0;
+
+  if (threads != NULL) {
+    for (; started < number_of_workers - 1; started++) {
+      if (pthread_create(&(threads[started]), NULL, function,
+            worker + started * worker_size) != 0) {
+        break;
+      }
+    }
+  }
+
+  // Run the remaining workers on the calling thread
+  for (size_t i = started; i < number_of_workers; i++) {
+    function(worker + i * worker_size);
+  }
+
+  for (size_t i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  free(threads);
+#else
+  for (size_t i = 0; i < number_of_workers; i++) {
+    function(worker + i * worker_size);
+  }
+#endif
+}
+
+typedef struct populate_worker_s {
+  uint8_t* start;
+  size_t size;
+} populate_worker_t;
+
+/* Populates a range chunk by chunk. Where the kernel cannot populate writable
+ * pages on request, every page is written without changing its contents, as
+ * the pages of a pool file may be in use by another session. */
+static void*
+populate_range(void* data)
+{
+  populate_worker_t* worker = (populate_worker_t*) data;
+
+  for (size_t offset = 0; offset < worker->size; offset += POPULATE_CHUNK_SIZE) {
+    size_t length = worker->size - offset;
+    if (length > POPULATE_CHUNK_SIZE) {
+      length = POPULATE_CHUNK_SIZE;
+    }
+
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(worker->start + offset, length, MADV_POPULATE_WRITE) == 0) {
+      continue;
+    }
+#endif
+
+    for (size_t page = 0; page < length; page += 1 << PAGE_SIZE_LOG2) {
+      __atomic_fetch_add(worker->start + offset + page, 0, __ATOMIC_RELAXED);
+    }
+  }
+
+  return NULL;
+}
+
+/* Populates the pool up to the given size. With pthread support the chunks are
+ * split among threads, which page faults of distinct ranges do not
+ * serialize. */
+static void
+populate_pool(memory_t* memory, size_t size)
+{
+  size_t first = memory->populated_size;
+  if (size <= first) {
+    return;
+  }
+
+  size_t number_of_chunks = (size - first + POPULATE_CHUNK_SIZE - 1) / POPULATE_CHUNK_SIZE;
+  size_t number_of_workers = 1;
+
+#ifdef PTHREAD_ENABLE
+  number_of_workers = POPULATE_NUMBER_OF_THREADS;
+  if (number_of_workers == 0) {
+    number_of_workers = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (number_of_workers == 0) {
+    number_of_workers = 1;
+  } else if (number_of_workers > number_of_chunks) {
+    number_of_workers = number_of_chunks;
+  }
+#endif
+
+  populate_worker_t single;
+  populate_worker_t* workers = (number_of_workers > 1) ?
+    calloc(number_of_workers, sizeof(populate_worker_t)) : NULL;
+  if (workers == NULL) {
+    workers = &single;
+    number_of_workers = 1;
+  }
+
+  size_t chunks_per_worker = (number_of_chunks + number_of_workers - 1) / number_of_workers;
+  for (size_t i = 0; i < number_of_workers; i++) {
+    size_t start = first + i * chunks_per_worker * POPULATE_CHUNK_SIZE;
+    size_t end = start + chunks_per_worker * POPULATE_CHUNK_SIZE;
+    workers[i].start = (uint8_t*) memory->mapping + ((start < size) ? start : size);
+    workers[i].size = ((end < size) ? end : size) - ((start < size) ? start : size);
+  }
+
+  run_workers(populate_range, workers, sizeof(populate_worker_t), number_of_workers);
+
+  if (workers != &single) {
+    free(workers);
+  }
+
+  // Write every 1 KiB of the new pages, as the pool was initialized before
+  // it was populated on request
+  if (memory->touch == true) {
+    for (uint64_t index = first; index < size; index += 0x400) {
+      uint64_t* temporary = (uint64_t*) (((uint8_t*) memory->mapping) + index);
+      temporary[0] = index;
+    }
+  }
+
+  memory->populated_size = size;
+}
+
+/* Populates the next region of an incremental pool. The populated size doubles,
+ * so the set index table is rebuilt a logarithmic number of times. */
+static bool
+populate_next_region(memory_t* memory)
+{
+  if (memory->populated_size >= memory->mapping_size) {
+    return false;
+  }
+
+  size_t size = (memory->populated_size == 0) ? POPULATE_CHUNK_SIZE :
+    2 * memory->populated_size;
+  if (size > memory->mapping_size) {
+    size = memory->mapping_size;
+  }
+
+  populate_pool(memory, size);
+
+  return true;
+}
+
+/* Set index table */
+
+typedef struct set_index_worker_s {
+  const uint64_t* page_frame_numbers;
+  size_t first_page;
+  size_t last_page;
+  uint32_t* counts;
+  const memory_t* memory;
+  set_index_table_t* table;
+} set_index_worker_t;
+
+static inline size_t
+get_set_index_of_line(const memory_t* memory, uint64_t page_frame_number, size_t line)
+{
+  uintptr_t physical_address = (page_frame_number << PAGE_SIZE_LOG2) |
+    (line << memory->line_length_log2);
+
+  return get_set_index(memory, physical_address);
+}
+
+static inline size_t
+get_lines_per_page(const memory_t* memory)
+{
+  return (size_t) 1 << (PAGE_SIZE_LOG2 - memory->line_length_log2);
+}
+
+static void*
+set_index_count(void* data)
+{
+  set_index_worker_t* worker = (set_index_worker_t*) data;
+  size_t lines_per_page = get_lines_per_page(worker->memory);
+
+  for (size_t page = worker->first_page; page < worker->last_page; page++) {
+    for (size_t line = 0; line < lines_per_page; line++) {
+      worker->counts[get_set_index_of_line(worker->memory, worker->page_frame_numbers[page],
+          line)]++;
+    }
+  }
+
+  return NULL;
+}
+
+/* Every worker writes its lines starting at the cursors in counts */
+static void*
+set_index_fill(void* data)
+{
+  set_index_worker_t* worker = (set_index_worker_t*) data;
+  size_t lines_per_page = get_lines_per_page(worker->memory);
+
+  for (size_t page = worker->first_page; page < worker->last_page; page++) {
+    for (size_t line = 0; line < lines_per_page; line++) {
+      size_t index = get_set_index_of_line(worker->memory, worker->page_frame_numbers[page],
+          line);
+      worker->table->lines[worker->counts[index]++] = page * lines_per_page + line;
+    }
+  }
+
+  return NULL;
+}
+
+/* Within a huge page the physical offset equals the virtual offset, which
+ * determines the set index unless the slice has to be known */
+static bool
+is_set_index_within_huge_page(const memory_t* memory)
+{
+  return memory->pages != LIBFLUSH_EVICTION_PAGES_SMALL &&
+    ((uint64_t) 1 << (memory->sets_per_slice_log2 + memory->line_length_log2)) <= HUGE_PAGE_SIZE &&
+    memory->slice_hash.number_of_slices == 1;
+}
+
+static bool
+fill_set_index_table(libflush_session_t* session, memory_t* memory,
+    uint64_t* page_frame_numbers, set_index_worker_t* workers, size_t number_of_workers,
+    uint32_t* counts)
+{
+  set_index_table_t* table = &(memory->set_index_table);
+  size_t number_of_pages = memory->populated_size >> PAGE_SIZE_LOG2;
+
+  if (is_set_index_within_huge_page(memory) == true) {
+    for (size_t page = 0; page < number_of_pages; page++) {
+      page_frame_numbers[page] = page & (HUGE_PAGE_SIZE / (1 << PAGE_SIZE_LOG2) - 1);
+    }
+  } else {
+    // Translate the whole pool with a single pagemap read, which fails without
+    // the pagemap
+    if (libflush_translate_range(session, (uintptr_t) memory->mapping, number_of_pages,
+          page_frame_numbers) == false) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < number_of_workers; i++) {
+    workers[i].page_frame_numbers = page_frame_numbers;
+    workers[i].first_page = number_of_pages * i / number_of_workers;
+    workers[i].last_page = number_of_pages * (i + 1) / number_of_workers;
+    workers[i].counts = counts + i * memory->number_of_sets;
+    workers[i].memory = memory;
+    workers[i].table = table;
+  }
+
+  run_workers(set_index_count, workers, sizeof(set_index_worker_t), number_of_workers);
+
+  // Turn the counts into the positions every worker starts to write at. Lines
+  // of earlier workers precede the ones of later workers.
+  uint32_t position = 0;
+  for (size_t index = 0; index < memory->number_of_sets; index++) {
+    table->offsets[index] = position;
+    for (size_t i = 0; i < number_of_workers; i++) {
+      uint32_t count = workers[i].counts[index];
+      workers[i].counts[index] = position;
+      position += count;
+    }
+  }
+  table->offsets[memory->number_of_sets] = position;
+
+  run_workers(set_index_fill, workers, sizeof(set_index_worker_t), number_of_workers);
+
+  return true;
+}
+
+static bool
+build_set_index_table(libflush_session_t* session, memory_t* memory)
+{
+  size_t number_of_pages = memory->populated_size >> PAGE_SIZE_LOG2;
+  size_t number_of_workers = 1;
+
+#ifdef PTHREAD_ENABLE
+  number_of_workers = SET_INDEX_NUMBER_OF_THREADS;
+  if (number_of_workers == 0) {
+    number_of_workers = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (number_of_workers == 0 || number_of_workers > number_of_pages) {
+    number_of_workers = 1;
+  }
+#endif
+
+  set_index_table_t* table = &(memory->set_index_table);
+  uint64_t* page_frame_numbers = calloc(number_of_pages, sizeof(uint64_t));
+  set_index_worker_t* workers = calloc(number_of_workers, sizeof(set_index_worker_t));
+  uint32_t* counts = calloc(number_of_workers * memory->number_of_sets, sizeof(uint32_t));
+  table->offsets = calloc(memory->number_of_sets + 1, sizeof(uint32_t));
+  table->lines = calloc(number_of_pages * get_lines_per_page(memory), sizeof(uint32_t));
+
+  bool result = false;
+  if (page_frame_numbers != NULL && workers != NULL && counts != NULL &&
+      table->offsets != NULL && table->lines != NULL) {
+    result = fill_set_index_table(session, memory, page_frame_numbers, workers,
+        number_of_workers, counts);
+  }
+
+  if (result == false) {
+    free(table->offsets);
+    free(table->lines);
+    table->offsets = NULL;
+    table->lines = NULL;
+  }
+
+  free(page_frame_numbers);
+  free(workers);
+  free(counts);
+
+  return result;
+}
+
+static void
+get_profile(const memory_t* memory, libflush_eviction_profile_t* profile)
+{
+  profile->line_length_log2 = memory->line_length_log2;
+  profile->number_of_sets = memory->number_of_sets;
+  profile->number_of_slices = memory->slice_hash.number_of_slices;
+  profile->number_of_lines = memory->mapping_size >> memory->line_length_log2;
+}
+
+/* Checks that a line of a sample of the sets still belongs to its set. A pool
+ * that is backed by other physical pages than the one the table was computed
+ * for fails for almost every sample. */
+static bool
+validate_set_index_table(libflush_session_t* session, const memory_t* memory)
+{
+  const set_index_table_t* table = &(memory->set_index_table);
+
+  for (size_t i = 0; i < PROFILE_VALIDATION_SAMPLES; i++) {
+    size_t index = memory->number_of_sets * i / PROFILE_VALIDATION_SAMPLES;
+    uint32_t count = table->offsets[index + 1] - table->offsets[index];
+    if (count == 0) {
+      continue;
+    }
+
+    uint32_t line = table->lines[table->offsets[index] + count * i / PROFILE_VALIDATION_SAMPLES];
+    size_t page = line / get_lines_per_page(memory);
+
+    uint64_t page_frame_number;
+    if (is_set_index_within_huge_page(memory) == true) {
+      page_frame_number = page & (HUGE_PAGE_SIZE / (1 << PAGE_SIZE_LOG2) - 1);
+    } else if (libflush_translate_range(session, (uintptr_t) memory->mapping +
+          (page << PAGE_SIZE_LOG2), 1, &page_frame_number) == false) {
+      return false;
+    }
+
+    if (get_set_index_of_line(memory, page_frame_number, line % get_lines_per_page(memory)) !=
+        index) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static libflush_eviction_profile_state_t
+load_set_index_table(libflush_session_t* session, memory_t* memory)
+{
+  if (access(memory->profile_file, F_OK) != 0) {
+    return LIBFLUSH_EVICTION_PROFILE_MISSING;
+  }
+
+  libflush_eviction_profile_t profile;
+  get_profile(memory, &profile);
+
+  set_index_table_t* table = &(memory->set_index_table);
+  if (libflush_eviction_profile_load(memory->profile_file, &profile, &(table->offsets),
+        &(table->lines)) == false) {
+    return LIBFLUSH_EVICTION_PROFILE_INVALID;
+  }
+
+  if (validate_set_index_table(session, memory) == false) {
+    free(table->offsets);
+    free(table->lines);
+    table->offsets = NULL;
+    table->lines = NULL;
+    return LIBFLUSH_EVICTION_PROFILE_INVALID;
+  }
+
+  return LIBFLUSH_EVICTION_PROFILE_LOADED;
+}
+
+/* Writes the freshly computed set index table to the profile. A failed write
+ * only costs the next session the computation. */
+static void
+store_set_index_table(memory_t* memory)
+{
+  if (memory->profile_file == NULL || memory->set_index_table.lines == NULL) {
+    return;
+  }
+
+  libflush_eviction_profile_t profile;
+  get_profile(memory, &profile);
+
+  libflush_eviction_profile_store(memory->profile_file, &profile,
+      memory->set_index_table.offsets, memory->set_index_table.lines);
+}
+
+/* Virtual address cache */
+
+static inline size_t
+virtual_address_cache_hash(const virtual_address_cache_table_t* table, uintptr_t line)
+{
+  return ((uint64_t) line * 0x9E3779B97F4A7C15ULL) >> table->shift;
+}
+
+static virtual_address_cache_table_t*
+virtual_address_cache_table_create(size_t size)
+{
+  virtual_address_cache_table_t* table = calloc(1, sizeof(virtual_address_cache_table_t) +
+      size * sizeof(virtual_address_cache_entry_t));
+  if (table == NULL) {
+    return NULL;
+  }
+
+  table->size = size;
+  table->shift = 64;
+  for (size_t s = size; s > 1; s >>= 1) {
+    table->shift--;
+  }
+
+  return table;
+}
+
+/* May run concurrently to a writer under PTHREAD_ENABLE, hence every field is
+ * accessed atomically and the probe sequence is bounded by the table size. */
+static virtual_address_cache_entry_t*
+virtual_address_cache_table_find(virtual_address_cache_table_t* table, uintptr_t line)
+{
+  size_t mask = table->size - 1;
+  size_t slot = virtual_address_cache_hash(table, line);
+
+  for (size_t i = 0; i < table->size; i++) {
+    virtual_address_cache_entry_t* entry = &(table->entries[(slot + i) & mask]);
+    uintptr_t entry_line = __atomic_load_n(&(entry->line), __ATOMIC_RELAXED);
+
+    if (entry_line == 0) {
+      return NULL;
+    }
+
+    if (entry_line == line) {
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+static bool
+virtual_address_cache_table_lookup(virtual_address_cache_table_t* table, uintptr_t line,
+    size_t* index)
+{
+  virtual_address_cache_entry_t* entry = virtual_address_cache_table_find(table, line);
+  if (entry == NULL) {
+    return false;
+  }
+
+  // Only an unreferenced entry is marked. A writer may move a pinned entry into
+  // the slot meanwhile, whose flag must not be overwritten.
+  *index = __atomic_load_n(&(entry->index), __ATOMIC_RELAXED);
+  if (__atomic_load_n(&(entry->referenced), __ATOMIC_RELAXED) == 0) {
+    uint32_t unreferenced = 0;
+    __atomic_compare_exchange_n(&(entry->referenced), &unreferenced, 1, false,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+  }
+
+  return true;
+}
+
+static void
+virtual_address_cache_table_store(virtual_address_cache_table_t* table, uintptr_t line,
+    size_t index, uint32_t referenced)
+{
+  size_t mask = table->size - 1;
+  size_t slot = virtual_address_cache_hash(table, line);
+
+  while (table->entries[slot].line != 0) {
+    slot = (slot + 1) & mask;
+  }
+
+  virtual_address_cache_entry_t* entry = &(table->entries[slot]);
+  __atomic_store_n(&(entry->index), index, __ATOMIC_RELAXED);
+  __atomic_store_n(&(entry->referenced), referenced, __ATOMIC_RELAXED);
+  __atomic_store_n(&(entry->line), line, __ATOMIC_RELAXED);
+}
+
+/* Removes the entry in the given slot and moves the following entries of the
+ * probe sequence back, so no tombstones are required. */
+static void
+virtual_address_cache_table_remove(virtual_address_cache_table_t* table, size_t slot)
+{
+  size_t mask = table->size - 1;
+  size_t hole = slot;
+
+  for (size_t i = (slot + 1) & mask; table->entries[i].line != 0; i = (i + 1) & mask) {
+    virtual_address_cache_entry_t* entry = &(table->entries[i]);
+    size_t home = virtual_address_cache_hash(table, entry->line);
+
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      virtual_address_cache_entry_t* target = &(table->entries[hole]);
+      __atomic_store_n(&(target->index), entry->index, __ATOMIC_RELAXED);
+      __atomic_store_n(&(target->referenced), entry->referenced, __ATOMIC_RELAXED);
+      __atomic_store_n(&(target->line), entry->line, __ATOMIC_RELAXED);
+      hole = i;
+    }
+  }
+
+  __atomic_store_n(&(table->entries[hole].line), 0, __ATOMIC_RELAXED);
+}
+
+/* Publishes a table of twice the size. The old table is not modified anymore,
+ * so readers that still use it find the same entries. */
+static bool
+virtual_address_cache_grow(virtual_address_cache_t* cache)
+{
+  virtual_address_cache_table_t* old_table = cache->table;
+  virtual_address_cache_table_t* table = virtual_address_cache_table_create(2 * old_table->size);
+  if (table == NULL) {
+    return false;
+  }
 
-  // Abort if we were not able to find enough addresses
-  assert(found == ADDRESS_COUNT);
+  for (size_t i = 0; i < old_table->size; i++) {
+    virtual_address_cache_entry_t* entry = &(old_table->entries[i]);
+    if (entry->line != 0) {
+      virtual_address_cache_table_store(table, entry->line, entry->index, entry->referenced);
+    }
+  }
+
+  table->previous = old_table;
+  __atomic_store_n(&(cache->table), table, __ATOMIC_RELEASE);
+  cache->hand = 0;
+
+  return true;
+}
+
+/* CLOCK replacement: the hand clears the referenced flag of the entries it
+ * passes and removes the first entry that has not been used since. Pinned
+ * entries are skipped, so nothing is removed if every entry is pinned. */
+static bool
+virtual_address_cache_replace(virtual_address_cache_t* cache)
+{
+  virtual_address_cache_table_t* table = cache->table;
+  size_t mask = table->size - 1;
+
+  for (size_t i = 0; i < 2 * table->size; i++, cache->hand = (cache->hand + 1) & mask) {
+    virtual_address_cache_entry_t* entry = &(table->entries[cache->hand]);
+    uint32_t referenced = __atomic_load_n(&(entry->referenced), __ATOMIC_RELAXED);
+    if (entry->line == 0 || referenced == VIRTUAL_ADDRESS_CACHE_PINNED) {
+      continue;
+    }
+
+    // Readers may set the flag again, so stop after a full round. The hand
+    // moves on, as removing entries in a single place would leave the rest of
+    // the table to fill up.
+    if (i >= table->size || referenced == 0) {
+      virtual_address_cache_table_remove(table, cache->hand);
+      cache->number_of_entries--;
+      cache->hand = (cache->hand + 1) & mask;
+      return true;
+    }
+
+    __atomic_store_n(&(entry->referenced), 0, __ATOMIC_RELAXED);
+  }
+
+  return false;
+}
+
+static bool
+virtual_address_cache_init(virtual_address_cache_t* cache)
+{
+  cache->table = virtual_address_cache_table_create(ADDRESS_CACHE_SIZE);
+  if (cache->table == NULL) {
+    return false;
+  }
+
+  cache->number_of_entries = 0;
+  cache->hand = 0;
+
+#ifdef PTHREAD_ENABLE
+  cache->sequence = 0;
+  if (pthread_mutex_init(&(cache->lock), NULL) != 0) {
+    free(cache->table);
+    cache->table = NULL;
+    return false;
+  }
+#endif
+
+  return true;
+}
+
+static void
+virtual_address_cache_terminate(virtual_address_cache_t* cache)
+{
+  virtual_address_cache_table_t* table = cache->table;
+  while (table != NULL) {
+    virtual_address_cache_table_t* previous = table->previous;
+    free(table);
+    table = previous;
+  }
+
+  cache->table = NULL;
+  cache->number_of_entries = 0;
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_destroy(&(cache->lock));
+#endif
+}
+
+/* Lock-free under PTHREAD_ENABLE: the lookup is retried if a writer modified
+ * the table in the meantime, which is detected by the sequence counter. */
+static bool
+virtual_address_cache_lookup(virtual_address_cache_t* cache, uintptr_t line, size_t* index)
+{
+#ifdef PTHREAD_ENABLE
+  unsigned int sequence;
+  bool found;
+
+  do {
+    sequence = __atomic_load_n(&(cache->sequence), __ATOMIC_ACQUIRE);
+    virtual_address_cache_table_t* table = __atomic_load_n(&(cache->table), __ATOMIC_ACQUIRE);
+    found = virtual_address_cache_table_lookup(table, line, index);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((sequence & 1) == 1 || __atomic_load_n(&(cache->sequence), __ATOMIC_RELAXED) != sequence);
+
+  return found;
+#else
+  return virtual_address_cache_table_lookup(cache->table, line, index);
+#endif
+}
+
+/* Entries with VIRTUAL_ADDRESS_CACHE_PINNED replace the index of a line that
+ * is already cached. Returns false if the cache is full of pinned entries and
+ * cannot grow. */
+static bool
+virtual_address_cache_insert(virtual_address_cache_t* cache, uintptr_t line, size_t index,
+    uint32_t referenced)
+{
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(cache->lock));
+#endif
+
+  virtual_address_cache_entry_t* cached = virtual_address_cache_table_find(cache->table, line);
+  if (cached != NULL) {
+    if (referenced == VIRTUAL_ADDRESS_CACHE_PINNED) {
+      __atomic_store_n(&(cached->index), index, __ATOMIC_RELAXED);
+      __atomic_store_n(&(cached->referenced), referenced, __ATOMIC_RELAXED);
+    }
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_unlock(&(cache->lock));
+#endif
+    return true;
+  }
+
+  // The hand removes entries in the order of the slots while new entries land
+  // anywhere, so the slots ahead of it hold up to twice the average load. A
+  // table that replaces entries is thus only filled up to three eighths.
+  bool full;
+  if (cache->table->size < ADDRESS_CACHE_MAX_SIZE) {
+    full = 4 * (cache->number_of_entries + 1) > 3 * cache->table->size &&
+      virtual_address_cache_grow(cache) == false;
+  } else {
+    full = 8 * (cache->number_of_entries + 1) > 3 * cache->table->size;
+  }
+
+#ifdef PTHREAD_ENABLE
+  __atomic_store_n(&(cache->sequence), cache->sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+
+  // Pinned entries are never replaced, so the cache grows beyond its maximum
+  // size if it holds nothing else
+  bool stored = false;
+  if (full == false || virtual_address_cache_replace(cache) == true ||
+      virtual_address_cache_grow(cache) == true) {
+    virtual_address_cache_table_store(cache->table, line, index, referenced);
+    cache->number_of_entries++;
+    stored = true;
+  }
+
+#ifdef PTHREAD_ENABLE
+  __atomic_store_n(&(cache->sequence), cache->sequence + 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&(cache->lock));
+#endif
 
-  eviction->congruent_address_cache[index].used = true;
+  return stored;
 }
@@ -8,11 +8,52 @@
 bool libflush_eviction_init(libflush_session_t* session, libflush_session_args_t* args);
 bool libflush_eviction_terminate(libflush_session_t* session);
 void libflush_eviction_evict(libflush_session_t* session, void* address);
+bool libflush_eviction_evict_strategy(libflush_session_t* session, void* address,
+    const libflush_eviction_strategy_t* strategy);
+
+bool libflush_eviction_set_strategy(libflush_session_t* session,
+    const libflush_eviction_strategy_t* strategy);
+void libflush_eviction_get_strategy(libflush_session_t* session,
+    libflush_eviction_strategy_t* strategy);
 
 void libflush_eviction_prime(libflush_session_t* session, size_t set_index);
 void libflush_eviction_probe(libflush_session_t* session, size_t set_index);
 
+bool libflush_eviction_evict_level(libflush_session_t* session, void* address,
+    unsigned int level);
+bool libflush_eviction_prime_level(libflush_session_t* session, size_t set_index,
+    unsigned int level);
+bool libflush_eviction_probe_level(libflush_session_t* session, size_t set_index,
+    unsigned int level);
+bool libflush_eviction_get_level_set_index(libflush_session_t* session, void* address,
+    unsigned int level, size_t* set_index);
+size_t libflush_eviction_get_level_number_of_sets(libflush_session_t* session,
+    unsigned int level);
+bool libflush_eviction_set_level_strategy(libflush_session_t* session, unsigned int level,
+    const libflush_eviction_strategy_t* strategy);
+bool libflush_eviction_get_level_strategy(libflush_session_t* session, unsigned int level,
+    libflush_eviction_strategy_t* strategy);
+
+bool libflush_eviction_sweep_begin(libflush_session_t* session, const size_t* set_indices,
+    size_t number_of_sets);
+void libflush_eviction_sweep_end(libflush_session_t* session);
+void libflush_eviction_sweep_prime(libflush_session_t* session, size_t set_index);
+void libflush_eviction_sweep_probe(libflush_session_t* session, size_t set_index);
+
+bool libflush_eviction_prepare(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses);
+void libflush_eviction_wait(libflush_session_t* session);
+bool libflush_eviction_is_ready(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses);
+
+bool libflush_eviction_discover(libflush_session_t* session, void* address,
+    const libflush_discovery_args_t* args, libflush_discovery_result_t* result);
+
 size_t libflush_eviction_get_set_index(libflush_session_t* session, void* address);
 size_t libflush_eviction_get_number_of_sets(libflush_session_t* session);
+size_t libflush_eviction_get_number_of_slices(libflush_session_t* session);
+libflush_eviction_pages_t libflush_eviction_get_pages(libflush_session_t* session);
+int libflush_eviction_get_node(libflush_session_t* session);
+libflush_eviction_profile_state_t libflush_eviction_get_profile_state(libflush_session_t* session);
 
 #endif // LIBFLUSH_EVICTION_H
@@ -0,0 +1,106 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+#include <sys/mman.h>
+
+#include "jit.h"
+
+#if defined(__x86_64__)
+/* endbr64, so the routine is a valid target of indirect calls with IBT */
+static const uint8_t prologue[] = { 0xf3, 0x0f, 0x1e, 0xfa };
+/* mov eax, [moffs64] */
+#define ACCESS_OPCODE 0xa1
+#define ACCESS_SIZE (1 + sizeof(uint64_t))
+/* ret */
+#define RETURN_OPCODE 0xc3
+#endif
+
+bool
+libflush_eviction_jit_is_available(void)
+{
+#if defined(__x86_64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool
+libflush_eviction_jit_begin(libflush_eviction_jit_routine_t* routine,
+    size_t number_of_accesses)
+{
+  memset(routine, 0, sizeof(libflush_eviction_jit_routine_t));
+
+#if defined(__x86_64__)
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t size = sizeof(prologue) + number_of_accesses * ACCESS_SIZE + 1;
+  size = ((size + page_size - 1) / page_size) * page_size;
+
+  void* code = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  if (code == MAP_FAILED) {
+    return false;
+  }
+
+  routine->code = code;
+  routine->size = size;
+
+  memcpy(code, prologue, sizeof(prologue));
+  routine->length = sizeof(prologue);
+
+  return true;
+#else
+  (void) number_of_accesses;
+  return false;
+#endif
+}
+
+void
+libflush_eviction_jit_emit_access(libflush_eviction_jit_routine_t* routine, void* address)
+{
+#if defined(__x86_64__)
+  assert(routine->length + ACCESS_SIZE < routine->size);
+
+  uint8_t* code = (uint8_t*) routine->code + routine->length;
+  uint64_t immediate = (uintptr_t) address;
+
+  code[0] = ACCESS_OPCODE;
+  memcpy(code + 1, &immediate, sizeof(immediate));
+  routine->length += ACCESS_SIZE;
+#else
+  (void) routine;
+  (void) address;
+#endif
+}
+
+bool
+libflush_eviction_jit_finish(libflush_eviction_jit_routine_t* routine)
+{
+#if defined(__x86_64__)
+  assert(routine->length < routine->size);
+
+  ((uint8_t*) routine->code)[routine->length++] = RETURN_OPCODE;
+
+  if (mprotect(routine->code, routine->size, PROT_READ | PROT_EXEC) != 0) {
+    libflush_eviction_jit_destroy(routine);
+    return false;
+  }
+
+  return true;
+#else
+  (void) routine;
+  return false;
+#endif
+}
+
+void
+libflush_eviction_jit_destroy(libflush_eviction_jit_routine_t* routine)
+{
+  if (routine->code != NULL) {
+    munmap(routine->code, routine->size);
+  }
+
+  memset(routine, 0, sizeof(libflush_eviction_jit_routine_t));
+}
@@ -0,0 +1,36 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef LIBFLUSH_EVICTION_JIT_H
+#define LIBFLUSH_EVICTION_JIT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Straight-line routine that loads a fixed sequence of addresses. The code is
+ * written while the mapping is writable and only executable once finished. */
+typedef struct libflush_eviction_jit_routine_s {
+  void* code;
+  size_t size;
+  size_t length;
+} libflush_eviction_jit_routine_t;
+
+bool libflush_eviction_jit_is_available(void);
+
+bool libflush_eviction_jit_begin(libflush_eviction_jit_routine_t* routine,
+    size_t number_of_accesses);
+void libflush_eviction_jit_emit_access(libflush_eviction_jit_routine_t* routine,
+    void* address);
+bool libflush_eviction_jit_finish(libflush_eviction_jit_routine_t* routine);
+void libflush_eviction_jit_destroy(libflush_eviction_jit_routine_t* routine);
+
+static inline void
+libflush_eviction_jit_call(const libflush_eviction_jit_routine_t* routine)
+{
+  // ISO C does not convert object pointers to function pointers
+  void (*function)(void);
+  memcpy(&function, &(routine->code), sizeof(function));
+  function();
+}
+
+#endif // LIBFLUSH_EVICTION_JIT_H
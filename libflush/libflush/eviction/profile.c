@@ -0,0 +1,164 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "profile.h"
+
+/* Incremented whenever the layout of the file changes */
+#define PROFILE_VERSION 1
+
+static const char profile_magic[8] = { 'L', 'I', 'B', 'F', 'L', 'P', 'R', 'F' };
+
+/* The header is followed by the offsets and the lines of the set index table
+ * in native byte order */
+typedef struct profile_header_s {
+  char magic[8];
+  uint32_t version;
+  uint32_t line_length_log2;
+  uint64_t number_of_sets;
+  uint64_t number_of_slices;
+  uint64_t number_of_lines;
+} profile_header_t;
+
+static void
+init_header(profile_header_t* header, const libflush_eviction_profile_t* profile)
+{
+  memset(header, 0, sizeof(profile_header_t));
+  memcpy(header->magic, profile_magic, sizeof(profile_magic));
+  header->version = PROFILE_VERSION;
+  header->line_length_log2 = profile->line_length_log2;
+  header->number_of_sets = profile->number_of_sets;
+  header->number_of_slices = profile->number_of_slices;
+  header->number_of_lines = profile->number_of_lines;
+}
+
+/* Every line of the pool belongs to exactly one set, so the offsets ascend up
+ * to the number of lines and every line occurs once */
+static bool
+is_consistent(const libflush_eviction_profile_t* profile, const uint32_t* offsets,
+    const uint32_t* lines)
+{
+  if (offsets[0] != 0 || offsets[profile->number_of_sets] != profile->number_of_lines) {
+    return false;
+  }
+
+  for (size_t i = 0; i < profile->number_of_sets; i++) {
+    if (offsets[i] > offsets[i + 1]) {
+      return false;
+    }
+  }
+
+  uint8_t* seen = calloc(profile->number_of_lines, sizeof(uint8_t));
+  if (seen == NULL) {
+    return false;
+  }
+
+  bool result = true;
+  for (size_t i = 0; i < profile->number_of_lines && result == true; i++) {
+    if (lines[i] >= profile->number_of_lines || seen[lines[i]] != 0) {
+      result = false;
+    } else {
+      seen[lines[i]] = 1;
+    }
+  }
+
+  free(seen);
+
+  return result;
+}
+
+bool
+libflush_eviction_profile_load(const char* path, const libflush_eviction_profile_t* profile,
+    uint32_t** offsets, uint32_t** lines)
+{
+  FILE* stream = fopen(path, "rb");
+  if (stream == NULL) {
+    return false;
+  }
+
+  profile_header_t expected;
+  init_header(&expected, profile);
+
+  profile_header_t header;
+  if (fread(&header, sizeof(header), 1, stream) != 1 ||
+      memcmp(&header, &expected, sizeof(header)) != 0) {
+    fclose(stream);
+    return false;
+  }
+
+  *offsets = calloc(profile->number_of_sets + 1, sizeof(uint32_t));
+  *lines = calloc(profile->number_of_lines, sizeof(uint32_t));
+
+  bool result = (*offsets != NULL && *lines != NULL &&
+      fread(*offsets, sizeof(uint32_t), profile->number_of_sets + 1, stream) ==
+        profile->number_of_sets + 1 &&
+      fread(*lines, sizeof(uint32_t), profile->number_of_lines, stream) ==
+        profile->number_of_lines &&
+      fgetc(stream) == EOF &&
+      is_consistent(profile, *offsets, *lines) == true);
+
+  fclose(stream);
+
+  if (result == false) {
+    free(*offsets);
+    free(*lines);
+    *offsets = NULL;
+    *lines = NULL;
+  }
+
+  return result;
+}
+
+bool
+libflush_eviction_profile_store(const char* path, const libflush_eviction_profile_t* profile,
+    const uint32_t* offsets, const uint32_t* lines)
+{
+  size_t length = strlen(path) + sizeof(".XXXXXX");
+  char* temporary = malloc(length);
+  if (temporary == NULL) {
+    return false;
+  }
+  snprintf(temporary, length, "%s.XXXXXX", path);
+
+  int fd = mkstemp(temporary);
+  if (fd == -1) {
+    free(temporary);
+    return false;
+  }
+
+  FILE* stream = fdopen(fd, "wb");
+  if (stream == NULL) {
+    close(fd);
+    unlink(temporary);
+    free(temporary);
+    return false;
+  }
+
+  profile_header_t header;
+  init_header(&header, profile);
+
+  bool result = (fwrite(&header, sizeof(header), 1, stream) == 1 &&
+      fwrite(offsets, sizeof(uint32_t), profile->number_of_sets + 1, stream) ==
+        profile->number_of_sets + 1 &&
+      fwrite(lines, sizeof(uint32_t), profile->number_of_lines, stream) ==
+        profile->number_of_lines);
+
+  if (fclose(stream) != 0) {
+    result = false;
+  }
+
+  if (result == true && rename(temporary, path) != 0) {
+    result = false;
+  }
+
+  if (result == false) {
+    unlink(temporary);
+  }
+
+  free(temporary);
+
+  return result;
+}
@@ -0,0 +1,31 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef LIBFLUSH_EVICTION_PROFILE_H
+#define LIBFLUSH_EVICTION_PROFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Geometry of the eviction pool a profile belongs to. A profile is only loaded
+ * if all fields match. */
+typedef struct libflush_eviction_profile_s {
+  uint32_t line_length_log2;
+  uint64_t number_of_sets;
+  uint64_t number_of_slices;
+  uint64_t number_of_lines;
+} libflush_eviction_profile_t;
+
+/* Reads the set index table of a pool from a profile. The offsets hold
+ * number_of_sets + 1 entries and the lines number_of_lines entries. Returns
+ * false if the file does not exist, has another version or geometry, or is
+ * inconsistent. */
+bool libflush_eviction_profile_load(const char* path, const libflush_eviction_profile_t* profile,
+    uint32_t** offsets, uint32_t** lines);
+
+/* Writes the set index table of a pool to a profile. The file is replaced
+ * atomically, so concurrent readers see either the old or the new profile. */
+bool libflush_eviction_profile_store(const char* path, const libflush_eviction_profile_t* profile,
+    const uint32_t* offsets, const uint32_t* lines);
+
+#endif // LIBFLUSH_EVICTION_PROFILE_H
@@ -0,0 +1,161 @@
+/* See LICENSE file for license and copyright information */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slice.h"
+
+/* Slice functions of Intel Core processors with 2, 4 and 8 slices (Maurice et
+ * al., Reverse Engineering Intel Last-Level Cache Complex Addressing Using
+ * Performance Counters, RAID 2015) */
+static const uint64_t intel_functions[] = {
+  0x1b5f575440ULL,
+  0x2eb5faa880ULL,
+  0x3cccc93100ULL
+};
+
+static bool
+is_power_of_two(size_t value)
+{
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+static bool
+append_table_entry(libflush_eviction_slice_hash_t* hash, unsigned long slice)
+{
+  if (slice > UINT8_MAX) {
+    return false;
+  }
+
+  // The table grows in powers of two starting at 64 entries
+  if (hash->table_length == 0 ||
+      (hash->table_length >= 64 && is_power_of_two(hash->table_length) == true)) {
+    size_t size = (hash->table_length == 0) ? 64 : hash->table_length * 2;
+    uint8_t* table = realloc(hash->table, size);
+    if (table == NULL) {
+      return false;
+    }
+    hash->table = table;
+  }
+
+  hash->table[hash->table_length++] = slice;
+  if (slice + 1 > hash->number_of_slices) {
+    hash->number_of_slices = slice + 1;
+  }
+
+  return true;
+}
+
+/* Reads a hash from a file. Lines starting with # are comments, every
+ * "xor <mask>" line adds a function and "table <slice> ..." lines append the
+ * slices of consecutive lines to the table, whose length is a power of two. */
+static bool
+load_slice_hash(libflush_eviction_slice_hash_t* hash, const char* file)
+{
+  FILE* stream = fopen(file, "r");
+  if (stream == NULL) {
+    return false;
+  }
+
+  bool valid = true;
+  char line[4096];
+  while (valid == true && fgets(line, sizeof(line), stream) != NULL) {
+    char* saveptr = NULL;
+    char* token = strtok_r(line, " \t\r\n", &saveptr);
+    if (token == NULL || token[0] == '#') {
+      continue;
+    }
+
+    if (strcmp(token, "xor") == 0) {
+      token = strtok_r(NULL, " \t\r\n", &saveptr);
+      if (token == NULL || hash->number_of_functions == SLICE_HASH_MAXIMUM_FUNCTIONS) {
+        valid = false;
+        break;
+      }
+
+      char* end;
+      hash->functions[hash->number_of_functions++] = strtoull(token, &end, 0);
+      valid = (*end == '\0');
+    } else if (strcmp(token, "table") == 0) {
+      while ((token = strtok_r(NULL, " \t\r\n", &saveptr)) != NULL) {
+        char* end;
+        unsigned long slice = strtoul(token, &end, 0);
+        if (*end != '\0' || append_table_entry(hash, slice) == false) {
+          valid = false;
+          break;
+        }
+      }
+    } else {
+      valid = false;
+    }
+  }
+
+  fclose(stream);
+
+  // Either functions or a table
+  if (hash->number_of_functions > 0 && hash->table_length > 0) {
+    return false;
+  }
+
+  if (hash->table_length > 0) {
+    return valid == true && is_power_of_two(hash->table_length) == true;
+  }
+
+  hash->number_of_slices = (size_t) 1 << hash->number_of_functions;
+
+  return valid == true && hash->number_of_functions > 0;
+}
+
+bool
+libflush_eviction_slice_hash_init(libflush_eviction_slice_hash_t* hash,
+    libflush_slice_hash_t type, size_t number_of_slices, const char* file,
+    unsigned int line_length_log2)
+{
+  memset(hash, 0, sizeof(libflush_eviction_slice_hash_t));
+  hash->number_of_slices = 1;
+  hash->line_length_log2 = line_length_log2;
+
+  switch (type) {
+    case LIBFLUSH_SLICE_HASH_NONE:
+      return true;
+    case LIBFLUSH_SLICE_HASH_INTEL:
+      if (is_power_of_two(number_of_slices) == false ||
+          number_of_slices > ((size_t) 1 << (sizeof(intel_functions) / sizeof(intel_functions[0])))) {
+        return false;
+      }
+
+      for (size_t slices = number_of_slices; slices > 1; slices /= 2) {
+        hash->functions[hash->number_of_functions] = intel_functions[hash->number_of_functions];
+        hash->number_of_functions++;
+      }
+      hash->number_of_slices = number_of_slices;
+
+      return true;
+    case LIBFLUSH_SLICE_HASH_FILE:
+      if (file == NULL || load_slice_hash(hash, file) == false) {
+        libflush_eviction_slice_hash_terminate(hash);
+        return false;
+      }
+
+      // The number of slices is optional, but has to match the hash
+      if (number_of_slices != 0 && number_of_slices != hash->number_of_slices) {
+        libflush_eviction_slice_hash_terminate(hash);
+        return false;
+      }
+
+      return true;
+    default:
+      return false;
+  }
+}
+
+void
+libflush_eviction_slice_hash_terminate(libflush_eviction_slice_hash_t* hash)
+{
+  free(hash->table);
+  hash->table = NULL;
+  hash->table_length = 0;
+  hash->number_of_functions = 0;
+  hash->number_of_slices = 1;
+}
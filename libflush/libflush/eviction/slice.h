@@ -0,0 +1,47 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef LIBFLUSH_EVICTION_SLICE_H
+#define LIBFLUSH_EVICTION_SLICE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../libflush.h"
+
+#define SLICE_HASH_MAXIMUM_FUNCTIONS 8
+
+/* Maps a physical address to the slice of the last-level cache. Every XOR
+ * function yields one bit of the slice as the parity of the masked address.
+ * A measured table holds the slice of consecutive lines and repeats. */
+typedef struct libflush_eviction_slice_hash_s {
+  size_t number_of_slices;
+  size_t number_of_functions;
+  uint64_t functions[SLICE_HASH_MAXIMUM_FUNCTIONS];
+  uint8_t* table;
+  size_t table_length;
+  unsigned int line_length_log2;
+} libflush_eviction_slice_hash_t;
+
+bool libflush_eviction_slice_hash_init(libflush_eviction_slice_hash_t* hash,
+    libflush_slice_hash_t type, size_t number_of_slices, const char* file,
+    unsigned int line_length_log2);
+void libflush_eviction_slice_hash_terminate(libflush_eviction_slice_hash_t* hash);
+
+static inline size_t
+libflush_eviction_slice_hash_get_slice(const libflush_eviction_slice_hash_t* hash,
+    uintptr_t physical_address)
+{
+  if (hash->table != NULL) {
+    return hash->table[(physical_address >> hash->line_length_log2) & (hash->table_length - 1)];
+  }
+
+  size_t slice = 0;
+  for (size_t i = 0; i < hash->number_of_functions; i++) {
+    slice |= (size_t) __builtin_parityll(physical_address & hash->functions[i]) << i;
+  }
+
+  return slice;
+}
+
+#endif // LIBFLUSH_EVICTION_SLICE_H
@@ -0,0 +1,222 @@
+/* See LICENSE file for license and copyright information */
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "libflush.h"
+#include "internal.h"
+#include "geometry.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#include "x86/cache.h"
+#endif
+
+#define SYSFS_CPU_PATH "/sys/devices/system/cpu"
+
+/* Reads the first line of an attribute of a cache directory */
+static bool
+read_attribute(const char* directory, const char* attribute, char* value, size_t length)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", directory, attribute);
+
+  FILE* file = fopen(path, "r");
+  if (file == NULL) {
+    return false;
+  }
+
+  bool read = (fgets(value, length, file) != NULL);
+  fclose(file);
+
+  if (read == true) {
+    value[strcspn(value, "\n")] = '\0';
+  }
+
+  return read;
+}
+
+/* Reads a number of an attribute, scaled by the suffix K or M of sizes */
+static bool
+read_number(const char* directory, const char* attribute, size_t* number)
+{
+  char value[64];
+  if (read_attribute(directory, attribute, value, sizeof(value)) == false) {
+    return false;
+  }
+
+  char* end;
+  unsigned long long parsed = strtoull(value, &end, 10);
+  if (end == value) {
+    return false;
+  }
+
+  if (*end == 'K') {
+    parsed *= 1024;
+  } else if (*end == 'M') {
+    parsed *= 1024 * 1024;
+  }
+
+  *number = parsed;
+
+  return true;
+}
+
+/* Counts the CPUs of a list such as 0-3,8-11 */
+static size_t
+count_cpus(const char* list)
+{
+  size_t count = 0;
+
+  while (*list != '\0') {
+    char* end;
+    unsigned long first = strtoul(list, &end, 10);
+    if (end == list) {
+      break;
+    }
+
+    unsigned long last = first;
+    if (*end == '-') {
+      list = end + 1;
+      last = strtoul(list, &end, 10);
+      if (end == list || last < first) {
+        break;
+      }
+    }
+
+    count += last - first + 1;
+    list = (*end == ',') ? end + 1 : end;
+  }
+
+  return count;
+}
+
+/* Reads a cache directory of sysfs. Kernels that do not report the number of
+ * sets or ways report the size, from which the missing one is derived. */
+static bool
+read_sysfs_cache(const char* directory, libflush_cache_geometry_t* cache)
+{
+  char type[32];
+  size_t level;
+  if (read_attribute(directory, "type", type, sizeof(type)) == false ||
+      read_number(directory, "level", &level) == false ||
+      read_number(directory, "coherency_line_size", &(cache->line_length)) == false ||
+      cache->line_length == 0) {
+    return false;
+  }
+
+  if (strcmp(type, "Data") == 0) {
+    cache->type = LIBFLUSH_CACHE_TYPE_DATA;
+  } else if (strcmp(type, "Instruction") == 0) {
+    cache->type = LIBFLUSH_CACHE_TYPE_INSTRUCTION;
+  } else if (strcmp(type, "Unified") == 0) {
+    cache->type = LIBFLUSH_CACHE_TYPE_UNIFIED;
+  } else {
+    return false;
+  }
+  cache->level = level;
+
+  cache->size = 0;
+  cache->number_of_sets = 0;
+  cache->associativity = 0;
+  read_number(directory, "size", &(cache->size));
+  read_number(directory, "number_of_sets", &(cache->number_of_sets));
+  read_number(directory, "ways_of_associativity", &(cache->associativity));
+
+  size_t way_size = cache->number_of_sets * cache->line_length;
+  if (cache->associativity == 0 && way_size != 0) {
+    cache->associativity = cache->size / way_size;
+  } else if (cache->number_of_sets == 0 && cache->associativity != 0) {
+    cache->number_of_sets = cache->size / (cache->associativity * cache->line_length);
+  }
+
+  if (cache->number_of_sets == 0 || cache->associativity == 0) {
+    return false;
+  }
+
+  if (cache->size == 0) {
+    cache->size = cache->number_of_sets * cache->associativity * cache->line_length;
+  }
+
+  char cpus[256];
+  cache->number_of_sharing_cpus = 1;
+  if (read_attribute(directory, "shared_cpu_list", cpus, sizeof(cpus)) == true &&
+      count_cpus(cpus) > 0) {
+    cache->number_of_sharing_cpus = count_cpus(cpus);
+  }
+
+  return true;
+}
+
+static size_t
+read_sysfs(int cpu, libflush_cache_geometry_t* caches, size_t number_of_caches)
+{
+  size_t count = 0;
+
+  for (size_t index = 0; count < number_of_caches; index++) {
+    char directory[128];
+    snprintf(directory, sizeof(directory), SYSFS_CPU_PATH "/cpu%d/cache/index%zu",
+        cpu, index);
+
+    char type[32];
+    if (read_attribute(directory, "type", type, sizeof(type)) == false) {
+      break;
+    }
+
+    if (read_sysfs_cache(directory, &(caches[count])) == true) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+static int
+compare_caches(const void* a, const void* b)
+{
+  const libflush_cache_geometry_t* first = a;
+  const libflush_cache_geometry_t* second = b;
+
+  if (first->level != second->level) {
+    return (first->level < second->level) ? -1 : 1;
+  }
+
+  return (int) first->type - (int) second->type;
+}
+
+size_t
+libflush_geometry_detect(libflush_cache_geometry_t* caches, size_t number_of_caches)
+{
+  // The caches of heterogeneous CPUs differ, so the ones of the current CPU
+  // are read
+  int cpu = sched_getcpu();
+  size_t count = read_sysfs((cpu < 0) ? 0 : cpu, caches, number_of_caches);
+
+#if defined(__i386__) || defined(__x86_64__)
+  if (count == 0) {
+    count = x86_cache_get_geometry(caches, number_of_caches);
+  }
+#endif
+
+  qsort(caches, count, sizeof(libflush_cache_geometry_t), compare_caches);
+
+  return count;
+}
+
+const libflush_cache_geometry_t*
+libflush_geometry_get_last_level(libflush_session_t* session)
+{
+  const libflush_cache_geometry_t* last = NULL;
+
+  for (size_t i = 0; i < session->geometry.number_of_caches; i++) {
+    const libflush_cache_geometry_t* cache = &(session->geometry.caches[i]);
+    if (cache->type != LIBFLUSH_CACHE_TYPE_INSTRUCTION) {
+      last = cache;
+    }
+  }
+
+  return last;
+}
@@ -0,0 +1,13 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stddef.h>
+
+#include "libflush.h"
+
+size_t libflush_geometry_detect(libflush_cache_geometry_t* caches, size_t number_of_caches);
+const libflush_cache_geometry_t* libflush_geometry_get_last_level(libflush_session_t* session);
+
+#endif // GEOMETRY_H
@@ -3,16 +3,26 @@
 #ifndef INTERNAL_H
 #define INTERNAL_H
 
+#include <pthread.h>
+#include <linux/perf_event.h>
+
 #include "libflush.h"
 
-#if TIME_SOURCE == TIME_SOURCE_THREAD_COUNTER
-#include <pthread.h>
+typedef uint64_t (*timing_function_t)(libflush_session_t* session);
 
-typedef struct thread_data_s {
-  libflush_session_t* session;
-  ssize_t cpu;
-} thread_data_t;
-#endif
+typedef struct measurement_s measurement_t;
+
+#define NUMBER_OF_OVERHEADS 2
+
+#define TRANSLATION_CACHE_SIZE 256
+
+#define MAXIMUM_NUMBER_OF_CACHES 8
+
+typedef struct translation_cache_entry_s {
+  uintptr_t virtual_page_number;
+  uint64_t page_frame_number;
+  bool used;
+} translation_cache_entry_t;
 
 struct libflush_session_s {
   void* data;
@@ -21,22 +31,47 @@ struct libflush_session_s {
 #if HAVE_PAGEMAP_ACCESS == 1
   struct {
     int pagemap;
+    translation_cache_entry_t translation_cache[TRANSLATION_CACHE_SIZE];
+#ifdef PTHREAD_ENABLE
+    pthread_mutex_t translation_cache_lock;
+#endif
   } memory;
 #endif
 
-#if TIME_SOURCE == TIME_SOURCE_THREAD_COUNTER
   struct {
-    pthread_t thread;
-    volatile uint64_t value;
-    thread_data_t data;
-  } thread_counter;
-#endif
+    libflush_time_source_t source;
+    timing_function_t get_timing;
+    timing_function_t get_timing_start;
+    timing_function_t get_timing_end;
+    libflush_fence_t fence;
+    const measurement_t* measurement;
+    void (*reset_timing)(libflush_session_t* session);
+    bool (*terminate)(libflush_session_t* session);
+    double ns_per_tick;
+  } timing;
+
+  struct {
+    libflush_flush_instruction_t instruction;
+    libflush_flush_instruction_t range_instruction;
+    size_t line_length;
+  } flush;
+
+  struct {
+    bool subtract;
+    uint64_t measured[NUMBER_OF_OVERHEADS];
+    uint64_t subtracted[NUMBER_OF_OVERHEADS];
+  } overhead;
 
-#if TIME_SOURCE == TIME_SOURCE_PERF
   struct {
     int fd;
+    struct perf_event_mmap_page* page;
+    size_t page_size;
   } perf;
-#endif
+
+  struct {
+    libflush_cache_geometry_t caches[MAXIMUM_NUMBER_OF_CACHES];
+    size_t number_of_caches;
+  } geometry;
 };
 
 #endif  /*INTERNAL_H*/
@@ -14,8 +14,10 @@
 #include <fcntl.h>
 
 #include "libflush.h"
+#include "libflush_inline.h"
 #include "timing.h"
 #include "internal.h"
+#include "geometry.h"
 #include "eviction/eviction.h"
 
 #include <pthread.h>
@@ -28,11 +30,51 @@
 #include "x86/libflush.h"
 #endif
 
-static uint64_t libflush_get_timing_start(libflush_session_t* session);
-static uint64_t libflush_get_timing_end(libflush_session_t* session);
+#define OVERHEAD_NUMBER_OF_SAMPLES 1000
+
+/* Timed primitives of a timer, see get_measurement */
+typedef uint64_t (*measure_address_t)(libflush_session_t* session, void* address);
+typedef void (*measure_addresses_t)(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+typedef void (*measure_overhead_t)(libflush_session_t* session, uint64_t* samples,
+    size_t number_of_samples);
+
+struct measurement_s {
+  measure_address_t reload_address;
+  measure_addresses_t reload_batch;
+  measure_address_t reload_address_and_flush;
+  measure_addresses_t reload_and_flush_batch;
+  measure_address_t reload_address_and_evict;
+  measure_addresses_t reload_and_evict_batch;
+  measure_address_t flush_time;
+  measure_addresses_t flush_time_batch;
+  measure_address_t evict_time;
+  measure_address_t prefetch_time;
+  measure_addresses_t prefetch_time_batch;
+  uint64_t (*probe)(libflush_session_t* session, size_t set_index);
+  bool (*probe_level)(libflush_session_t* session, size_t set_index, unsigned int level,
+      uint64_t* time);
+  void (*probe_sweep)(libflush_session_t* session, const size_t* set_indices,
+      size_t number_of_sets, uint64_t* times);
+  measure_overhead_t overhead;
+  measure_overhead_t overhead_serialized;
+};
+
+static inline uint64_t correct_timing(libflush_session_t* session,
+    libflush_overhead_t overhead, uint64_t delta);
+
+static inline uint64_t get_timing(libflush_session_t* session);
+static inline void flush_address(libflush_session_t* session, void* address);
+static bool flush_init(libflush_session_t* session, libflush_session_args_t* args);
+static size_t get_sweep_stride(size_t number_of_sets);
+static const measurement_t* get_measurement(libflush_session_t* session);
 
 #if HAVE_PAGEMAP_ACCESS == 1
 static size_t get_frame_number_from_pagemap(size_t value);
+static bool translation_cache_lookup(libflush_session_t* session,
+    uintptr_t virtual_page_number, uint64_t* page_frame_number);
+static void translation_cache_insert(libflush_session_t* session,
+    uintptr_t virtual_page_number, uint64_t page_frame_number);
 #endif
 
 bool
@@ -59,17 +101,55 @@ libflush_init(libflush_session_t** session, libflush_session_args_t* args)
     free(*session);
     return false;
   }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_init(&((*session)->memory.translation_cache_lock), NULL);
+#endif
+#endif
+
+  /* Select flush instruction */
+  if (flush_init(*session, args) == false) {
+#if HAVE_PAGEMAP_ACCESS == 1
+    close((*session)->memory.pagemap);
 #endif
+    free(*session);
+    *session = NULL;
+    return false;
+  }
 
   /* Initialize timer */
-#if TIME_SOURCE == TIME_SOURCE_PERF
-  perf_init(*session, args);
-#elif TIME_SOURCE == TIME_SOURCE_THREAD_COUNTER
-  thread_counter_init(*session, args);
+  if (libflush_timing_init(*session, args) == false) {
+#if HAVE_PAGEMAP_ACCESS == 1
+    close((*session)->memory.pagemap);
 #endif
+    free(*session);
+    *session = NULL;
+    return false;
+  }
+
+  /* Select the measurements of the time source */
+  (*session)->timing.measurement = get_measurement(*session);
+
+  /* Calibrate measurement overhead */
+  libflush_calibrate_overhead(*session);
+  if (args != NULL) {
+    libflush_set_overhead_subtraction(*session, args->subtract_overhead);
+  }
+
+  /* Detect cache geometry */
+  (*session)->geometry.number_of_caches = libflush_geometry_detect((*session)->geometry.caches,
+      MAXIMUM_NUMBER_OF_CACHES);
 
   /* Initialize eviction */
-  libflush_eviction_init(*session, args);
+  if (libflush_eviction_init(*session, args) == false) {
+    libflush_timing_terminate(*session);
+#if HAVE_PAGEMAP_ACCESS == 1
+    close((*session)->memory.pagemap);
+#endif
+    free(*session);
+    *session = NULL;
+    return false;
+  }
 
   /* Initialize architecture */
 #if defined(__ARM_ARCH_7A__)
@@ -90,20 +170,8 @@ libflush_terminate(libflush_session_t* session)
     return false;
   }
 
-  /* Pagemap access */
-#if HAVE_PAGEMAP_ACCESS == 1
-  if (session->memory.pagemap >= 0) {
-    close(session->memory.pagemap);
-  }
-  session->memory.pagemap = -1;
-#endif
-
   /* Terminate timer */
-#if TIME_SOURCE == TIME_SOURCE_PERF
-  perf_terminate(session);
-#elif TIME_SOURCE == TIME_SOURCE_THREAD_COUNTER
-  thread_counter_terminate(session);
-#endif
+  libflush_timing_terminate(session);
 
   /* Terminate eviction */
   libflush_eviction_terminate(session);
@@ -115,6 +183,18 @@ libflush_terminate(libflush_session_t* session)
   arm_v8_terminate(session);
 #endif
 
+  /* Pagemap access */
+#if HAVE_PAGEMAP_ACCESS == 1
+  if (session->memory.pagemap >= 0) {
+    close(session->memory.pagemap);
+  }
+  session->memory.pagemap = -1;
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_destroy(&(session->memory.translation_cache_lock));
+#endif
+#endif
+
   /* Clean-up */
   free(session);
 
@@ -124,37 +204,59 @@ libflush_terminate(libflush_session_t* session)
 void
 libflush_flush(libflush_session_t* session, void* address)
 {
-  (void) session;
+  flush_address(session, address);
+}
+
+void
+libflush_flush_range(libflush_session_t* session, void* address, size_t length)
+{
+  size_t line_length = session->flush.line_length;
+  uintptr_t end = (uintptr_t) address + length;
+  uintptr_t line = (uintptr_t) address & ~(line_length - 1);
 
 #if USE_EVICTION == 1
-  libflush_eviction_evict(session, address);
-#elif defined(__ARM_ARCH_8A__)
-  arm_v8_flush(address);
+  for (; line < end; line += line_length) {
+    libflush_eviction_evict(session, (void*) line);
+  }
 #elif defined(__i386__) || defined(__x86_64__)
-  x86_flush(address);
+  switch (session->flush.range_instruction) {
+    case LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSHOPT:
+      for (; line < end; line += line_length) {
+        x86_flushopt((void*) line);
+      }
+      break;
+    case LIBFLUSH_FLUSH_INSTRUCTION_CLWB:
+      for (; line < end; line += line_length) {
+        x86_clwb((void*) line);
+      }
+      break;
+    default:
+      for (; line < end; line += line_length) {
+        x86_flush((void*) line);
+      }
+      break;
+  }
 #else
-#error No flush/eviction method available on this platform
+  for (; line < end; line += line_length) {
+    flush_address(session, (void*) line);
+  }
 #endif
+
+  libflush_inline_memory_barrier();
 }
 
 uint64_t
 libflush_flush_time(libflush_session_t* session, void* address)
 {
-  (void) session;
-
-  uint64_t start = libflush_get_timing(session);
-
-#if USE_EVICTION == 1
-  libflush_eviction_evict(session, address);
-#elif defined(__ARM_ARCH_8A__)
-  arm_v8_flush(address);
-#elif defined(__i386__) || defined(__x86_64__)
-  x86_flush(address);
-#else
-#error No flush/eviction method available on this platform
-#endif
+  return session->timing.measurement->flush_time(session, address);
+}
 
-  return libflush_get_timing(session) - start;
+void
+libflush_flush_time_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings)
+{
+  session->timing.measurement->flush_time_batch(session, addresses, number_of_addresses,
+      timings);
 }
 
 void
@@ -166,9 +268,7 @@ libflush_evict(libflush_session_t* session, void* address)
 uint64_t
 libflush_evict_time(libflush_session_t* session, void* address)
 {
-  uint64_t start = libflush_get_timing(session);
-  libflush_eviction_evict(session, address);
-  return libflush_get_timing(session) - start;
+  return session->timing.measurement->evict_time(session, address);
 }
 
 void
@@ -176,173 +276,176 @@ libflush_prefetch(libflush_session_t* session, void* address)
 {
   (void) session;
 
-#if defined(__ARM_ARCH_7A__)
-  arm_v7_prefetch(address);
-  libflush_memory_barrier();
-#elif defined(__ARM_ARCH_8A__)
-  arm_v8_prefetch(address);
-  libflush_memory_barrier();
-#elif defined(__i386__) || defined(__x86_64__)
-  x86_prefetch(address);
-#else
-#error No prefetch method available on this platform
-#endif
+  libflush_inline_prefetch(address);
 }
 
 uint64_t
 libflush_prefetch_time(libflush_session_t* session, void* address)
 {
-  (void) session;
-
-  uint64_t start = libflush_get_timing_start(session);
-
-#if defined(__ARM_ARCH_7A__)
-  arm_v7_prefetch(address);
-  libflush_memory_barrier();
-#elif defined(__ARM_ARCH_8A__)
-  arm_v8_prefetch(address);
-  libflush_memory_barrier();
-#elif defined(__i386__) || defined(__x86_64__)
-  x86_prefetch(address);
-#else
-#error No prefetch method available on this platform
-#endif
+  return session->timing.measurement->prefetch_time(session, address);
+}
 
-  return libflush_get_timing_end(session) - start;
+void
+libflush_prefetch_time_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings)
+{
+  session->timing.measurement->prefetch_time_batch(session, addresses, number_of_addresses,
+      timings);
 }
 
 uint64_t
 libflush_get_timing(libflush_session_t* session)
 {
-  (void) session;
-
-  uint64_t result = 0;
+  return get_timing(session);
+}
 
-  libflush_memory_barrier();
+static inline uint64_t
+get_timing(libflush_session_t* session)
+{
+  return session->timing.get_timing(session);
+}
 
-#if TIME_SOURCE == TIME_SOURCE_MONOTONIC_CLOCK
-  result = get_monotonic_time();
-#elif TIME_SOURCE == TIME_SOURCE_PERF
-  result = perf_get_timing(session);
-#elif TIME_SOURCE == TIME_SOURCE_THREAD_COUNTER
-  result = thread_counter_get_timing(session);
-#elif TIME_SOURCE == TIME_SOURCE_REGISTER
-#if defined(__ARM_ARCH_7A__)
-  result = arm_v7_get_timing();
-#elif defined(__ARM_ARCH_8A__)
-  result = arm_v8_get_timing();
-#elif defined(__i386__) || defined(__x86_64__)
-  result = x86_get_timing();
-#endif
-#endif
+libflush_time_source_t
+libflush_get_time_source(libflush_session_t* session)
+{
+  return session->timing.source;
+}
 
-  libflush_memory_barrier();
+static int
+compare_timings(const void* a, const void* b)
+{
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
 
-  return result;
+  return (x > y) - (x < y);
 }
 
-static uint64_t
-libflush_get_timing_start(libflush_session_t* session)
+bool
+libflush_calibrate_overhead(libflush_session_t* session)
 {
-  (void) session;
+  if (session == NULL) {
+    return false;
+  }
 
-  uint64_t result = 0;
+  uint64_t* samples = calloc(OVERHEAD_NUMBER_OF_SAMPLES, sizeof(uint64_t));
+  if (samples == NULL) {
+    return false;
+  }
 
-#if defined(__i386__) || defined(__x86_64__)
-  result = x86_get_timing_start();
-#else
-  result = libflush_get_timing(session);
-#endif
+  /* Empty windows of exactly the same shape as the measurement functions */
+  session->timing.measurement->overhead(session, samples, OVERHEAD_NUMBER_OF_SAMPLES);
+  qsort(samples, OVERHEAD_NUMBER_OF_SAMPLES, sizeof(uint64_t), compare_timings);
+  session->overhead.measured[LIBFLUSH_OVERHEAD_TIMING] =
+    samples[OVERHEAD_NUMBER_OF_SAMPLES / 2];
+
+  session->timing.measurement->overhead_serialized(session, samples,
+      OVERHEAD_NUMBER_OF_SAMPLES);
+  qsort(samples, OVERHEAD_NUMBER_OF_SAMPLES, sizeof(uint64_t), compare_timings);
+  session->overhead.measured[LIBFLUSH_OVERHEAD_TIMING_SERIALIZED] =
+    samples[OVERHEAD_NUMBER_OF_SAMPLES / 2];
+
+  free(samples);
 
-  return result;
+  libflush_set_overhead_subtraction(session, session->overhead.subtract);
+
+  return true;
 }
 
-static uint64_t
-libflush_get_timing_end(libflush_session_t* session)
+uint64_t
+libflush_get_overhead(libflush_session_t* session, libflush_overhead_t overhead)
 {
-  (void) session;
+  if (overhead >= NUMBER_OF_OVERHEADS) {
+    return 0;
+  }
 
-  uint64_t result = 0;
+  return session->overhead.measured[overhead];
+}
 
-#if defined(__i386__) || defined(__x86_64__)
-  result = x86_get_timing_end();
-#else
-  result = libflush_get_timing(session);
-#endif
+void
+libflush_set_overhead_subtraction(libflush_session_t* session, bool enable)
+{
+  session->overhead.subtract = enable;
+
+  for (size_t i = 0; i < NUMBER_OF_OVERHEADS; i++) {
+    session->overhead.subtracted[i] = (enable == true) ? session->overhead.measured[i] : 0;
+  }
+}
+
+static inline uint64_t
+correct_timing(libflush_session_t* session, libflush_overhead_t overhead, uint64_t delta)
+{
+  uint64_t subtracted = session->overhead.subtracted[overhead];
 
-  return result;
+  return (delta > subtracted) ? delta - subtracted : 0;
+}
+
+uint64_t
+libflush_timing_to_ns(libflush_session_t* session, uint64_t timing)
+{
+  return timing * libflush_timing_get_ns_per_tick(session);
 }
 
 void
 libflush_reset_timing(libflush_session_t* session)
 {
-  (void) session;
-
-#if TIME_SOURCE == TIME_SOURCE_PERF
-  perf_reset_timing(session);
-#elif TIME_SOURCE == TIME_SOURCE_REGISTER
-#if defined(__ARM_ARCH_7A__)
-  arm_v7_reset_timing(session->performance_register_div64);
-#elif defined(__ARM_ARCH_8A__)
-  arm_v8_reset_timing();
-#endif
-#endif
+  if (session->timing.reset_timing != NULL) {
+    session->timing.reset_timing(session);
+  }
 
-  libflush_memory_barrier();
+  libflush_inline_memory_barrier();
 }
 
 inline void
 libflush_access_memory(void *address) {
-#if defined(__ARM_ARCH_7A__)
-  arm_v7_access_memory(address);
-#elif defined(__ARM_ARCH_8A__)
-  arm_v8_access_memory(address);
-#elif defined(__i386__) || defined(__x86_64__)
-  x86_access_memory(address);
-#endif
+  libflush_inline_access_memory(address);
 }
 
 uint64_t
 libflush_reload_address(libflush_session_t* session, void* address)
 {
-  uint64_t time = libflush_get_timing(session);
-  libflush_access_memory(address);
+  return session->timing.measurement->reload_address(session, address);
+}
 
-  return libflush_get_timing(session) - time;
+void
+libflush_reload_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings)
+{
+  session->timing.measurement->reload_batch(session, addresses, number_of_addresses,
+      timings);
 }
 
 uint64_t
 libflush_reload_address_and_flush(libflush_session_t* session, void* address)
 {
-  uint64_t time = libflush_get_timing_start(session);
-  libflush_access_memory(address);
-  uint64_t delta =  libflush_get_timing_end(session) - time;
-  libflush_flush(session, address);
+  return session->timing.measurement->reload_address_and_flush(session, address);
+}
 
-  return delta;
+void
+libflush_reload_and_flush_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings)
+{
+  session->timing.measurement->reload_and_flush_batch(session, addresses,
+      number_of_addresses, timings);
 }
 
 uint64_t
 libflush_reload_address_and_evict(libflush_session_t* session, void* address)
 {
-  uint64_t time = libflush_get_timing_start(session);
-  libflush_access_memory(address);
-  uint64_t delta =  libflush_get_timing_end(session) - time;
-  libflush_evict(session, address);
+  return session->timing.measurement->reload_address_and_evict(session, address);
+}
 
-  return delta;
+void
+libflush_reload_and_evict_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings)
+{
+  session->timing.measurement->reload_and_evict_batch(session, addresses,
+      number_of_addresses, timings);
 }
 
 inline void
 libflush_memory_barrier()
 {
-#if defined(__ARM_ARCH_7A__)
-  arm_v7_memory_barrier();
-#elif defined(__ARM_ARCH_8A__)
-  arm_v8_memory_barrier();
-#elif defined(__i386__) || defined(__x86_64__)
-  x86_memory_barrier();
-#endif
+  libflush_inline_memory_barrier();
 }
 
 void
@@ -363,64 +466,973 @@ libflush_get_number_of_sets(libflush_session_t* session)
   return libflush_eviction_get_number_of_sets(session);
 }
 
-uint64_t
-libflush_probe(libflush_session_t* session, size_t set_index)
+size_t
+libflush_get_number_of_slices(libflush_session_t* session)
 {
-  uint64_t time = libflush_get_timing_start(session);
-  libflush_eviction_probe(session, set_index);
-  uint64_t delta =  libflush_get_timing_end(session) - time;
+  return libflush_eviction_get_number_of_slices(session);
+}
 
-  return delta;
+size_t
+libflush_get_cache_geometry(libflush_session_t* session,
+    libflush_cache_geometry_t* caches, size_t number_of_caches)
+{
+  if (session == NULL) {
+    return 0;
+  }
+
+  size_t count = session->geometry.number_of_caches;
+  for (size_t i = 0; caches != NULL && i < count && i < number_of_caches; i++) {
+    caches[i] = session->geometry.caches[i];
+  }
+
+  return count;
 }
 
-uintptr_t
-libflush_get_physical_address(libflush_session_t* session, uintptr_t virtual_address)
+libflush_eviction_pages_t
+libflush_get_eviction_pages(libflush_session_t* session)
 {
-  (void) session;
-  (void) virtual_address;
+  return libflush_eviction_get_pages(session);
+}
 
-#if HAVE_PAGEMAP_ACCESS == 1
-  // Access memory
-  libflush_access_memory((void *) virtual_address);
+int
+libflush_get_eviction_node(libflush_session_t* session)
+{
+  if (session == NULL) {
+    return -1;
+  }
 
-  uint64_t value;
-  off_t offset = (virtual_address / 4096) * sizeof(value);
-  int got = pread(session->memory.pagemap, &value, sizeof(value), offset);
-  assert(got == 8);
+  return libflush_eviction_get_node(session);
+}
 
-  // Check the "page present" flag.
-  assert(value & (1ULL << 63));
+libflush_eviction_profile_state_t
+libflush_get_eviction_profile_state(libflush_session_t* session)
+{
+  return libflush_eviction_get_profile_state(session);
+}
 
-  uint64_t frame_num = get_frame_number_from_pagemap(value);
-  return (frame_num * 4096) | (virtual_address & (4095));
-#else
-  return 0;
-#endif
+bool
+libflush_set_eviction_strategy(libflush_session_t* session,
+    const libflush_eviction_strategy_t* strategy)
+{
+  return libflush_eviction_set_strategy(session, strategy);
 }
 
-uint64_t
-libflush_get_pagemap_entry(libflush_session_t* session, uint64_t virtual_address)
+void
+libflush_get_eviction_strategy(libflush_session_t* session,
+    libflush_eviction_strategy_t* strategy)
 {
-  (void) session;
-  (void) virtual_address;
+  libflush_eviction_get_strategy(session, strategy);
+}
 
-#if HAVE_PAGEMAP_ACCESS == 1
-  // Access memory
-  uint64_t value;
-  off_t offset = (virtual_address / 4096) * sizeof(value);
-  int got = pread(session->memory.pagemap, &value, sizeof(value), offset);
-  assert(got == 8);
+bool
+libflush_evict_strategy(libflush_session_t* session, void* address,
+    const libflush_eviction_strategy_t* strategy)
+{
+  return libflush_eviction_evict_strategy(session, address, strategy);
+}
 
-  return value;
-#else
-  return 0;
-#endif
+bool
+libflush_discover_eviction_set(libflush_session_t* session, void* address,
+    const libflush_discovery_args_t* args, libflush_discovery_result_t* result)
+{
+  if (session == NULL || address == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_discover(session, address, args, result);
 }
 
-#if HAVE_PAGEMAP_ACCESS == 1
-static size_t
-get_frame_number_from_pagemap(size_t value)
+bool
+libflush_prepare_eviction_sets(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses)
 {
-  return value & ((1ULL << 55) - 1);
+  if (session == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_prepare(session, addresses, number_of_addresses);
+}
+
+void
+libflush_wait_eviction_sets(libflush_session_t* session)
+{
+  if (session == NULL) {
+    return;
+  }
+
+  libflush_eviction_wait(session);
+}
+
+bool
+libflush_eviction_sets_ready(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses)
+{
+  if (session == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_is_ready(session, addresses, number_of_addresses);
+}
+
+uint64_t
+libflush_probe(libflush_session_t* session, size_t set_index)
+{
+  return session->timing.measurement->probe(session, set_index);
+}
+
+bool
+libflush_evict_level(libflush_session_t* session, void* address, unsigned int level)
+{
+  if (session == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_evict_level(session, address, level);
+}
+
+bool
+libflush_prime_level(libflush_session_t* session, size_t set_index, unsigned int level)
+{
+  if (session == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_prime_level(session, set_index, level);
+}
+
+bool
+libflush_probe_level(libflush_session_t* session, size_t set_index, unsigned int level,
+    uint64_t* time)
+{
+  if (session == NULL || time == NULL) {
+    return false;
+  }
+
+  return session->timing.measurement->probe_level(session, set_index, level, time);
+}
+
+bool
+libflush_get_level_set_index(libflush_session_t* session, void* address,
+    unsigned int level, size_t* set_index)
+{
+  if (session == NULL || set_index == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_get_level_set_index(session, address, level, set_index);
+}
+
+size_t
+libflush_get_level_number_of_sets(libflush_session_t* session, unsigned int level)
+{
+  if (session == NULL) {
+    return 0;
+  }
+
+  return libflush_eviction_get_level_number_of_sets(session, level);
+}
+
+bool
+libflush_set_level_eviction_strategy(libflush_session_t* session, unsigned int level,
+    const libflush_eviction_strategy_t* strategy)
+{
+  if (session == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_set_level_strategy(session, level, strategy);
+}
+
+bool
+libflush_get_level_eviction_strategy(libflush_session_t* session, unsigned int level,
+    libflush_eviction_strategy_t* strategy)
+{
+  if (session == NULL || strategy == NULL) {
+    return false;
+  }
+
+  return libflush_eviction_get_level_strategy(session, level, strategy);
+}
+
+/* Stride of the sweep order. It is coprime to the number of sets, so every set
+ * is visited once, and large, so that consecutive sets are far apart. */
+static size_t
+get_sweep_stride(size_t number_of_sets)
+{
+  size_t stride = ((size_t) (number_of_sets * 0.618)) | 1;
+
+  while (stride < number_of_sets) {
+    size_t a = number_of_sets, b = stride;
+    while (b != 0) {
+      size_t t = a % b;
+      a = b;
+      b = t;
+    }
+
+    if (a == 1) {
+      return stride;
+    }
+
+    stride += 2;
+  }
+
+  return 1;
+}
+
+static bool
+prime_sets(libflush_session_t* session, const size_t* set_indices, size_t number_of_sets)
+{
+  if (libflush_eviction_sweep_begin(session, set_indices, number_of_sets) == false) {
+    return false;
+  }
+
+  size_t stride = get_sweep_stride(number_of_sets);
+  size_t position = 0;
+  for (size_t i = 0; i < number_of_sets; i++) {
+    libflush_eviction_sweep_prime(session,
+        (set_indices != NULL) ? set_indices[position] : position);
+    position = (position + stride) % number_of_sets;
+  }
+
+  libflush_eviction_sweep_end(session);
+
+  return true;
+}
+
+static bool
+probe_sets(libflush_session_t* session, const size_t* set_indices, size_t number_of_sets,
+    uint64_t* times)
+{
+  if (libflush_eviction_sweep_begin(session, set_indices, number_of_sets) == false) {
+    return false;
+  }
+
+  session->timing.measurement->probe_sweep(session, set_indices, number_of_sets, times);
+
+  libflush_eviction_sweep_end(session);
+
+  return true;
+}
+
+bool
+libflush_prime_all(libflush_session_t* session, size_t number_of_sets)
+{
+  return prime_sets(session, NULL, number_of_sets);
+}
+
+bool
+libflush_probe_all(libflush_session_t* session, uint64_t* times, size_t number_of_sets)
+{
+  return probe_sets(session, NULL, number_of_sets, times);
+}
+
+bool
+libflush_prime_sets(libflush_session_t* session, const size_t* set_indices,
+    size_t number_of_sets)
+{
+  if (set_indices == NULL) {
+    return false;
+  }
+
+  return prime_sets(session, set_indices, number_of_sets);
+}
+
+bool
+libflush_probe_sets(libflush_session_t* session, const size_t* set_indices,
+    size_t number_of_sets, uint64_t* times)
+{
+  if (set_indices == NULL) {
+    return false;
+  }
+
+  return probe_sets(session, set_indices, number_of_sets, times);
+}
+
+uintptr_t
+libflush_get_physical_address(libflush_session_t* session, uintptr_t virtual_address)
+{
+  (void) session;
+  (void) virtual_address;
+
+#if HAVE_PAGEMAP_ACCESS == 1
+  uintptr_t virtual_page_number = virtual_address / 4096;
+  uint64_t frame_num;
+
+  if (translation_cache_lookup(session, virtual_page_number, &frame_num) == false) {
+    // Access memory
+    libflush_inline_access_memory((void *) virtual_address);
+
+    uint64_t value;
+    off_t offset = virtual_page_number * sizeof(value);
+    int got = pread(session->memory.pagemap, &value, sizeof(value), offset);
+    assert(got == 8);
+
+    // Check the "page present" flag.
+    assert(value & (1ULL << 63));
+
+    frame_num = get_frame_number_from_pagemap(value);
+    translation_cache_insert(session, virtual_page_number, frame_num);
+  }
+
+  return (frame_num * 4096) | (virtual_address & (4095));
+#else
+  return 0;
+#endif
+}
+
+uint64_t
+libflush_get_pagemap_entry(libflush_session_t* session, uint64_t virtual_address)
+{
+  (void) session;
+  (void) virtual_address;
+
+#if HAVE_PAGEMAP_ACCESS == 1
+  // Access memory
+  uint64_t value;
+  off_t offset = (virtual_address / 4096) * sizeof(value);
+  int got = pread(session->memory.pagemap, &value, sizeof(value), offset);
+  assert(got == 8);
+
+  return value;
+#else
+  return 0;
+#endif
+}
+
+bool
+libflush_translate_range(libflush_session_t* session, uintptr_t virtual_address,
+    size_t number_of_pages, uint64_t* page_frame_numbers)
+{
+  (void) session;
+  (void) virtual_address;
+  (void) number_of_pages;
+  (void) page_frame_numbers;
+
+#if HAVE_PAGEMAP_ACCESS == 1
+  if (session == NULL || (number_of_pages > 0 && page_frame_numbers == NULL)) {
+    return false;
+  }
+
+  uintptr_t virtual_page_number = virtual_address / 4096;
+
+  /* Read all entries at once, the buffer is converted in place */
+  uint8_t* buffer = (uint8_t*) page_frame_numbers;
+  size_t size = number_of_pages * sizeof(uint64_t);
+  off_t offset = virtual_page_number * sizeof(uint64_t);
+
+  while (size > 0) {
+    ssize_t got = pread(session->memory.pagemap, buffer, size, offset);
+    if (got <= 0) {
+      return false;
+    }
+
+    buffer += got;
+    offset += got;
+    size -= got;
+  }
+
+  for (size_t i = 0; i < number_of_pages; i++) {
+    uint64_t value = page_frame_numbers[i];
+
+    if (value & (1ULL << 63)) {
+      page_frame_numbers[i] = get_frame_number_from_pagemap(value);
+      translation_cache_insert(session, virtual_page_number + i, page_frame_numbers[i]);
+    } else {
+      page_frame_numbers[i] = 0;
+    }
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+libflush_invalidate_translations(libflush_session_t* session, void* virtual_address,
+    size_t length)
+{
+  (void) session;
+  (void) virtual_address;
+  (void) length;
+
+#if HAVE_PAGEMAP_ACCESS == 1
+  uintptr_t first = (uintptr_t) virtual_address / 4096;
+  uintptr_t last = ((uintptr_t) virtual_address + length + 4095) / 4096;
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(session->memory.translation_cache_lock));
+#endif
+
+  for (size_t i = 0; i < TRANSLATION_CACHE_SIZE; i++) {
+    translation_cache_entry_t* entry = &(session->memory.translation_cache[i]);
+
+    if (virtual_address == NULL || (entry->virtual_page_number >= first &&
+          entry->virtual_page_number < last)) {
+      entry->used = false;
+    }
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(session->memory.translation_cache_lock));
+#endif
+#endif
+}
+
+#if HAVE_PAGEMAP_ACCESS == 1
+static size_t
+get_frame_number_from_pagemap(size_t value)
+{
+  return value & ((1ULL << 55) - 1);
+}
+
+static bool
+translation_cache_lookup(libflush_session_t* session, uintptr_t virtual_page_number,
+    uint64_t* page_frame_number)
+{
+  translation_cache_entry_t* entry =
+    &(session->memory.translation_cache[virtual_page_number % TRANSLATION_CACHE_SIZE]);
+  bool found = false;
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(session->memory.translation_cache_lock));
+#endif
+
+  if (entry->used == true && entry->virtual_page_number == virtual_page_number) {
+    *page_frame_number = entry->page_frame_number;
+    found = true;
+  }
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(session->memory.translation_cache_lock));
+#endif
+
+  return found;
+}
+
+static void
+translation_cache_insert(libflush_session_t* session, uintptr_t virtual_page_number,
+    uint64_t page_frame_number)
+{
+  translation_cache_entry_t* entry =
+    &(session->memory.translation_cache[virtual_page_number % TRANSLATION_CACHE_SIZE]);
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_lock(&(session->memory.translation_cache_lock));
+#endif
+
+  entry->virtual_page_number = virtual_page_number;
+  entry->page_frame_number = page_frame_number;
+  entry->used = true;
+
+#ifdef PTHREAD_ENABLE
+  pthread_mutex_unlock(&(session->memory.translation_cache_lock));
+#endif
+}
+#endif
+
+static bool
+flush_init(libflush_session_t* session, libflush_session_args_t* args)
+{
+  libflush_flush_instruction_t instruction = (args != NULL) ?
+    args->flush_instruction : LIBFLUSH_FLUSH_INSTRUCTION_DEFAULT;
+
+  session->flush.instruction = LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSH;
+  session->flush.range_instruction = LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSH;
+  session->flush.line_length = 64;
+
+#if defined(__i386__) || defined(__x86_64__)
+  bool clflushopt, clwb;
+  x86_flush_get_features(&clflushopt, &clwb, &(session->flush.line_length));
+
+  switch (instruction) {
+    case LIBFLUSH_FLUSH_INSTRUCTION_DEFAULT:
+      /* Single flushes stay with CLFLUSH, as attacks like Flush+Flush depend on
+       * its timing */
+      if (clflushopt == true) {
+        session->flush.range_instruction = LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSHOPT;
+      }
+      return true;
+    case LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSH:
+      return true;
+    case LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSHOPT:
+      if (clflushopt == false) {
+        return false;
+      }
+      break;
+    case LIBFLUSH_FLUSH_INSTRUCTION_CLWB:
+      if (clwb == false) {
+        return false;
+      }
+      break;
+    default:
+      return false;
+  }
+
+  session->flush.instruction = instruction;
+  session->flush.range_instruction = instruction;
+
+  return true;
+#else
+  return instruction == LIBFLUSH_FLUSH_INSTRUCTION_DEFAULT;
+#endif
+}
+
+static inline void
+flush_address(libflush_session_t* session, void* address)
+{
+  (void) session;
+
+#if USE_EVICTION == 1
+  libflush_eviction_evict(session, address);
+#elif defined(__i386__) || defined(__x86_64__)
+  switch (session->flush.instruction) {
+    case LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSHOPT:
+      x86_flushopt(address);
+      break;
+    case LIBFLUSH_FLUSH_INSTRUCTION_CLWB:
+      x86_clwb(address);
+      break;
+    default:
+      libflush_inline_flush(address);
+      break;
+  }
+#elif defined(LIBFLUSH_INLINE_HAVE_FLUSH)
+  libflush_inline_flush(address);
+#else
+#error No flush/eviction method available on this platform
+#endif
+}
+
+/* Measurements
+ *
+ * Every timed primitive is instantiated for every timer, so that the time
+ * stamps of the register time source are read inline and no call ends up in
+ * the measured window. The session selects the instances of its time source
+ * and fence once on initialization. The other time sources are read through
+ * the session, as reading them is a call anyway. */
+
+static inline __attribute__((always_inline)) uint64_t
+session_timestamp(libflush_session_t* session)
+{
+  return session->timing.get_timing(session);
+}
+
+static inline __attribute__((always_inline)) uint64_t
+session_timestamp_start(libflush_session_t* session)
+{
+  return session->timing.get_timing_start(session);
+}
+
+static inline __attribute__((always_inline)) uint64_t
+session_timestamp_end(libflush_session_t* session)
+{
+  return session->timing.get_timing_end(session);
+}
+
+static inline __attribute__((always_inline)) uint64_t
+register_timestamp(libflush_session_t* session)
+{
+  (void) session;
+
+  return libflush_inline_get_timing();
+}
+
+static inline __attribute__((always_inline)) uint64_t
+register_timestamp_start(libflush_session_t* session)
+{
+  (void) session;
+
+  return libflush_inline_get_timing_start();
+}
+
+static inline __attribute__((always_inline)) uint64_t
+register_timestamp_end(libflush_session_t* session)
+{
+  (void) session;
+
+  return libflush_inline_get_timing_end();
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+static inline __attribute__((always_inline)) uint64_t
+lfence_timestamp(libflush_session_t* session)
+{
+  (void) session;
+
+  return x86_get_timing_lfence();
+}
+
+static inline __attribute__((always_inline)) uint64_t
+rdtscp_timestamp(libflush_session_t* session)
+{
+  (void) session;
+
+  return x86_get_timing_rdtscp();
+}
+
+static inline __attribute__((always_inline)) uint64_t
+mfence_timestamp(libflush_session_t* session)
+{
+  (void) session;
+
+  return x86_get_timing_mfence();
+}
+#endif
+
+/* The measured windows. Instantiated with constant timers, the time stamps are
+ * inlined by the compiler. */
+static inline __attribute__((always_inline)) uint64_t
+measure_reload(libflush_session_t* session, void* address, timing_function_t timestamp)
+{
+  uint64_t time = timestamp(session);
+  libflush_inline_access_memory(address);
+
+  return correct_timing(session, LIBFLUSH_OVERHEAD_TIMING, timestamp(session) - time);
+}
+
+static inline __attribute__((always_inline)) uint64_t
+measure_reload_serialized(libflush_session_t* session, void* address,
+    timing_function_t timestamp_start, timing_function_t timestamp_end)
+{
+  uint64_t time = timestamp_start(session);
+  libflush_inline_access_memory(address);
+
+  return correct_timing(session, LIBFLUSH_OVERHEAD_TIMING_SERIALIZED,
+      timestamp_end(session) - time);
+}
+
+static inline __attribute__((always_inline)) void
+measure_reload_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings, timing_function_t timestamp)
+{
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    timings[i] = measure_reload(session, addresses[i], timestamp);
+  }
+}
+
+static inline __attribute__((always_inline)) uint64_t
+measure_reload_and_flush(libflush_session_t* session, void* address,
+    timing_function_t timestamp_start, timing_function_t timestamp_end)
+{
+  uint64_t delta = measure_reload_serialized(session, address, timestamp_start,
+      timestamp_end);
+  flush_address(session, address);
+
+  return delta;
+}
+
+static inline __attribute__((always_inline)) void
+measure_reload_and_flush_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings, timing_function_t timestamp_start,
+    timing_function_t timestamp_end)
+{
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    timings[i] = measure_reload_serialized(session, addresses[i], timestamp_start,
+        timestamp_end);
+  }
+
+  /* Flush all addresses at once so that the flushes do not interleave with the
+   * measurements */
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    flush_address(session, addresses[i]);
+  }
+
+  libflush_inline_memory_barrier();
+}
+
+static inline __attribute__((always_inline)) uint64_t
+measure_reload_and_evict(libflush_session_t* session, void* address,
+    timing_function_t timestamp_start, timing_function_t timestamp_end)
+{
+  uint64_t delta = measure_reload_serialized(session, address, timestamp_start,
+      timestamp_end);
+  libflush_eviction_evict(session, address);
+
+  return delta;
+}
+
+static inline __attribute__((always_inline)) void
+measure_reload_and_evict_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings, timing_function_t timestamp_start,
+    timing_function_t timestamp_end)
+{
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    timings[i] = measure_reload_serialized(session, addresses[i], timestamp_start,
+        timestamp_end);
+  }
+
+  /* Evict all addresses at once so that the evictions do not interleave with
+   * the measurements */
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    libflush_eviction_evict(session, addresses[i]);
+  }
+
+  libflush_inline_memory_barrier();
+}
+
+static inline __attribute__((always_inline)) uint64_t
+measure_flush(libflush_session_t* session, void* address, timing_function_t timestamp)
+{
+  uint64_t start = timestamp(session);
+  flush_address(session, address);
+
+  return correct_timing(session, LIBFLUSH_OVERHEAD_TIMING, timestamp(session) - start);
+}
+
+static inline __attribute__((always_inline)) void
+measure_flush_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings, timing_function_t timestamp)
+{
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    timings[i] = measure_flush(session, addresses[i], timestamp);
+  }
+}
+
+static inline __attribute__((always_inline)) uint64_t
+measure_evict(libflush_session_t* session, void* address, timing_function_t timestamp)
+{
+  uint64_t start = timestamp(session);
+  libflush_eviction_evict(session, address);
+
+  return correct_timing(session, LIBFLUSH_OVERHEAD_TIMING, timestamp(session) - start);
+}
+
+static inline __attribute__((always_inline)) uint64_t
+measure_prefetch(libflush_session_t* session, void* address,
+    timing_function_t timestamp_start, timing_function_t timestamp_end)
+{
+  uint64_t start = timestamp_start(session);
+  libflush_inline_prefetch(address);
+
+  return correct_timing(session, LIBFLUSH_OVERHEAD_TIMING_SERIALIZED,
+      timestamp_end(session) - start);
+}
+
+static inline __attribute__((always_inline)) void
+measure_prefetch_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings, timing_function_t timestamp_start,
+    timing_function_t timestamp_end)
+{
+  for (size_t i = 0; i < number_of_addresses; i++) {
+    timings[i] = measure_prefetch(session, addresses[i], timestamp_start, timestamp_end);
+  }
+}
+
+static inline __attribute__((always_inline)) uint64_t
+measure_probe(libflush_session_t* session, size_t set_index,
+    timing_function_t timestamp_start, timing_function_t timestamp_end)
+{
+  uint64_t time = timestamp_start(session);
+  libflush_eviction_probe(session, set_index);
+
+  return correct_timing(session, LIBFLUSH_OVERHEAD_TIMING_SERIALIZED,
+      timestamp_end(session) - time);
+}
+
+static inline __attribute__((always_inline)) bool
+measure_probe_level(libflush_session_t* session, size_t set_index, unsigned int level,
+    uint64_t* time, timing_function_t timestamp_start, timing_function_t timestamp_end)
+{
+  uint64_t start = timestamp_start(session);
+  bool probed = libflush_eviction_probe_level(session, set_index, level);
+  uint64_t delta = correct_timing(session, LIBFLUSH_OVERHEAD_TIMING_SERIALIZED,
+      timestamp_end(session) - start);
+
+  if (probed == true) {
+    *time = delta;
+  }
+
+  return probed;
+}
+
+static inline __attribute__((always_inline)) void
+measure_probe_sweep(libflush_session_t* session, const size_t* set_indices,
+    size_t number_of_sets, uint64_t* times, timing_function_t timestamp_start,
+    timing_function_t timestamp_end)
+{
+  size_t stride = get_sweep_stride(number_of_sets);
+  size_t position = 0;
+  for (size_t i = 0; i < number_of_sets; i++) {
+    uint64_t time = timestamp_start(session);
+    libflush_eviction_sweep_probe(session,
+        (set_indices != NULL) ? set_indices[position] : position);
+    times[position] = correct_timing(session, LIBFLUSH_OVERHEAD_TIMING_SERIALIZED,
+        timestamp_end(session) - time);
+    position = (position + stride) % number_of_sets;
+  }
+}
+
+static inline __attribute__((always_inline)) void
+measure_overhead(libflush_session_t* session, uint64_t* samples, size_t number_of_samples,
+    timing_function_t timestamp)
+{
+  for (size_t i = 0; i < number_of_samples; i++) {
+    uint64_t start = timestamp(session);
+    samples[i] = timestamp(session) - start;
+  }
+}
+
+static inline __attribute__((always_inline)) void
+measure_overhead_serialized(libflush_session_t* session, uint64_t* samples,
+    size_t number_of_samples, timing_function_t timestamp_start,
+    timing_function_t timestamp_end)
+{
+  for (size_t i = 0; i < number_of_samples; i++) {
+    uint64_t start = timestamp_start(session);
+    samples[i] = timestamp_end(session) - start;
+  }
+}
+
+/* Timers (name, time stamp, serialized start and end time stamp) */
+#if defined(__i386__) || defined(__x86_64__)
+#define MEASUREMENT_TIMERS(X) \
+  X(session, session_timestamp, session_timestamp_start, session_timestamp_end) \
+  X(register, register_timestamp, register_timestamp_start, register_timestamp_end) \
+  X(lfence, register_timestamp, lfence_timestamp, lfence_timestamp) \
+  X(rdtscp, register_timestamp, rdtscp_timestamp, rdtscp_timestamp) \
+  X(mfence, register_timestamp, mfence_timestamp, mfence_timestamp)
+#else
+#define MEASUREMENT_TIMERS(X) \
+  X(session, session_timestamp, session_timestamp_start, session_timestamp_end) \
+  X(register, register_timestamp, register_timestamp_start, register_timestamp_end)
+#endif
+
+#define MEASUREMENT_FUNCTIONS(name, timestamp, timestamp_start, timestamp_end) \
+  static uint64_t \
+  name##_reload_address(libflush_session_t* session, void* address) \
+  { \
+    return measure_reload(session, address, timestamp); \
+  } \
+  static void \
+  name##_reload_batch(libflush_session_t* session, void** addresses, \
+      size_t number_of_addresses, uint64_t* timings) \
+  { \
+    measure_reload_batch(session, addresses, number_of_addresses, timings, timestamp); \
+  } \
+  static uint64_t \
+  name##_reload_address_and_flush(libflush_session_t* session, void* address) \
+  { \
+    return measure_reload_and_flush(session, address, timestamp_start, timestamp_end); \
+  } \
+  static void \
+  name##_reload_and_flush_batch(libflush_session_t* session, void** addresses, \
+      size_t number_of_addresses, uint64_t* timings) \
+  { \
+    measure_reload_and_flush_batch(session, addresses, number_of_addresses, timings, \
+        timestamp_start, timestamp_end); \
+  } \
+  static uint64_t \
+  name##_reload_address_and_evict(libflush_session_t* session, void* address) \
+  { \
+    return measure_reload_and_evict(session, address, timestamp_start, timestamp_end); \
+  } \
+  static void \
+  name##_reload_and_evict_batch(libflush_session_t* session, void** addresses, \
+      size_t number_of_addresses, uint64_t* timings) \
+  { \
+    measure_reload_and_evict_batch(session, addresses, number_of_addresses, timings, \
+        timestamp_start, timestamp_end); \
+  } \
+  static uint64_t \
+  name##_flush_time(libflush_session_t* session, void* address) \
+  { \
+    return measure_flush(session, address, timestamp); \
+  } \
+  static void \
+  name##_flush_time_batch(libflush_session_t* session, void** addresses, \
+      size_t number_of_addresses, uint64_t* timings) \
+  { \
+    measure_flush_batch(session, addresses, number_of_addresses, timings, timestamp); \
+  } \
+  static uint64_t \
+  name##_evict_time(libflush_session_t* session, void* address) \
+  { \
+    return measure_evict(session, address, timestamp); \
+  } \
+  static uint64_t \
+  name##_prefetch_time(libflush_session_t* session, void* address) \
+  { \
+    return measure_prefetch(session, address, timestamp_start, timestamp_end); \
+  } \
+  static void \
+  name##_prefetch_time_batch(libflush_session_t* session, void** addresses, \
+      size_t number_of_addresses, uint64_t* timings) \
+  { \
+    measure_prefetch_batch(session, addresses, number_of_addresses, timings, \
+        timestamp_start, timestamp_end); \
+  } \
+  static uint64_t \
+  name##_probe(libflush_session_t* session, size_t set_index) \
+  { \
+    return measure_probe(session, set_index, timestamp_start, timestamp_end); \
+  } \
+  static bool \
+  name##_probe_level(libflush_session_t* session, size_t set_index, unsigned int level, \
+      uint64_t* time) \
+  { \
+    return measure_probe_level(session, set_index, level, time, timestamp_start, \
+        timestamp_end); \
+  } \
+  static void \
+  name##_probe_sweep(libflush_session_t* session, const size_t* set_indices, \
+      size_t number_of_sets, uint64_t* times) \
+  { \
+    measure_probe_sweep(session, set_indices, number_of_sets, times, timestamp_start, \
+        timestamp_end); \
+  } \
+  static void \
+  name##_overhead(libflush_session_t* session, uint64_t* samples, size_t number_of_samples) \
+  { \
+    measure_overhead(session, samples, number_of_samples, timestamp); \
+  } \
+  static void \
+  name##_overhead_serialized(libflush_session_t* session, uint64_t* samples, \
+      size_t number_of_samples) \
+  { \
+    measure_overhead_serialized(session, samples, number_of_samples, timestamp_start, \
+        timestamp_end); \
+  } \
+  static const measurement_t name##_measurement = { \
+    name##_reload_address, \
+    name##_reload_batch, \
+    name##_reload_address_and_flush, \
+    name##_reload_and_flush_batch, \
+    name##_reload_address_and_evict, \
+    name##_reload_and_evict_batch, \
+    name##_flush_time, \
+    name##_flush_time_batch, \
+    name##_evict_time, \
+    name##_prefetch_time, \
+    name##_prefetch_time_batch, \
+    name##_probe, \
+    name##_probe_level, \
+    name##_probe_sweep, \
+    name##_overhead, \
+    name##_overhead_serialized \
+  };
+
+MEASUREMENT_TIMERS(MEASUREMENT_FUNCTIONS)
+
+/* The register time source is read inline with the time stamps of its fence,
+ * every other time source through the session */
+static const measurement_t*
+get_measurement(libflush_session_t* session)
+{
+  if (session->timing.source != LIBFLUSH_TIME_SOURCE_REGISTER) {
+    return &session_measurement;
+  }
+
+  switch (session->timing.fence) {
+#if defined(__i386__) || defined(__x86_64__)
+    case LIBFLUSH_FENCE_LFENCE:
+      return &lfence_measurement;
+    case LIBFLUSH_FENCE_RDTSCP:
+      return &rdtscp_measurement;
+    case LIBFLUSH_FENCE_MFENCE:
+      return &mfence_measurement;
+#endif
+    default:
+      return &register_measurement;
+  }
 }
-#endif
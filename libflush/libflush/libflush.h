@@ -11,16 +11,208 @@ extern "C" {
 #include <stdlib.h>
 #include <stdbool.h>
 
+/**
+ * Time sources
+ */
+typedef enum libflush_time_source_e {
+  LIBFLUSH_TIME_SOURCE_DEFAULT = 0, /**< Time source selected at build time */
+  LIBFLUSH_TIME_SOURCE_REGISTER = 1, /**< Performance register / Time-stamp counter */
+  LIBFLUSH_TIME_SOURCE_PERF = 2, /**< Perf interface */
+  LIBFLUSH_TIME_SOURCE_MONOTONIC_CLOCK = 3, /**< Monotonic clock */
+  LIBFLUSH_TIME_SOURCE_THREAD_COUNTER = 4, /**< Dedicated thread counter */
+  LIBFLUSH_TIME_SOURCE_AUTO = 5 /**< Benchmark all time sources and choose the best one (the thread counter only if no other one is available) */
+} libflush_time_source_t;
+
+/**
+ * Serialization of the start and end time stamps of the register time source
+ * (x86 only)
+ */
+typedef enum libflush_fence_e {
+  LIBFLUSH_FENCE_DEFAULT = 0, /**< Same as LIBFLUSH_FENCE_CPUID */
+  LIBFLUSH_FENCE_CPUID = 1, /**< MFENCE+RDTSCP+CPUID (slow, causes a VM exit) */
+  LIBFLUSH_FENCE_LFENCE = 2, /**< LFENCE+RDTSC+LFENCE */
+  LIBFLUSH_FENCE_RDTSCP = 3, /**< RDTSCP+LFENCE */
+  LIBFLUSH_FENCE_MFENCE = 4 /**< MFENCE+LFENCE+RDTSC+LFENCE */
+} libflush_fence_t;
+
+/**
+ * Flush instructions (x86 only)
+ */
+typedef enum libflush_flush_instruction_e {
+  LIBFLUSH_FLUSH_INSTRUCTION_DEFAULT = 0, /**< CLFLUSH for single addresses, the fastest available one for ranges */
+  LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSH = 1, /**< CLFLUSH */
+  LIBFLUSH_FLUSH_INSTRUCTION_CLFLUSHOPT = 2, /**< CLFLUSHOPT (weakly ordered) */
+  LIBFLUSH_FLUSH_INSTRUCTION_CLWB = 3 /**< CLWB (writes the line back, but may keep it cached) */
+} libflush_flush_instruction_t;
+
+/**
+ * Kinds of measurement windows whose overhead is calibrated
+ */
+typedef enum libflush_overhead_e {
+  LIBFLUSH_OVERHEAD_TIMING = 0, /**< Two plain time stamps (flush_time, evict_time, reload_address) */
+  LIBFLUSH_OVERHEAD_TIMING_SERIALIZED = 1 /**< Serialized start/end time stamps (reload_address_and_flush/evict, prefetch_time, probe) */
+} libflush_overhead_t;
+
+/**
+ * Pages backing the eviction pool
+ */
+typedef enum libflush_eviction_pages_e {
+  LIBFLUSH_EVICTION_PAGES_DEFAULT = 0, /**< Same as LIBFLUSH_EVICTION_PAGES_SMALL */
+  LIBFLUSH_EVICTION_PAGES_SMALL = 1, /**< 4 KiB pages (every line is translated with the pagemap) */
+  LIBFLUSH_EVICTION_PAGES_HUGE = 2, /**< 2 MiB pages (MAP_HUGETLB, falls back to transparent huge pages and small pages) */
+  LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE = 3 /**< 2 MiB transparent huge pages (falls back to small pages) */
+} libflush_eviction_pages_t;
+
+/**
+ * NUMA node of the eviction pool
+ */
+typedef enum libflush_eviction_node_e {
+  LIBFLUSH_EVICTION_NODE_LOCAL = 0, /**< Node of the CPU the session is initialized on (unbound without NUMA support) */
+  LIBFLUSH_EVICTION_NODE_ANY = 1, /**< Memory policy of the process */
+  LIBFLUSH_EVICTION_NODE_FIXED = 2 /**< Node given by eviction_node_id */
+} libflush_eviction_node_t;
+
+/**
+ * Population of the eviction pool
+ */
+typedef enum libflush_eviction_population_e {
+  LIBFLUSH_EVICTION_POPULATION_DEFAULT = 0, /**< Same as LIBFLUSH_EVICTION_POPULATION_PARALLEL */
+  LIBFLUSH_EVICTION_POPULATION_SERIAL = 1, /**< MAP_POPULATE in the initializing thread */
+  LIBFLUSH_EVICTION_POPULATION_PARALLEL = 2, /**< Chunks populated by several threads (one thread without pthread support) */
+  LIBFLUSH_EVICTION_POPULATION_INCREMENTAL = 3 /**< Regions populated as the eviction sets need them (not with eviction_profile_file) */
+} libflush_eviction_population_t;
+
+/**
+ * Access of the lines of an eviction set
+ */
+typedef enum libflush_eviction_access_e {
+  LIBFLUSH_EVICTION_ACCESS_DEFAULT = 0, /**< Same as LIBFLUSH_EVICTION_ACCESS_ARRAY */
+  LIBFLUSH_EVICTION_ACCESS_ARRAY = 1, /**< Independent loads of the lines in the order of the pool */
+  LIBFLUSH_EVICTION_ACCESS_CHAIN = 2, /**< Dependent loads along a list linked through the lines */
+  LIBFLUSH_EVICTION_ACCESS_RANDOM_CHAIN = 3 /**< Same as LIBFLUSH_EVICTION_ACCESS_CHAIN with the lines in random order */
+} libflush_eviction_access_t;
+
+/**
+ * Hash of the physical address to the slice of the last-level cache
+ */
+typedef enum libflush_slice_hash_e {
+  LIBFLUSH_SLICE_HASH_NONE = 0, /**< Single slice */
+  LIBFLUSH_SLICE_HASH_INTEL = 1, /**< XOR functions of Intel Core processors with 1, 2, 4 or 8 slices */
+  LIBFLUSH_SLICE_HASH_FILE = 2 /**< XOR functions or a measured table read from slice_hash_file */
+} libflush_slice_hash_t;
+
+/**
+ * Outcome of loading the set index profile of the eviction pool
+ */
+typedef enum libflush_eviction_profile_state_e {
+  LIBFLUSH_EVICTION_PROFILE_NONE = 0, /**< No eviction_profile_file */
+  LIBFLUSH_EVICTION_PROFILE_MISSING = 1, /**< The file did not exist and is written once the set indices are computed */
+  LIBFLUSH_EVICTION_PROFILE_LOADED = 2, /**< The set indices were read from the file and validated */
+  LIBFLUSH_EVICTION_PROFILE_INVALID = 3 /**< The file did not match the pool and is replaced once the set indices are computed */
+} libflush_eviction_profile_state_t;
+
+/**
+ * Type of a cache, encoded as by CPUID
+ */
+typedef enum libflush_cache_type_e {
+  LIBFLUSH_CACHE_TYPE_DATA = 1, /**< Data cache */
+  LIBFLUSH_CACHE_TYPE_INSTRUCTION = 2, /**< Instruction cache */
+  LIBFLUSH_CACHE_TYPE_UNIFIED = 3 /**< Unified cache */
+} libflush_cache_type_t;
+
+/**
+ * Geometry of a cache of the CPU the session was initialized on
+ */
+typedef struct libflush_cache_geometry_s {
+  unsigned int level; /**< Level of the cache (1: closest to the core) */
+  libflush_cache_type_t type; /**< Type of the cache */
+  size_t line_length; /**< Line length in bytes */
+  size_t number_of_sets; /**< Number of sets of all slices */
+  size_t associativity; /**< Number of ways */
+  size_t size; /**< Size in bytes */
+  size_t number_of_sharing_cpus; /**< Number of logical CPUs sharing the cache */
+} libflush_cache_geometry_t;
+
+/**
+ * Eviction strategy. The loop runs in rounds over the eviction set of a cache
+ * set: the rounds start at the addresses 0, step_size, 2 * step_size, ... below
+ * eviction_counter and access the different_addresses_in_loop following
+ * addresses number_of_accesses_in_loop times. A strategy requires
+ * eviction_counter + different_addresses_in_loop - 1 addresses.
+ */
+typedef struct libflush_eviction_strategy_s {
+  size_t eviction_counter; /**< Length of the loop (0: strategy of the device configuration) */
+  size_t number_of_accesses_in_loop; /**< Number of accesses of an address in one loop round */
+  size_t different_addresses_in_loop; /**< Number of different addresses in one loop round */
+  size_t step_size; /**< Increment of the loop (0 is the same as 1) */
+  bool mirroring; /**< Repeat the loop in reverse order */
+} libflush_eviction_strategy_t;
+
 /**
  * libflush session
  */
 typedef struct libflush_session_args_s {
   size_t bind_to_cpu; /**< CPU id to bind dedicated thread timer */
   bool performance_register_div64; /**< Enable 64 divisor (ARM only) */
+  libflush_time_source_t time_source; /**< Time source */
+  bool subtract_overhead; /**< Subtract the calibrated overhead from all measurements */
+  libflush_fence_t fence; /**< Serialization of the time stamps (x86 only) */
+  libflush_flush_instruction_t flush_instruction; /**< Flush instruction (x86 only) */
+  libflush_eviction_pages_t eviction_pages; /**< Pages backing the eviction pool */
+  libflush_eviction_node_t eviction_node; /**< NUMA node of the eviction pool */
+  unsigned int eviction_node_id; /**< Node of LIBFLUSH_EVICTION_NODE_FIXED */
+  libflush_eviction_population_t eviction_population; /**< Population of the eviction pool */
+  bool eviction_touch; /**< Write every 1 KiB of the eviction pool after populating it */
+  libflush_eviction_strategy_t eviction_strategy; /**< Eviction strategy (all zero: strategy of the device configuration) */
+  bool eviction_jit; /**< Compile the eviction and probe routine of every eviction set to machine code (x86-64 only) */
+  libflush_eviction_access_t eviction_access; /**< Access of the lines of an eviction set (array access only with eviction_jit) */
+  libflush_slice_hash_t slice_hash; /**< Slice hash of the last-level cache (requires pagemap access) */
+  size_t number_of_slices; /**< Number of slices (optional for LIBFLUSH_SLICE_HASH_FILE) */
+  const char* slice_hash_file; /**< File of LIBFLUSH_SLICE_HASH_FILE */
+  const char* eviction_pool_file; /**< File on hugetlbfs or tmpfs that backs the eviction pool and keeps its pages across sessions (created if missing) */
+  const char* eviction_profile_file; /**< Versioned file that keeps the set indices of the eviction pool across sessions */
 } libflush_session_args_t;
 
 typedef struct libflush_session_s libflush_session_t;
 
+/**
+ * Result of the timing-based discovery of an eviction set
+ */
+typedef struct libflush_discovery_result_s {
+  size_t number_of_candidates; /**< Lines of the current candidate set (the minimal eviction set once found) */
+  size_t number_of_addresses; /**< Congruent lines kept as the eviction set of the address */
+  size_t number_of_tests; /**< Eviction tests run so far */
+  unsigned int number_of_attempts; /**< Reductions started so far */
+  uint64_t threshold; /**< Reload time in cycles above which the target counts as evicted */
+  uint64_t duration; /**< Time spent in nanoseconds */
+} libflush_discovery_result_t;
+
+/**
+ * Called after every reduction step of a discovery
+ *
+ * @param[in] result The progress so far
+ * @param[in] data The progress_data of the discovery arguments
+ *
+ * @return true Continue
+ * @return false Abort the discovery
+ */
+typedef bool (*libflush_discovery_progress_t)(const libflush_discovery_result_t* result,
+    void* data);
+
+/**
+ * Arguments of the timing-based discovery of an eviction set. All fields are
+ * optional.
+ */
+typedef struct libflush_discovery_args_s {
+  size_t associativity; /**< Upper bound of the associativity of the cache (0: DISCOVERY_ASSOCIATIVITY) */
+  unsigned int number_of_attempts; /**< Reductions started before the discovery fails (0: DISCOVERY_NUMBER_OF_ATTEMPTS) */
+  unsigned int verification_rounds; /**< Eviction tests the minimal set has to pass (0: DISCOVERY_VERIFICATION_ROUNDS) */
+  uint64_t threshold; /**< Reload time in cycles above which the target counts as evicted (0: calibrated) */
+  uint64_t time_budget; /**< Time budget in nanoseconds (0: unlimited) */
+  libflush_discovery_progress_t progress; /**< Progress callback */
+  void* progress_data; /**< Data passed to the progress callback */
+} libflush_discovery_args_t;
+
 /**
  * Initializes the libflush session
  *
@@ -51,6 +243,59 @@ bool libflush_terminate(libflush_session_t* session);
  */
 uint64_t libflush_get_timing(libflush_session_t* session);
 
+/**
+ * Returns the time source used by the session
+ *
+ * @param[in] session The used session
+ *
+ * @return The time source
+ */
+libflush_time_source_t libflush_get_time_source(libflush_session_t* session);
+
+/**
+ * Converts a difference of two time measurements into nanoseconds. The rate
+ * of the time source is calibrated against the monotonic clock on first use.
+ *
+ * @param[in] session The used session
+ * @param[in] timing The time difference in units of the time source
+ *
+ * @return The time difference in nanoseconds or 0 if the time source could
+ * not be calibrated
+ */
+uint64_t libflush_timing_to_ns(libflush_session_t* session, uint64_t timing);
+
+/**
+ * Measures the cost of an empty measurement window for every kind of window
+ * and stores it in the session. This is done by libflush_init, but can be
+ * repeated, e.g., after the thread has been moved to a different CPU.
+ *
+ * @param[in] session The used session
+ *
+ * @return true Calibration was successful
+ * @return false Calibration failed
+ */
+bool libflush_calibrate_overhead(libflush_session_t* session);
+
+/**
+ * Returns the calibrated overhead of a measurement window
+ *
+ * @param[in] session The used session
+ * @param[in] overhead The kind of measurement window
+ *
+ * @return The median cost of an empty window in units of the time source
+ */
+uint64_t libflush_get_overhead(libflush_session_t* session, libflush_overhead_t overhead);
+
+/**
+ * Enables or disables the subtraction of the calibrated overhead from the
+ * values returned by the *_time and reload* functions. Corrected values are
+ * clamped at 0.
+ *
+ * @param[in] session The used session
+ * @param[in] enable true to subtract the overhead
+ */
+void libflush_set_overhead_subtraction(libflush_session_t* session, bool enable);
+
 /**
  * Resets the time measurement
  *
@@ -66,6 +311,17 @@ void libflush_reset_timing(libflush_session_t* session);
  */
 void libflush_flush(libflush_session_t* session, void* address);
 
+/**
+ * Flushes all cache lines of the given memory range. The flushes are issued
+ * back to back with the fastest available instruction and are followed by a
+ * single fence.
+ *
+ * @param[in] session The used session
+ * @param[in] address The start of the range
+ * @param[in] length The length of the range in bytes
+ */
+void libflush_flush_range(libflush_session_t* session, void* address, size_t length);
+
 /**
  * Measure how long it takes to flush the given address
  *
@@ -77,7 +333,21 @@ void libflush_flush(libflush_session_t* session, void* address);
 uint64_t libflush_flush_time(libflush_session_t* session, void* address);
 
 /**
- * Evicts the given address
+ * Measures how long it takes to flush each of the given addresses
+ *
+ * @param[in] session The used session
+ * @param[in] addresses The addresses to flush
+ * @param[in] number_of_addresses The number of addresses
+ * @param[out] timings Timing measurement of each address
+ */
+void libflush_flush_time_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+
+/**
+ * Evicts the given address. Without pagemap access, addresses cannot be
+ * translated, so only addresses with a discovered eviction set are evicted.
+ * Neither are addresses whose set has fewer lines in the pool than the
+ * eviction strategy needs.
  *
  * @param[in] session The used session
  * @param[in] address The address to flush
@@ -111,6 +381,17 @@ void libflush_access_memory(void *address);
  */
 uint64_t libflush_reload_address(libflush_session_t* session, void* address);
 
+/**
+ * Measures the time it takes to access each of the given addresses
+ *
+ * @param[in] session The used session
+ * @param[in] addresses Addresses to access
+ * @param[in] number_of_addresses The number of addresses
+ * @param[out] timings Timing measurement of each address
+ */
+void libflush_reload_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+
 /**
  * Measures the time it takes to access the given address. Then the address is
  * flushed to memory.
@@ -122,6 +403,18 @@ uint64_t libflush_reload_address(libflush_session_t* session, void* address);
  */
 uint64_t libflush_reload_address_and_flush(libflush_session_t* session, void* address);
 
+/**
+ * Measures the time it takes to access each of the given addresses. The
+ * addresses are flushed to memory after all of them have been measured.
+ *
+ * @param[in] session The used session
+ * @param[in] addresses Addresses to access
+ * @param[in] number_of_addresses The number of addresses
+ * @param[out] timings Timing measurement of each address
+ */
+void libflush_reload_and_flush_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+
 /**
  * Measures the time it takes to access the given address. Then the address is
  * evicted to memory.
@@ -133,13 +426,27 @@ uint64_t libflush_reload_address_and_flush(libflush_session_t* session, void* ad
  */
 uint64_t libflush_reload_address_and_evict(libflush_session_t* session, void* address);
 
+/**
+ * Measures the time it takes to access each of the given addresses. The
+ * addresses are evicted to memory after all of them have been measured.
+ *
+ * @param[in] session The used session
+ * @param[in] addresses Addresses to access
+ * @param[in] number_of_addresses The number of addresses
+ * @param[out] timings Timing measurement of each address
+ */
+void libflush_reload_and_evict_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+
 /**
  * Memory barrier
  */
 void libflush_memory_barrier();
 
 /**
- * Primes a given cache set.
+ * Primes a given cache set. Nothing is accessed if the set has no eviction set,
+ * as with a pool of small pages without pagemap access or if the pool holds
+ * fewer lines of the set than the eviction strategy needs.
  *
  * @param[in] session The used session
  * @param[in] set_index The set index
@@ -157,7 +464,165 @@ void libflush_prime(libflush_session_t* session, size_t set_index);
 uint64_t libflush_probe(libflush_session_t* session, size_t set_index);
 
 /**
- * Returns the set index of a given address
+ * Evicts a given address from a given cache level. The levels are the ones of
+ * libflush_get_cache_geometry. The last level uses the eviction sets of
+ * libflush_evict, the data and unified caches below it have eviction sets of
+ * their own, which are built from the same pool (requires pagemap access).
+ *
+ * @param[in] session The used session
+ * @param[in] address The target address
+ * @param[in] level The cache level
+ *
+ * @return true The address has been evicted
+ * @return false The level has no eviction sets, the address or the pool cannot
+ *   be translated or the pool holds too few lines of the set
+ */
+bool libflush_evict_level(libflush_session_t* session, void* address, unsigned int level);
+
+/**
+ * Primes a given cache set of a given cache level.
+ *
+ * @param[in] session The used session
+ * @param[in] set_index The set index within the level
+ * @param[in] level The cache level
+ *
+ * @return true The set has been primed
+ * @return false The level has no eviction sets, the set index is invalid, the
+ *   pool cannot be translated or it holds too few lines of the set
+ */
+bool libflush_prime_level(libflush_session_t* session, size_t set_index, unsigned int level);
+
+/**
+ * Probes a given cache set of a given cache level.
+ *
+ * @param[in] session The used session
+ * @param[in] set_index The set index within the level
+ * @param[in] level The cache level
+ * @param[out] time Timing measurement
+ *
+ * @return true The set has been probed
+ * @return false The level has no eviction sets, the set index is invalid, the
+ *   pool cannot be translated or it holds too few lines of the set
+ */
+bool libflush_probe_level(libflush_session_t* session, size_t set_index, unsigned int level,
+    uint64_t* time);
+
+/**
+ * Returns the set index of a given address within a given cache level
+ *
+ * @param[in] session The used session
+ * @param[in] address The target address
+ * @param[in] level The cache level
+ * @param[out] set_index The set index
+ *
+ * @return true The set index has been computed
+ * @return false The level has no eviction sets, the address cannot be
+ * translated or it has a discovered eviction set
+ */
+bool libflush_get_level_set_index(libflush_session_t* session, void* address,
+    unsigned int level, size_t* set_index);
+
+/**
+ * Returns the number of sets of a given cache level
+ *
+ * @param[in] session The used session
+ * @param[in] level The cache level
+ *
+ * @return The number of sets (0 if the level has no eviction sets)
+ */
+size_t libflush_get_level_number_of_sets(libflush_session_t* session, unsigned int level);
+
+/**
+ * Changes the eviction strategy of a given cache level. The eviction counter
+ * of the default strategy of a level below the last level is its
+ * associativity.
+ *
+ * @param[in] session The used session
+ * @param[in] level The cache level
+ * @param[in] strategy The eviction strategy (NULL or an eviction counter of 0:
+ * default strategy of the level)
+ *
+ * @return true The strategy has been changed
+ * @return false The level has no eviction sets or the strategy is invalid
+ */
+bool libflush_set_level_eviction_strategy(libflush_session_t* session, unsigned int level,
+    const libflush_eviction_strategy_t* strategy);
+
+/**
+ * Returns the eviction strategy of a given cache level
+ *
+ * @param[in] session The used session
+ * @param[in] level The cache level
+ * @param[out] strategy The eviction strategy
+ *
+ * @return true The strategy has been returned
+ * @return false The level has no eviction sets
+ */
+bool libflush_get_level_eviction_strategy(libflush_session_t* session, unsigned int level,
+    libflush_eviction_strategy_t* strategy);
+
+/**
+ * Primes the first number_of_sets cache sets. The sets are visited in an
+ * interleaved order, so that neighbouring sets are not primed back-to-back.
+ *
+ * @param[in] session The used session
+ * @param[in] number_of_sets The number of sets (at most libflush_get_number_of_sets)
+ *
+ * @return true All sets have been primed
+ * @return false There are less sets, the pool cannot be translated or it
+ *   holds too few lines of a set
+ */
+bool libflush_prime_all(libflush_session_t* session, size_t number_of_sets);
+
+/**
+ * Probes the first number_of_sets cache sets in the same interleaved order as
+ * libflush_prime_all.
+ *
+ * @param[in] session The used session
+ * @param[out] times Timing measurement of every set, indexed by the set index
+ * @param[in] number_of_sets The number of sets (at most libflush_get_number_of_sets)
+ *
+ * @return true All sets have been probed
+ * @return false There are less sets, the pool cannot be translated or it
+ *   holds too few lines of a set
+ */
+bool libflush_probe_all(libflush_session_t* session, uint64_t* times, size_t number_of_sets);
+
+/**
+ * Primes the given cache sets in an interleaved order.
+ *
+ * @param[in] session The used session
+ * @param[in] set_indices The set indices
+ * @param[in] number_of_sets The number of set indices
+ *
+ * @return true All sets have been primed
+ * @return false A set index is invalid, the pool cannot be translated or it
+ *   holds too few lines of a set
+ */
+bool libflush_prime_sets(libflush_session_t* session, const size_t* set_indices,
+    size_t number_of_sets);
+
+/**
+ * Probes the given cache sets in the same interleaved order as
+ * libflush_prime_sets.
+ *
+ * @param[in] session The used session
+ * @param[in] set_indices The set indices
+ * @param[in] number_of_sets The number of set indices
+ * @param[out] times Timing measurement of every set, in the order of set_indices
+ *
+ * @return true All sets have been probed
+ * @return false A set index is invalid, the pool cannot be translated or it
+ *   holds too few lines of a set
+ */
+bool libflush_probe_sets(libflush_session_t* session, const size_t* set_indices,
+    size_t number_of_sets, uint64_t* times);
+
+/**
+ * Returns the set index of a given address. With a slice hash the sets of all
+ * slices are numbered consecutively: the index is slice *
+ * (libflush_get_number_of_sets / libflush_get_number_of_slices) plus the set
+ * within the slice.
  *
  * @param[in] session The used session
  * @param[in] address The target address
@@ -167,7 +632,7 @@ uint64_t libflush_probe(libflush_session_t* session, size_t set_index);
 size_t libflush_get_set_index(libflush_session_t* session, void* address);
 
 /**
- * Returns the number of sets
+ * Returns the number of sets of all slices
  *
  * @param[in] session The used session
  *
@@ -175,6 +640,168 @@ size_t libflush_get_set_index(libflush_session_t* session, void* address);
  */
 size_t libflush_get_number_of_sets(libflush_session_t* session);
 
+/**
+ * Returns the number of slices of the last-level cache given by the slice hash
+ * of the session
+ *
+ * @param[in] session The used session
+ *
+ * @return The number of slices
+ */
+size_t libflush_get_number_of_slices(libflush_session_t* session);
+
+/**
+ * Returns the caches of the CPU the session was initialized on, ordered by
+ * level. They are read from the cache directories of the CPU in
+ * /sys/devices/system/cpu or, if sysfs does not describe them, from CPUID
+ * (x86 only). Unless the device configuration defines NUMBER_OF_SETS,
+ * eviction uses the geometry of the last level.
+ *
+ * @param[in] session The used session
+ * @param[out] caches The caches (optional)
+ * @param[in] number_of_caches The maximal number of caches to store
+ *
+ * @return The number of detected caches
+ */
+size_t libflush_get_cache_geometry(libflush_session_t* session,
+    libflush_cache_geometry_t* caches, size_t number_of_caches);
+
+/**
+ * Returns the pages that actually back the eviction pool. With huge pages the
+ * set indices of the pool are computed from the virtual addresses without any
+ * pagemap reads.
+ *
+ * @param[in] session The used session
+ *
+ * @return LIBFLUSH_EVICTION_PAGES_SMALL, LIBFLUSH_EVICTION_PAGES_HUGE or
+ * LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE
+ */
+libflush_eviction_pages_t libflush_get_eviction_pages(libflush_session_t* session);
+
+/**
+ * Returns the NUMA node the eviction pool is bound to. Its pages are allocated
+ * on the node when the pool is mapped, and later faults of the pool allocate
+ * on the node as well.
+ *
+ * @param[in] session The used session
+ *
+ * @return The node or -1 if the pool is not bound to a node
+ */
+int libflush_get_eviction_node(libflush_session_t* session);
+
+/**
+ * Returns whether the set indices of the eviction pool were loaded from the
+ * eviction_profile_file of the session arguments. A loaded profile is checked
+ * against the pagemap for a sample of the sets, so it is only reused if the
+ * pool is backed by the same physical pages as when it was written.
+ *
+ * @param[in] session The used session
+ *
+ * @return The state of the profile
+ */
+libflush_eviction_profile_state_t libflush_get_eviction_profile_state(libflush_session_t* session);
+
+/**
+ * Sets the eviction strategy used by all eviction based functions of the
+ * session. Must not be called while other threads use the session.
+ *
+ * @param[in] session The used session
+ * @param[in] strategy The eviction strategy (NULL: strategy of the device configuration)
+ *
+ * @return true The strategy has been set
+ * @return false The strategy is invalid or requires more addresses than the
+ * eviction pool provides
+ */
+bool libflush_set_eviction_strategy(libflush_session_t* session,
+    const libflush_eviction_strategy_t* strategy);
+
+/**
+ * Returns the eviction strategy of the session
+ *
+ * @param[in] session The used session
+ * @param[out] strategy The eviction strategy
+ */
+void libflush_get_eviction_strategy(libflush_session_t* session,
+    libflush_eviction_strategy_t* strategy);
+
+/**
+ * Evicts the given address with the given eviction strategy instead of the
+ * one of the session
+ *
+ * @param[in] session The used session
+ * @param[in] address The address
+ * @param[in] strategy The eviction strategy
+ *
+ * @return true The address has been evicted
+ * @return false The strategy is invalid or the address has no eviction set
+ */
+bool libflush_evict_strategy(libflush_session_t* session, void* address,
+    const libflush_eviction_strategy_t* strategy);
+
+/**
+ * Builds the eviction set of the line of the given address from timing alone,
+ * so that eviction works without access to the pagemap. The lines of the
+ * eviction pool with the same page offset as the address are reduced to a
+ * minimal eviction set by group testing. All lines of the pool that the
+ * minimal set evicts are kept as the eviction set, and further evictions of
+ * the line use it instead of the set index of the physical address. Eviction
+ * sets are only discovered with the array access of eviction sets.
+ *
+ * @param[in] session The used session
+ * @param[in] address The target address
+ * @param[in] args The discovery arguments (NULL: defaults)
+ * @param[out] result The result of the discovery (optional)
+ *
+ * @return true The eviction set has been found
+ * @return false No eviction set with as many lines as the eviction strategy
+ * requires has been found within the attempts or the time budget, or the
+ * progress callback aborted the discovery
+ */
+bool libflush_discover_eviction_set(libflush_session_t* session, void* address,
+    const libflush_discovery_args_t* args, libflush_discovery_result_t* result);
+
+/**
+ * Builds the eviction sets of the lines of the given addresses ahead of their
+ * first eviction. The addresses are translated by the caller and the sets are
+ * built by a background thread of the session, so that the first eviction of
+ * the lines does not search the eviction pool. Without pthread support the
+ * sets are built before the function returns. Evictions of lines whose sets
+ * are not ready yet build them themselves.
+ *
+ * @param[in] session The used session
+ * @param[in] addresses The addresses (NULL: all sets of the cache)
+ * @param[in] number_of_addresses The number of addresses
+ *
+ * @return true The eviction sets have been requested
+ * @return false The requests could not be allocated or an address cannot be
+ * translated, as without pagemap access
+ */
+bool libflush_prepare_eviction_sets(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses);
+
+/**
+ * Waits until all eviction sets requested by libflush_prepare_eviction_sets
+ * have been built.
+ *
+ * @param[in] session The used session
+ */
+void libflush_wait_eviction_sets(libflush_session_t* session);
+
+/**
+ * Returns whether the eviction sets of the lines of the given addresses are
+ * complete for the eviction strategy of the session. Addresses that have
+ * neither been prepared nor evicted are not ready.
+ *
+ * @param[in] session The used session
+ * @param[in] addresses The addresses (NULL: all sets of the cache)
+ * @param[in] number_of_addresses The number of addresses
+ *
+ * @return true All eviction sets are ready
+ * @return false At least one eviction set is not ready
+ */
+bool libflush_eviction_sets_ready(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses);
+
 /**
  * Prefetches an address.
  *
@@ -193,6 +820,17 @@ void libflush_prefetch(libflush_session_t* session, void* address);
  */
 uint64_t libflush_prefetch_time(libflush_session_t* session, void* address);
 
+/**
+ * Measures the time it takes to prefetch each of the given addresses.
+ *
+ * @param[in] session The used session.
+ * @param[in] addresses The target addresses.
+ * @param[in] number_of_addresses The number of addresses.
+ * @param[out] timings Timing measurement of each address.
+ */
+void libflush_prefetch_time_batch(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+
 /**
  * Returns the physical address of an virtual address.
  *
@@ -213,6 +851,36 @@ uintptr_t libflush_get_physical_address(libflush_session_t* session, uintptr_t v
  */
 uint64_t libflush_get_pagemap_entry(libflush_session_t* session, uint64_t virtual_address);
 
+/**
+ * Translates a range of virtual pages into page frame numbers with a single
+ * read of the pagemap. The pages are not accessed, thus pages that are not
+ * present are reported with a frame number of 0. The translations are added
+ * to the translation cache of the session.
+ *
+ * @param[in] session The used session
+ * @param[in] virtual_address Virtual address within the first page
+ * @param[in] number_of_pages Number of pages
+ * @param[out] page_frame_numbers Page frame number of every page
+ *
+ * @return true Translation was successful
+ * @return false Translation failed
+ */
+bool libflush_translate_range(libflush_session_t* session, uintptr_t virtual_address,
+    size_t number_of_pages, uint64_t* page_frame_numbers);
+
+/**
+ * Removes the translations of the given range from the translation cache of
+ * the session. This needs to be called if the range is unmapped or remapped,
+ * as libflush_get_physical_address would otherwise return stale physical
+ * addresses.
+ *
+ * @param[in] session The used session
+ * @param[in] virtual_address Start of the range or NULL to clear the whole cache
+ * @param[in] length Length of the range in bytes
+ */
+void libflush_invalidate_translations(libflush_session_t* session, void* virtual_address,
+    size_t length);
+
 /**
  * Binds the process to a cpu
  *
@@ -223,6 +891,26 @@ uint64_t libflush_get_pagemap_entry(libflush_session_t* session, uint64_t virtua
  */
 bool libflush_bind_to_cpu(size_t cpu);
 
+/**
+ * Returns the NUMA node of a cpu
+ *
+ * @param[in] cpu The cpu id
+ *
+ * @return The node or -1 if the system does not report it
+ */
+int libflush_get_cpu_node(size_t cpu);
+
+/**
+ * Returns the NUMA node of the page of an address. Pages are placed on their
+ * first access, so the page has to be accessed before.
+ *
+ * @param[in] address The address
+ *
+ * @return The node or -1 if the page is not present or the system does not
+ * support NUMA
+ */
+int libflush_get_address_node(void* address);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,237 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef LIBFLUSH_INLINE_H
+#define LIBFLUSH_INLINE_H
+
+/**
+ * Inline fast path of the libflush measurement primitives.
+ *
+ * The functions in this header are compiled directly into the caller so that
+ * no function call ends up in the measured window. They always use the cycle
+ * counter of the CPU (the register time source) and the flush instruction of
+ * the architecture. A session must have been initialized with libflush_init
+ * before they are used, as it enables user space access to the counter on
+ * ARM.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__ARM_ARCH_7A__)
+#include "armv7/memory.h"
+#include "armv7/timing.h"
+#elif defined(__ARM_ARCH_8A__) || defined(__aarch64__)
+#include "armv8/memory.h"
+#include "armv8/timing.h"
+#include "armv8/flush.h"
+#define LIBFLUSH_INLINE_HAVE_FLUSH 1
+#elif defined(__i386__) || defined(__x86_64__)
+#include "x86/memory.h"
+#include "x86/timing.h"
+#include "x86/flush.h"
+#define LIBFLUSH_INLINE_HAVE_FLUSH 1
+#else
+#error No inline fast path available on this platform
+#endif
+
+/**
+ * Memory barrier
+ */
+static inline void
+libflush_inline_memory_barrier(void)
+{
+#if defined(__ARM_ARCH_7A__)
+  arm_v7_memory_barrier();
+#elif defined(__ARM_ARCH_8A__) || defined(__aarch64__)
+  arm_v8_memory_barrier();
+#else
+  x86_memory_barrier();
+#endif
+}
+
+/**
+ * Accesses the given data pointer
+ *
+ * @param[in] address Address to access
+ */
+static inline void
+libflush_inline_access_memory(void* address)
+{
+#if defined(__ARM_ARCH_7A__)
+  arm_v7_access_memory(address);
+#elif defined(__ARM_ARCH_8A__) || defined(__aarch64__)
+  arm_v8_access_memory(address);
+#else
+  x86_access_memory(address);
+#endif
+}
+
+/**
+ * Prefetches an address.
+ *
+ * @param[in] address The target address.
+ */
+static inline void
+libflush_inline_prefetch(void* address)
+{
+#if defined(__ARM_ARCH_7A__)
+  arm_v7_prefetch(address);
+  arm_v7_memory_barrier();
+#elif defined(__ARM_ARCH_8A__) || defined(__aarch64__)
+  arm_v8_prefetch(address);
+  arm_v8_memory_barrier();
+#else
+  x86_prefetch(address);
+#endif
+}
+
+/**
+ * Get current value of the cycle counter
+ *
+ * @return Current time measurement
+ */
+static inline uint64_t
+libflush_inline_get_timing(void)
+{
+  uint64_t result = 0;
+
+  libflush_inline_memory_barrier();
+
+#if defined(__ARM_ARCH_7A__)
+  result = arm_v7_get_timing();
+#elif defined(__ARM_ARCH_8A__) || defined(__aarch64__)
+  result = arm_v8_get_timing();
+#else
+  result = x86_get_timing();
+#endif
+
+  libflush_inline_memory_barrier();
+
+  return result;
+}
+
+/**
+ * Get the value of the cycle counter at the beginning of a measured window.
+ * On x86 the instruction stream is serialized after the counter has been read.
+ *
+ * @return Current time measurement
+ */
+static inline uint64_t
+libflush_inline_get_timing_start(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+  return x86_get_timing_start();
+#else
+  return libflush_inline_get_timing();
+#endif
+}
+
+/**
+ * Get the value of the cycle counter at the end of a measured window. On x86
+ * the instruction stream is serialized before the counter is read.
+ *
+ * @return Current time measurement
+ */
+static inline uint64_t
+libflush_inline_get_timing_end(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+  return x86_get_timing_end();
+#else
+  return libflush_inline_get_timing();
+#endif
+}
+
+/**
+ * Measures the time it takes to access the given address
+ *
+ * @param[in] address Address to access
+ *
+ * @return Timing measurement
+ */
+static inline uint64_t
+libflush_inline_reload_address(void* address)
+{
+  uint64_t time = libflush_inline_get_timing();
+  libflush_inline_access_memory(address);
+
+  return libflush_inline_get_timing() - time;
+}
+
+/**
+ * Measures how long it takes to prefetch the given address
+ *
+ * @param[in] address The target address.
+ *
+ * @return Timing measurement
+ */
+static inline uint64_t
+libflush_inline_prefetch_time(void* address)
+{
+  uint64_t time = libflush_inline_get_timing_start();
+  libflush_inline_prefetch(address);
+
+  return libflush_inline_get_timing_end() - time;
+}
+
+#ifdef LIBFLUSH_INLINE_HAVE_FLUSH
+/**
+ * Flushes the given address with the flush instruction of the architecture
+ *
+ * @param[in] address The address to flush
+ */
+static inline void
+libflush_inline_flush(void* address)
+{
+#if defined(__ARM_ARCH_8A__) || defined(__aarch64__)
+  arm_v8_flush(address);
+#else
+  x86_flush(address);
+#endif
+}
+
+/**
+ * Measure how long it takes to flush the given address
+ *
+ * @param[in] address The address to flush
+ *
+ * @return Timing measurement
+ */
+static inline uint64_t
+libflush_inline_flush_time(void* address)
+{
+  uint64_t time = libflush_inline_get_timing();
+  libflush_inline_flush(address);
+
+  return libflush_inline_get_timing() - time;
+}
+
+/**
+ * Measures the time it takes to access the given address. Then the address is
+ * flushed to memory.
+ *
+ * @param[in] address Address to access
+ *
+ * @return Timing measurement
+ */
+static inline uint64_t
+libflush_inline_reload_address_and_flush(void* address)
+{
+  uint64_t time = libflush_inline_get_timing_start();
+  libflush_inline_access_memory(address);
+  uint64_t delta = libflush_inline_get_timing_end() - time;
+  libflush_inline_flush(address);
+
+  return delta;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBFLUSH_INLINE_H */
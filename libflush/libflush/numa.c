@@ -0,0 +1,168 @@
+/* See LICENSE file for license and copyright information */
+
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include "numa.h"
+
+#define SYSFS_CPU_PATH "/sys/devices/system/cpu"
+#define SYSFS_NODE_PATH "/sys/devices/system/node"
+
+/* Node masks passed to the kernel have as many bits as the one of a policy */
+#define NODE_MASK_LENGTH (sizeof(((libflush_numa_policy_t*) NULL)->nodes) / sizeof(unsigned long))
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define MAXIMUM_NUMBER_OF_NODES (NODE_MASK_LENGTH * BITS_PER_LONG)
+
+#if defined(SYS_set_mempolicy) || defined(SYS_mbind)
+static void
+set_node_mask(unsigned long* nodes, unsigned int node)
+{
+  memset(nodes, 0, NODE_MASK_LENGTH * sizeof(unsigned long));
+  nodes[node / BITS_PER_LONG] = 1UL << (node % BITS_PER_LONG);
+}
+#endif
+
+/* The directory of a CPU links to the directory of its node */
+int
+libflush_numa_get_cpu_node(size_t cpu)
+{
+  char path[64];
+  snprintf(path, sizeof(path), SYSFS_CPU_PATH "/cpu%zu", cpu);
+
+  DIR* directory = opendir(path);
+  if (directory == NULL) {
+    return -1;
+  }
+
+  int node = -1;
+  struct dirent* entry;
+  while ((entry = readdir(directory)) != NULL) {
+    char* end;
+    if (strncmp(entry->d_name, "node", 4) == 0) {
+      unsigned long parsed = strtoul(entry->d_name + 4, &end, 10);
+      if (end != entry->d_name + 4 && *end == '\0' && parsed < MAXIMUM_NUMBER_OF_NODES) {
+        node = parsed;
+        break;
+      }
+    }
+  }
+
+  closedir(directory);
+
+  return node;
+}
+
+/* Node of the CPU the calling thread runs on */
+int
+libflush_numa_get_local_node(void)
+{
+  int cpu = sched_getcpu();
+
+  return (cpu < 0) ? -1 : libflush_numa_get_cpu_node(cpu);
+}
+
+bool
+libflush_numa_is_node_online(unsigned int node)
+{
+  if (node >= MAXIMUM_NUMBER_OF_NODES) {
+    return false;
+  }
+
+  char path[64];
+  snprintf(path, sizeof(path), SYSFS_NODE_PATH "/node%u", node);
+
+  struct stat status;
+  return stat(path, &status) == 0 && S_ISDIR(status.st_mode);
+}
+
+/* Node of the page of an address, which is only known once the page is
+ * present */
+int
+libflush_numa_get_address_node(void* address)
+{
+#ifdef SYS_get_mempolicy
+  int node = -1;
+  if (syscall(SYS_get_mempolicy, &node, NULL, 0, address, MPOL_F_NODE | MPOL_F_ADDR) == 0) {
+    return node;
+  }
+#else
+  (void) address;
+#endif
+
+  return -1;
+}
+
+/* Pages that the calling thread touches first are allocated on the node until
+ * the previous policy is restored */
+bool
+libflush_numa_bind_thread(unsigned int node, libflush_numa_policy_t* previous)
+{
+#if defined(SYS_get_mempolicy) && defined(SYS_set_mempolicy)
+  if (node >= MAXIMUM_NUMBER_OF_NODES) {
+    return false;
+  }
+
+  memset(previous, 0, sizeof(libflush_numa_policy_t));
+  if (syscall(SYS_get_mempolicy, &(previous->mode), previous->nodes,
+        MAXIMUM_NUMBER_OF_NODES, NULL, 0) != 0) {
+    return false;
+  }
+
+  unsigned long nodes[NODE_MASK_LENGTH];
+  set_node_mask(nodes, node);
+
+  return syscall(SYS_set_mempolicy, MPOL_BIND, nodes, MAXIMUM_NUMBER_OF_NODES) == 0;
+#else
+  (void) node;
+  (void) previous;
+  return false;
+#endif
+}
+
+void
+libflush_numa_restore_thread(const libflush_numa_policy_t* previous)
+{
+#ifdef SYS_set_mempolicy
+  // The default policy takes no nodes
+  if (previous->mode == MPOL_DEFAULT) {
+    syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+  } else {
+    syscall(SYS_set_mempolicy, previous->mode, previous->nodes, MAXIMUM_NUMBER_OF_NODES);
+  }
+#else
+  (void) previous;
+#endif
+}
+
+/* Binds the pages of a range to the node. Later faults of the range allocate
+ * on the node, and present pages that are only mapped by this process are
+ * moved there. */
+bool
+libflush_numa_bind_range(void* address, size_t length, unsigned int node)
+{
+#ifdef SYS_mbind
+  if (node >= MAXIMUM_NUMBER_OF_NODES) {
+    return false;
+  }
+
+  unsigned long nodes[NODE_MASK_LENGTH];
+  set_node_mask(nodes, node);
+
+  return syscall(SYS_mbind, address, length, MPOL_BIND, nodes, MAXIMUM_NUMBER_OF_NODES,
+      MPOL_MF_MOVE) == 0;
+#else
+  (void) address;
+  (void) length;
+  (void) node;
+  return false;
+#endif
+}
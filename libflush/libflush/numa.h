@@ -0,0 +1,24 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Memory policy of the calling thread */
+typedef struct libflush_numa_policy_s {
+  int mode;
+  unsigned long nodes[16];
+} libflush_numa_policy_t;
+
+int libflush_numa_get_cpu_node(size_t cpu);
+int libflush_numa_get_local_node(void);
+bool libflush_numa_is_node_online(unsigned int node);
+int libflush_numa_get_address_node(void* address);
+
+bool libflush_numa_bind_thread(unsigned int node, libflush_numa_policy_t* previous);
+void libflush_numa_restore_thread(const libflush_numa_policy_t* previous);
+bool libflush_numa_bind_range(void* address, size_t length, unsigned int node);
+
+#endif // NUMA_H
@@ -4,42 +4,245 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sched.h>
+#include <signal.h>
+#include <setjmp.h>
 #include <unistd.h>
 #include <inttypes.h>
+#include <time.h>
+#include <pthread.h>
 #include <sys/ioctl.h>
-#include <getopt.h>
-#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
 
 #include "libflush.h"
+#include "libflush_inline.h"
 #include "timing.h"
 #include "internal.h"
 
-#if TIME_SOURCE == TIME_SOURCE_MONOTONIC_CLOCK
-#include <time.h>
+#if defined(__ARM_ARCH_7A__)
+#include "armv7/configuration.h"
+#endif
+
+#ifndef TIME_SOURCE
+#define TIME_SOURCE TIME_SOURCE_REGISTER
+#endif
+
+#define AUTO_NUMBER_OF_SAMPLES 1000
+#define CALIBRATION_TIME_NS (10*1000*1000ULL)
+
+typedef struct time_source_s {
+  libflush_time_source_t source;
+  bool (*init)(libflush_session_t* session, libflush_session_args_t* args);
+  bool (*terminate)(libflush_session_t* session);
+  timing_function_t get_timing;
+  timing_function_t get_timing_start;
+  timing_function_t get_timing_end;
+  void (*reset_timing)(libflush_session_t* session);
+} time_source_t;
+
+static uint64_t get_monotonic_time(void);
+static const time_source_t* get_time_source(libflush_time_source_t source);
+static bool select_time_source(libflush_session_t* session, libflush_session_args_t* args,
+    const time_source_t* time_source);
+static bool select_best_time_source(libflush_session_t* session, libflush_session_args_t* args);
+
+/* Register */
+
+#if defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_8A__)
+static sigjmp_buf register_probe_buffer;
+
+static void
+register_probe_handler(int sig)
+{
+  (void) sig;
+
+  siglongjmp(register_probe_buffer, 1);
+}
+#endif
+
+static bool
+register_init(libflush_session_t* session, libflush_session_args_t* args)
+{
+  (void) session;
+  (void) args;
+
+#if defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_8A__)
+  /* Accessing the performance monitor raises SIGILL if user space access has
+   * not been enabled by the kernel */
+  struct sigaction action, old_action;
+  memset(&action, 0, sizeof(struct sigaction));
+  action.sa_handler = register_probe_handler;
+  sigaction(SIGILL, &action, &old_action);
+
+  bool available = false;
+  if (sigsetjmp(register_probe_buffer, 1) == 0) {
+#if defined(__ARM_ARCH_7A__)
+    bool div64 = CYCLE_COUNTER_DIV_64;
+    if (args != NULL && args->performance_register_div64 == true) {
+      div64 = true;
+    }
+
+    // Enable user space performance counter
+    arm_v7_timing_init(div64);
+    arm_v7_get_timing();
+#else
+    // Enable user space performance counter
+    arm_v8_timing_init();
+    arm_v8_get_timing();
+#endif
+    available = true;
+  }
+
+  sigaction(SIGILL, &old_action, NULL);
+
+  return available;
+#else
+  return true;
+#endif
+}
+
+static bool
+register_terminate(libflush_session_t* session)
+{
+  (void) session;
+
+  // Disable user space performance counter
+#if defined(__ARM_ARCH_7A__)
+  arm_v7_timing_terminate();
+#elif defined(__ARM_ARCH_8A__)
+  arm_v8_timing_terminate();
+#endif
+
+  return true;
+}
+
+static uint64_t
+register_get_timing(libflush_session_t* session)
+{
+  (void) session;
+
+  return libflush_inline_get_timing();
+}
+
+static uint64_t
+register_get_timing_start(libflush_session_t* session)
+{
+  (void) session;
+
+  return libflush_inline_get_timing_start();
+}
+
+static uint64_t
+register_get_timing_end(libflush_session_t* session)
+{
+  (void) session;
 
-uint64_t
+  return libflush_inline_get_timing_end();
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+static uint64_t
+register_get_timing_lfence(libflush_session_t* session)
+{
+  (void) session;
+
+  return x86_get_timing_lfence();
+}
+
+static uint64_t
+register_get_timing_rdtscp(libflush_session_t* session)
+{
+  (void) session;
+
+  return x86_get_timing_rdtscp();
+}
+
+static uint64_t
+register_get_timing_mfence(libflush_session_t* session)
+{
+  (void) session;
+
+  return x86_get_timing_mfence();
+}
+#endif
+
+/* Replaces the serialized start and end time stamps according to the selected
+ * fence. Only the x86 time-stamp counter offers a choice, the fence of other
+ * architectures stays the default. */
+static void
+register_select_fence(libflush_session_t* session, libflush_fence_t fence)
+{
+  (void) session;
+
+  switch (fence) {
+#if defined(__i386__) || defined(__x86_64__)
+    case LIBFLUSH_FENCE_LFENCE:
+      session->timing.get_timing_start = register_get_timing_lfence;
+      session->timing.get_timing_end = register_get_timing_lfence;
+      session->timing.fence = fence;
+      break;
+    case LIBFLUSH_FENCE_RDTSCP:
+      session->timing.get_timing_start = register_get_timing_rdtscp;
+      session->timing.get_timing_end = register_get_timing_rdtscp;
+      session->timing.fence = fence;
+      break;
+    case LIBFLUSH_FENCE_MFENCE:
+      session->timing.get_timing_start = register_get_timing_mfence;
+      session->timing.get_timing_end = register_get_timing_mfence;
+      session->timing.fence = fence;
+      break;
+#endif
+    default:
+      break;
+  }
+}
+
+static void
+register_reset_timing(libflush_session_t* session)
+{
+  (void) session;
+
+#if defined(__ARM_ARCH_7A__)
+  arm_v7_reset_timing(session->performance_register_div64);
+#elif defined(__ARM_ARCH_8A__)
+  arm_v8_reset_timing();
+#endif
+}
+
+/* Monotonic clock */
+
+static uint64_t
 get_monotonic_time(void)
 {
   struct timespec t1;
   clock_gettime(CLOCK_MONOTONIC, &t1);
   return t1.tv_sec * 1000*1000*1000ULL + t1.tv_nsec;
 }
-#endif
 
-#if TIME_SOURCE == TIME_SOURCE_PERF
-#include <assert.h>
-#include <unistd.h>
-#include <sys/syscall.h>
-#include <linux/perf_event.h>
+static uint64_t
+monotonic_clock_get_timing(libflush_session_t* session)
+{
+  (void) session;
+
+  libflush_inline_memory_barrier();
+  uint64_t result = get_monotonic_time();
+  libflush_inline_memory_barrier();
+
+  return result;
+}
 
-inline bool
+/* Perf */
+
+static bool
 perf_init(libflush_session_t* session, libflush_session_args_t* args)
 {
-  (void) session;
   (void) args;
 
-  static struct perf_event_attr attr;
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
   attr.type = PERF_TYPE_HARDWARE;
   attr.config = PERF_COUNT_HW_CPU_CYCLES;
   attr.size = sizeof(attr);
@@ -48,85 +251,235 @@ perf_init(libflush_session_t* session, libflush_session_args_t* args)
   attr.exclude_callchain_kernel = 1;
 
   session->perf.fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
-  assert(session->perf.fd >= 0 && "if this assertion fails you have no perf event interface available for the userspace. install a different kernel/rom."); // if this assertion fails you have no perf event interface available for the userspace. install a different kernel/rom.
+  if (session->perf.fd < 0) {
+    // No perf event interface available for the userspace. Install a different kernel/rom.
+    return false;
+  }
+
+#if defined(__i386__) || defined(__x86_64__)
+  /* The metadata page of the event allows to read the counter from user space
+   * with rdpmc. If the kernel does not grant this capability, every time stamp
+   * falls back to a read system call. */
+  session->perf.page_size = sysconf(_SC_PAGESIZE);
+  session->perf.page = mmap(NULL, session->perf.page_size, PROT_READ,
+      MAP_SHARED, session->perf.fd, 0);
+  if (session->perf.page == MAP_FAILED) {
+    session->perf.page = NULL;
+  } else if (session->perf.page->cap_user_rdpmc == 0) {
+    munmap(session->perf.page, session->perf.page_size);
+    session->perf.page = NULL;
+  }
+#endif
 
   return true;
 }
 
-inline bool
+static bool
 perf_terminate(libflush_session_t* session)
 {
-  close(session->perf.fd);
+  if (session->perf.page != NULL) {
+    munmap(session->perf.page, session->perf.page_size);
+  }
+  session->perf.page = NULL;
+
+  if (session->perf.fd >= 0) {
+    close(session->perf.fd);
+  }
+  session->perf.fd = -1;
 
   return true;
 }
 
-inline uint64_t
+#if defined(__i386__) || defined(__x86_64__)
+/* Reads the counter with rdpmc following the seqlock protocol described in
+ * linux/perf_event.h. Returns false if the event is currently not scheduled
+ * on a hardware counter. */
+static inline bool
+perf_read_rdpmc(struct perf_event_mmap_page* page, uint64_t* result)
+{
+  uint32_t sequence;
+  uint64_t count;
+
+  do {
+    sequence = page->lock;
+    asm volatile ("" ::: "memory");
+
+    uint32_t index = page->index;
+    if (page->cap_user_rdpmc == 0 || index == 0) {
+      return false;
+    }
+
+    /* Sign extend the counter to its width */
+    uint16_t width = page->pmc_width;
+    int64_t pmc = x86_rdpmc(index - 1);
+    pmc <<= 64 - width;
+    pmc >>= 64 - width;
+
+    count = page->offset + pmc;
+
+    asm volatile ("" ::: "memory");
+  } while (page->lock != sequence);
+
+  *result = count;
+
+  return true;
+}
+#endif
+
+static uint64_t
 perf_get_timing(libflush_session_t* session)
 {
   long long result = 0;
 
+  libflush_inline_memory_barrier();
+
+#if defined(__i386__) || defined(__x86_64__)
+  if (session->perf.page != NULL) {
+    uint64_t count;
+    if (perf_read_rdpmc(session->perf.page, &count) == true) {
+      libflush_inline_memory_barrier();
+      return count;
+    }
+  }
+#endif
+
   if (read(session->perf.fd, &result, sizeof(result)) < (ssize_t) sizeof(result)) {
     return 0;
   }
 
+  libflush_inline_memory_barrier();
+
   return result;
 }
 
-inline void
+static void
 perf_reset_timing(libflush_session_t* session)
 {
   ioctl(session->perf.fd, PERF_EVENT_IOC_RESET, 0);
 }
-#endif
 
-#if TIME_SOURCE == TIME_SOURCE_THREAD_COUNTER
+/* Thread counter
+ *
+ * All sessions share a single counting thread. The counter is kept on a
+ * cache line of its own so that readers do not false-share with anything else
+ * the writer or the sessions modify. */
+
+#define THREAD_COUNTER_LINE_LENGTH 64
+
+static struct {
+  volatile uint64_t value;
+  uint8_t padding[THREAD_COUNTER_LINE_LENGTH - sizeof(uint64_t)];
+} thread_counter_value __attribute__((aligned(THREAD_COUNTER_LINE_LENGTH)));
+
+static struct {
+  pthread_mutex_t lock;
+  size_t references;
+  pthread_t thread;
+  ssize_t cpu;
+  double ns_per_tick;
+} thread_counter_service = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .references = 0,
+  .cpu = -1,
+  .ns_per_tick = 0
+};
+
 static void* thread_counter_func(void*);
-#include <pthread.h>
 
-inline bool
+/* The counting thread is calibrated while the calling thread sleeps, so that
+ * it is not competing with the calibration for a CPU. */
+static double
+thread_counter_calibrate(void)
+{
+  struct timespec sleep_time = {
+    .tv_sec = 0,
+    .tv_nsec = CALIBRATION_TIME_NS
+  };
+
+  uint64_t start_ticks = thread_counter_value.value;
+  uint64_t start_time = get_monotonic_time();
+
+  nanosleep(&sleep_time, NULL);
+
+  uint64_t ticks = thread_counter_value.value - start_ticks;
+  uint64_t time = get_monotonic_time() - start_time;
+
+  if (ticks == 0) {
+    return 0;
+  }
+
+  return (double) time / ticks;
+}
+
+static bool
 thread_counter_init(libflush_session_t* session, libflush_session_args_t* args)
 {
   if (session == NULL) {
     return false;
   }
 
-  session->thread_counter.data.cpu = (args != NULL) ? (ssize_t) args->bind_to_cpu : -1;
-  session->thread_counter.data.session = session;
+  pthread_mutex_lock(&(thread_counter_service.lock));
 
-  if (pthread_create(&(session->thread_counter.thread), NULL,
-        thread_counter_func, &(session->thread_counter.data)) != 0) {
-    return false;
+  if (thread_counter_service.references == 0) {
+    /* The first session decides the CPU of the counting thread */
+    thread_counter_service.cpu = (args != NULL) ? (ssize_t) args->bind_to_cpu : -1;
+
+    if (pthread_create(&(thread_counter_service.thread), NULL,
+          thread_counter_func, &(thread_counter_service.cpu)) != 0) {
+      pthread_mutex_unlock(&(thread_counter_service.lock));
+      return false;
+    }
+
+    thread_counter_service.ns_per_tick = thread_counter_calibrate();
   }
 
+  thread_counter_service.references++;
+
+  pthread_mutex_unlock(&(thread_counter_service.lock));
+
+  session->timing.ns_per_tick = thread_counter_service.ns_per_tick;
+
   return true;
 }
 
-inline bool
+static bool
 thread_counter_terminate(libflush_session_t* session)
 {
   if (session == NULL) {
     return false;
   }
 
+  pthread_mutex_lock(&(thread_counter_service.lock));
+
+  if (thread_counter_service.references == 0) {
+    pthread_mutex_unlock(&(thread_counter_service.lock));
+    return false;
+  }
+
+  if (--thread_counter_service.references == 0) {
 #if __BIONIC__
-  pthread_kill(session->thread_counter.thread, SIGUSR1);
+    pthread_kill(thread_counter_service.thread, SIGUSR1);
 #else
-  pthread_cancel(session->thread_counter.thread);
+    pthread_cancel(thread_counter_service.thread);
 #endif
-  pthread_join(session->thread_counter.thread, NULL);
+    pthread_join(thread_counter_service.thread, NULL);
+  }
+
+  pthread_mutex_unlock(&(thread_counter_service.lock));
 
   return true;
 }
 
-inline uint64_t
+static uint64_t
 thread_counter_get_timing(libflush_session_t* session)
 {
-  libflush_memory_barrier(session);
+  (void) session;
+
+  libflush_inline_memory_barrier();
 
-  uint64_t time = session->thread_counter.value;
+  uint64_t time = thread_counter_value.value;
 
-  libflush_memory_barrier(session);
+  libflush_inline_memory_barrier();
 
   return time;
 }
@@ -149,16 +502,14 @@ thread_counter_func(void* data) {
 #endif
 
   /* Unpack data */
-  thread_data_t* thread_data = (thread_data_t*) data;
-  libflush_session_t* session = thread_data->session;
-  ssize_t cpu = thread_data->cpu;
+  ssize_t cpu = *((ssize_t*) data);
 
   /* Bind to CPU */
   if (cpu > 0) {
     if (libflush_bind_to_cpu(cpu) == false) {
-      fprintf(stderr, "Could not bind to CPU: %zu\n", cpu);
+      fprintf(stderr, "Could not bind to CPU: %zd\n", cpu);
     } else {
-      fprintf(stderr, "Bind thread to CPU: %zu\n", cpu);
+      fprintf(stderr, "Bind thread to CPU: %zd\n", cpu);
     }
   }
 
@@ -177,9 +528,228 @@ thread_counter_func(void* data) {
 #endif
 
   while (true) {
-    session->thread_counter.value++;
+    thread_counter_value.value++;
   }
 
   pthread_exit(NULL);
 }
-#endif
+
+/* Time source selection */
+
+static const time_source_t time_sources[] = {
+  {
+    LIBFLUSH_TIME_SOURCE_REGISTER,
+    register_init,
+    register_terminate,
+    register_get_timing,
+    register_get_timing_start,
+    register_get_timing_end,
+    register_reset_timing
+  },
+  {
+    LIBFLUSH_TIME_SOURCE_PERF,
+    perf_init,
+    perf_terminate,
+    perf_get_timing,
+    perf_get_timing,
+    perf_get_timing,
+    perf_reset_timing
+  },
+  {
+    LIBFLUSH_TIME_SOURCE_MONOTONIC_CLOCK,
+    NULL,
+    NULL,
+    monotonic_clock_get_timing,
+    monotonic_clock_get_timing,
+    monotonic_clock_get_timing,
+    NULL
+  },
+  {
+    LIBFLUSH_TIME_SOURCE_THREAD_COUNTER,
+    thread_counter_init,
+    thread_counter_terminate,
+    thread_counter_get_timing,
+    thread_counter_get_timing,
+    thread_counter_get_timing,
+    NULL
+  },
+};
+
+bool
+libflush_timing_init(libflush_session_t* session, libflush_session_args_t* args)
+{
+  if (session == NULL) {
+    return false;
+  }
+
+  session->perf.fd = -1;
+  session->perf.page = NULL;
+
+  if (args != NULL && args->fence > LIBFLUSH_FENCE_MFENCE) {
+    return false;
+  }
+
+  libflush_time_source_t source = (args != NULL) ? args->time_source :
+    LIBFLUSH_TIME_SOURCE_DEFAULT;
+  if (source == LIBFLUSH_TIME_SOURCE_DEFAULT) {
+    source = TIME_SOURCE;
+  }
+
+  if (source == LIBFLUSH_TIME_SOURCE_AUTO) {
+    return select_best_time_source(session, args);
+  }
+
+  const time_source_t* time_source = get_time_source(source);
+  if (time_source == NULL) {
+    return false;
+  }
+
+  return select_time_source(session, args, time_source);
+}
+
+bool
+libflush_timing_terminate(libflush_session_t* session)
+{
+  if (session == NULL) {
+    return false;
+  }
+
+  bool result = true;
+  if (session->timing.terminate != NULL) {
+    result = session->timing.terminate(session);
+  }
+
+  session->timing.terminate = NULL;
+
+  return result;
+}
+
+double
+libflush_timing_get_ns_per_tick(libflush_session_t* session)
+{
+  if (session == NULL) {
+    return 0;
+  }
+
+  /* Time sources that are read by the calling thread are calibrated on first
+   * use by busy waiting, as some of them (perf) only count while the thread is
+   * running. */
+  if (session->timing.ns_per_tick == 0) {
+    uint64_t start_ticks = session->timing.get_timing(session);
+    uint64_t start_time = get_monotonic_time();
+
+    uint64_t time;
+    do {
+      time = get_monotonic_time() - start_time;
+    } while (time < CALIBRATION_TIME_NS);
+
+    uint64_t ticks = session->timing.get_timing(session) - start_ticks;
+    if (ticks != 0) {
+      session->timing.ns_per_tick = (double) time / ticks;
+    }
+  }
+
+  return session->timing.ns_per_tick;
+}
+
+static const time_source_t*
+get_time_source(libflush_time_source_t source)
+{
+  for (size_t i = 0; i < sizeof(time_sources) / sizeof(time_sources[0]); i++) {
+    if (time_sources[i].source == source) {
+      return &(time_sources[i]);
+    }
+  }
+
+  return NULL;
+}
+
+static bool
+select_time_source(libflush_session_t* session, libflush_session_args_t* args,
+    const time_source_t* time_source)
+{
+  session->timing.ns_per_tick = 0;
+  if (time_source->source == LIBFLUSH_TIME_SOURCE_MONOTONIC_CLOCK) {
+    session->timing.ns_per_tick = 1;
+  }
+
+  if (time_source->init != NULL && time_source->init(session, args) == false) {
+    return false;
+  }
+
+  session->timing.source = time_source->source;
+  session->timing.get_timing = time_source->get_timing;
+  session->timing.get_timing_start = time_source->get_timing_start;
+  session->timing.get_timing_end = time_source->get_timing_end;
+  session->timing.fence = LIBFLUSH_FENCE_DEFAULT;
+  session->timing.reset_timing = time_source->reset_timing;
+  session->timing.terminate = time_source->terminate;
+
+  if (time_source->source == LIBFLUSH_TIME_SOURCE_REGISTER && args != NULL) {
+    register_select_fence(session, args->fence);
+  }
+
+  return true;
+}
+
+/* The score of a time source is the time between two distinct values it
+ * returns when being read back to back. It is bound by the overhead of reading
+ * the time source as well as its resolution. */
+static bool
+get_time_source_score(libflush_session_t* session, uint64_t* score)
+{
+  uint64_t previous = session->timing.get_timing(session);
+  size_t changes = 0;
+
+  uint64_t start = get_monotonic_time();
+  for (size_t i = 0; i < AUTO_NUMBER_OF_SAMPLES; i++) {
+    uint64_t value = session->timing.get_timing(session);
+    if (value != previous) {
+      changes++;
+    }
+    previous = value;
+  }
+  uint64_t duration = get_monotonic_time() - start;
+
+  if (changes == 0) {
+    return false;
+  }
+
+  *score = duration / changes;
+
+  return true;
+}
+
+static bool
+select_best_time_source(libflush_session_t* session, libflush_session_args_t* args)
+{
+  const time_source_t* best_time_source = NULL;
+  uint64_t best_score = UINT64_MAX;
+
+  for (size_t i = 0; i < sizeof(time_sources) / sizeof(time_sources[0]); i++) {
+    // The thread counter occupies a CPU and is calibrated for every session
+    // that starts it, so it is only scored if no other time source works
+    if (time_sources[i].source == LIBFLUSH_TIME_SOURCE_THREAD_COUNTER &&
+        best_time_source != NULL) {
+      continue;
+    }
+
+    if (select_time_source(session, args, &(time_sources[i])) == false) {
+      continue;
+    }
+
+    uint64_t score;
+    if (get_time_source_score(session, &score) == true && score < best_score) {
+      best_score = score;
+      best_time_source = &(time_sources[i]);
+    }
+
+    libflush_timing_terminate(session);
+  }
+
+  if (best_time_source == NULL) {
+    return false;
+  }
+
+  return select_time_source(session, args, best_time_source);
+}
@@ -7,28 +7,14 @@
 
 #include "libflush.h"
 
-#define TIME_SOURCE_REGISTER 1
-#define TIME_SOURCE_PERF 2
-#define TIME_SOURCE_MONOTONIC_CLOCK 3
-#define TIME_SOURCE_THREAD_COUNTER  4
-
-#if TIME_SOURCE == TIME_SOURCE_MONOTONIC_CLOCK
-uint64_t get_monotonic_time(void);
-#endif
-
-#if TIME_SOURCE == TIME_SOURCE_PERF
-bool perf_init(libflush_session_t* session, libflush_session_args_t* args);
-bool perf_terminate(libflush_session_t* session);
-uint64_t perf_get_timing(libflush_session_t* session);
-uint64_t perf_get_timing_start(libflush_session_t* session);
-uint64_t perf_get_timing_end(libflush_session_t* session);
-void perf_reset_timing(libflush_session_t* session);
-#endif
-
-#if TIME_SOURCE == TIME_SOURCE_THREAD_COUNTER
-bool thread_counter_init(libflush_session_t* session, libflush_session_args_t* args);
-uint64_t thread_counter_get_timing(libflush_session_t* session);
-bool thread_counter_terminate(libflush_session_t* session);
-#endif
+#define TIME_SOURCE_REGISTER        LIBFLUSH_TIME_SOURCE_REGISTER
+#define TIME_SOURCE_PERF            LIBFLUSH_TIME_SOURCE_PERF
+#define TIME_SOURCE_MONOTONIC_CLOCK LIBFLUSH_TIME_SOURCE_MONOTONIC_CLOCK
+#define TIME_SOURCE_THREAD_COUNTER  LIBFLUSH_TIME_SOURCE_THREAD_COUNTER
+#define TIME_SOURCE_AUTO            LIBFLUSH_TIME_SOURCE_AUTO
+
+bool libflush_timing_init(libflush_session_t* session, libflush_session_args_t* args);
+bool libflush_timing_terminate(libflush_session_t* session);
+double libflush_timing_get_ns_per_tick(libflush_session_t* session);
 
 #endif // TIMING_H
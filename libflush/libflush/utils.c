@@ -6,6 +6,7 @@
 #endif
 
 #include "libflush.h"
+#include "numa.h"
 
 #if ANDROID_PLATFORM < 21
 #include <sys/syscall.h>
@@ -43,3 +44,15 @@ libflush_bind_to_cpu(size_t cpu)
     return true;
   }
 }
+
+int
+libflush_get_cpu_node(size_t cpu)
+{
+  return libflush_numa_get_cpu_node(cpu);
+}
+
+int
+libflush_get_address_node(void* address)
+{
+  return libflush_numa_get_address_node(address);
+}
@@ -0,0 +1,62 @@
+/* See LICENSE file for license and copyright information */
+
+#ifndef X86_CACHE_H
+#define X86_CACHE_H
+
+#include <stddef.h>
+#include <cpuid.h>
+
+#include "../libflush.h"
+
+#define X86_CPUID_CACHE_PARAMETERS 4
+#define X86_CPUID_AMD_CACHE_PARAMETERS 0x8000001d
+
+/* Enumerates the caches of a leaf of deterministic cache parameters */
+static inline size_t
+x86_cache_get_leaf_geometry(unsigned int leaf, libflush_cache_geometry_t* caches,
+    size_t number_of_caches)
+{
+  if (__get_cpuid_max(leaf & 0x80000000, NULL) < leaf) {
+    return 0;
+  }
+
+  size_t count = 0;
+  while (count < number_of_caches) {
+    unsigned int eax, ebx, ecx, edx;
+    __cpuid_count(leaf, count, eax, ebx, ecx, edx);
+
+    unsigned int type = eax & 0x1f;
+    if (type == 0) {
+      break;
+    }
+
+    libflush_cache_geometry_t* cache = &(caches[count++]);
+    cache->level = (eax >> 5) & 0x7;
+    cache->type = (libflush_cache_type_t) type;
+    cache->line_length = (ebx & 0xfff) + 1;
+    cache->associativity = ((ebx >> 22) & 0x3ff) + 1;
+    cache->number_of_sets = (size_t) ecx + 1;
+    cache->size = cache->line_length * (((ebx >> 12) & 0x3ff) + 1) *
+      cache->associativity * cache->number_of_sets;
+    cache->number_of_sharing_cpus = ((eax >> 14) & 0xfff) + 1;
+  }
+
+  return count;
+}
+
+/* Enumerates the caches with CPUID, which Intel describes in leaf 4 and AMD in
+ * leaf 0x8000001d. Returns the number of caches. */
+static inline size_t
+x86_cache_get_geometry(libflush_cache_geometry_t* caches, size_t number_of_caches)
+{
+  size_t count = x86_cache_get_leaf_geometry(X86_CPUID_CACHE_PARAMETERS, caches,
+      number_of_caches);
+  if (count == 0) {
+    count = x86_cache_get_leaf_geometry(X86_CPUID_AMD_CACHE_PARAMETERS, caches,
+        number_of_caches);
+  }
+
+  return count;
+}
+
+#endif /* X86_CACHE_H */
@@ -3,7 +3,15 @@
 #ifndef X86_FLUSH_H
 #define X86_FLUSH_H
 
-extern inline void x86_flush(void* address)
+#include <stdbool.h>
+#include <stddef.h>
+#include <cpuid.h>
+
+#define X86_CPUID_CLFLUSH_LINE_SIZE(ebx) ((((ebx) >> 8) & 0xff) * 8)
+#define X86_CPUID_CLFLUSHOPT (1 << 23)
+#define X86_CPUID_CLWB (1 << 24)
+
+static inline void x86_flush(void* address)
 {
   asm volatile ("clflush 0(%0)"
     :
@@ -12,4 +20,43 @@ extern inline void x86_flush(void* address)
   );
 }
 
+static inline void x86_flushopt(void* address)
+{
+  asm volatile ("clflushopt 0(%0)"
+    :
+    : "r" (address)
+    : "memory"
+  );
+}
+
+static inline void x86_clwb(void* address)
+{
+  asm volatile ("clwb 0(%0)"
+    :
+    : "r" (address)
+    : "memory"
+  );
+}
+
+/* Queries the supported flush instructions and the flush line size */
+static inline void x86_flush_get_features(bool* clflushopt, bool* clwb,
+    size_t* line_length)
+{
+  unsigned int eax, ebx, ecx, edx;
+
+  *clflushopt = false;
+  *clwb = false;
+
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 &&
+      X86_CPUID_CLFLUSH_LINE_SIZE(ebx) != 0) {
+    *line_length = X86_CPUID_CLFLUSH_LINE_SIZE(ebx);
+  }
+
+  if (__get_cpuid_max(0, NULL) >= 7) {
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    *clflushopt = (ebx & X86_CPUID_CLFLUSHOPT) != 0;
+    *clwb = (ebx & X86_CPUID_CLWB) != 0;
+  }
+}
+
 #endif /* X86_FLUSH_H */
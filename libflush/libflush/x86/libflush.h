@@ -6,5 +6,6 @@
 #include "flush.h"
 #include "timing.h"
 #include "memory.h"
+#include "cache.h"
 
 #endif /* X86_LIBFLUSH_H */
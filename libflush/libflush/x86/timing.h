@@ -7,7 +7,7 @@
 
 #include "memory.h"
 
-extern inline uint64_t
+static inline uint64_t
 x86_get_timing(void)
 {
   uint64_t result = 0;
@@ -19,7 +19,7 @@ x86_get_timing(void)
   return result;
 }
 
-extern inline uint64_t
+static inline uint64_t
 x86_get_timing_start(void)
 {
   uint64_t result = 0;
@@ -40,7 +40,7 @@ x86_get_timing_start(void)
   return result;
 }
 
-extern inline  uint64_t
+static inline  uint64_t
 x86_get_timing_end(void)
 {
   uint64_t result = 0;
@@ -62,4 +62,72 @@ x86_get_timing_end(void)
   return result;
 }
 
+/* Serialized with LFENCE, which only waits for preceding instructions to
+ * complete locally and does not cause a VM exit like CPUID. */
+static inline uint64_t
+x86_get_timing_lfence(void)
+{
+  uint64_t result = 0;
+  uint64_t d = 0;
+
+  asm volatile ("lfence\n\t"
+    "rdtsc\n\t"
+    "lfence\n\t"
+    : "=a" (result), "=d" (d));
+
+  result = (d << 32) | result;
+
+  return result;
+}
+
+/* RDTSCP waits for preceding instructions, the LFENCE keeps succeeding
+ * instructions from starting early. */
+static inline uint64_t
+x86_get_timing_rdtscp(void)
+{
+  uint64_t result = 0;
+  uint64_t d = 0;
+
+  asm volatile ("rdtscp\n\t"
+    "lfence\n\t"
+    : "=a" (result), "=d" (d)
+    :
+    : "%rcx");
+
+  result = (d << 32) | result;
+
+  return result;
+}
+
+/* As LFENCE, but additionally waits for preceding stores to become globally
+ * visible. */
+static inline uint64_t
+x86_get_timing_mfence(void)
+{
+  uint64_t result = 0;
+  uint64_t d = 0;
+
+  asm volatile ("mfence\n\t"
+    "lfence\n\t"
+    "rdtsc\n\t"
+    "lfence\n\t"
+    : "=a" (result), "=d" (d));
+
+  result = (d << 32) | result;
+
+  return result;
+}
+
+static inline uint64_t
+x86_rdpmc(uint32_t counter)
+{
+  uint64_t result = 0;
+  uint64_t d = 0;
+
+  asm volatile ("rdpmc" : "=a" (result), "=d" (d) : "c" (counter));
+  result = (d << 32) | result;
+
+  return result;
+}
+
 #endif  /*X86_TIMING_H*/
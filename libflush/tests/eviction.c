@@ -1,6 +1,16 @@
 /* See LICENSE file for license and copyright information */
 
+#define _GNU_SOURCE
+
 #include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
 
 #include <libflush.h>
 #include <eviction/eviction.h>
@@ -28,7 +38,658 @@ START_TEST(test_eviction_terminate) {
   fail_unless(libflush_eviction_terminate(NULL) == false);
 } END_TEST
 
+static const libflush_eviction_pages_t eviction_pages[] = {
+  LIBFLUSH_EVICTION_PAGES_DEFAULT,
+  LIBFLUSH_EVICTION_PAGES_SMALL,
+  LIBFLUSH_EVICTION_PAGES_HUGE,
+  LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE
+};
+
+START_TEST(test_eviction_pages) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pages = eviction_pages[_i];
+
+  fail_unless(libflush_init(&session, &args) == true);
+
+  /* Huge pages fall back to smaller ones */
+  libflush_eviction_pages_t pages = libflush_get_eviction_pages(session);
+  fail_unless(pages != LIBFLUSH_EVICTION_PAGES_DEFAULT);
+  if (args.eviction_pages == LIBFLUSH_EVICTION_PAGES_DEFAULT ||
+      args.eviction_pages == LIBFLUSH_EVICTION_PAGES_SMALL) {
+    fail_unless(pages == LIBFLUSH_EVICTION_PAGES_SMALL);
+  } else if (args.eviction_pages == LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE) {
+    fail_unless(pages != LIBFLUSH_EVICTION_PAGES_HUGE);
+  }
+
+  /* Set indices of huge pages are known without the pagemap. A pool of small
+   * pages then has no eviction sets, which leaves the calls without effect. */
+  for (size_t i = 0; i < 64; i++) {
+    libflush_prime(session, i);
+    libflush_probe(session, i);
+  }
+  libflush_evict(session, &args);
+
+#if HAVE_PAGEMAP_ACCESS == 0
+  if (pages == LIBFLUSH_EVICTION_PAGES_SMALL) {
+    fail_unless(libflush_prime_all(session, 1) == false);
+  }
+
+  /* Addresses are not translated whatever the pages of the pool are */
+  void* address = &args;
+  fail_unless(libflush_evict_strategy(session, &args, NULL) == false);
+  fail_unless(libflush_prepare_eviction_sets(session, &address, 1) == false);
+#endif
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_eviction_pages_invalid) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_TRANSPARENT_HUGE + 1;
+
+  fail_unless(libflush_init(&session, &args) == false);
+  fail_unless(session == NULL);
+} END_TEST
+
+START_TEST(test_eviction_node) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+
+  /* The pool is local if the system reports the node of the CPU */
+  int node = libflush_get_cpu_node(sched_getcpu());
+  fail_unless(libflush_init(&session, &args) == true);
+  fail_unless(node == -1 || libflush_get_eviction_node(session) >= 0);
+  fail_unless(libflush_terminate(session) == true);
+
+  args.eviction_node = LIBFLUSH_EVICTION_NODE_ANY;
+  fail_unless(libflush_init(&session, &args) == true);
+  fail_unless(libflush_get_eviction_node(session) == -1);
+  fail_unless(libflush_terminate(session) == true);
+
+  if (node >= 0) {
+    args.eviction_node = LIBFLUSH_EVICTION_NODE_FIXED;
+    args.eviction_node_id = node;
+    fail_unless(libflush_init(&session, &args) == true);
+    fail_unless(libflush_get_eviction_node(session) == node);
+    fail_unless(libflush_terminate(session) == true);
+  }
+} END_TEST
+
+START_TEST(test_eviction_node_invalid) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+
+  args.eviction_node = LIBFLUSH_EVICTION_NODE_FIXED;
+  args.eviction_node_id = 1 << 20;
+  fail_unless(libflush_init(&session, &args) == false);
+  fail_unless(session == NULL);
+
+  args.eviction_node = LIBFLUSH_EVICTION_NODE_FIXED + 1;
+  fail_unless(libflush_init(&session, &args) == false);
+  fail_unless(session == NULL);
+
+  fail_unless(libflush_get_eviction_node(NULL) == -1);
+} END_TEST
+
+START_TEST(test_eviction_population_invalid) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_population = LIBFLUSH_EVICTION_POPULATION_INCREMENTAL + 1;
+
+  fail_unless(libflush_init(&session, &args) == false);
+  fail_unless(session == NULL);
+
+  /* The set indices of an incremental pool cannot be kept in a profile */
+  args.eviction_population = LIBFLUSH_EVICTION_POPULATION_INCREMENTAL;
+  args.eviction_profile_file = "/tmp/libflush-profile-incremental";
+  fail_unless(libflush_init(&session, &args) == false);
+  fail_unless(session == NULL);
+} END_TEST
+
+START_TEST(test_eviction_pool_file_invalid) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pool_file = "/nonexistent/libflush-pool";
+
+  fail_unless(libflush_init(&session, &args) == false);
+  fail_unless(session == NULL);
+} END_TEST
+
+static const libflush_eviction_access_t eviction_accesses[] = {
+  LIBFLUSH_EVICTION_ACCESS_ARRAY,
+  LIBFLUSH_EVICTION_ACCESS_CHAIN,
+  LIBFLUSH_EVICTION_ACCESS_RANDOM_CHAIN
+};
+
+START_TEST(test_eviction_sweep) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+  args.eviction_access = eviction_accesses[_i];
+  fail_unless(libflush_init(&session, &args) == true);
+
+  /* Every set is probed once */
+  size_t number_of_sets = libflush_get_number_of_sets(session);
+  uint64_t* times = calloc(number_of_sets, sizeof(uint64_t));
+  fail_unless(times != NULL);
+
+  fail_unless(libflush_prime_all(session, number_of_sets) == true);
+  fail_unless(libflush_probe_all(session, times, number_of_sets) == true);
+  for (size_t i = 0; i < number_of_sets; i++) {
+    fail_unless(times[i] > 0);
+  }
+
+  size_t set_indices[] = { 3, 1, 2, 1000 };
+  uint64_t set_times[4] = { 0 };
+  fail_unless(libflush_prime_sets(session, set_indices, 4) == true);
+  fail_unless(libflush_probe_sets(session, set_indices, 4, set_times) == true);
+  for (size_t i = 0; i < 4; i++) {
+    fail_unless(set_times[i] > 0);
+  }
+
+  free(times);
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_eviction_sweep_invalid) {
+  size_t number_of_sets = libflush_get_number_of_sets(libflush_session);
+  uint64_t times[1];
+
+  fail_unless(libflush_prime_all(libflush_session, number_of_sets + 1) == false);
+  fail_unless(libflush_probe_all(libflush_session, times, number_of_sets + 1) == false);
+
+  size_t set_indices[] = { number_of_sets };
+  fail_unless(libflush_prime_sets(libflush_session, set_indices, 1) == false);
+  fail_unless(libflush_probe_sets(libflush_session, set_indices, 1, times) == false);
+  fail_unless(libflush_prime_sets(libflush_session, NULL, 1) == false);
+  fail_unless(libflush_probe_sets(libflush_session, NULL, 1, times) == false);
+} END_TEST
+
+START_TEST(test_eviction_strategy) {
+  libflush_eviction_strategy_t strategy;
+  libflush_get_eviction_strategy(libflush_session, &strategy);
+  fail_unless(strategy.eviction_counter > 0);
+  fail_unless(strategy.step_size > 0);
+
+  libflush_eviction_strategy_t custom = { 10, 2, 2, 0, true };
+  fail_unless(libflush_set_eviction_strategy(libflush_session, &custom) == true);
+  libflush_get_eviction_strategy(libflush_session, &strategy);
+  fail_unless(strategy.eviction_counter == 10);
+  fail_unless(strategy.number_of_accesses_in_loop == 2);
+  fail_unless(strategy.different_addresses_in_loop == 2);
+  fail_unless(strategy.step_size == 1);
+  fail_unless(strategy.mirroring == true);
+
+  /* Strategy of the device configuration */
+  fail_unless(libflush_set_eviction_strategy(libflush_session, NULL) == true);
+  libflush_eviction_strategy_t configured;
+  libflush_get_eviction_strategy(libflush_session, &configured);
+  fail_unless(configured.eviction_counter > 0);
+} END_TEST
+
+START_TEST(test_eviction_strategy_invalid) {
+  libflush_eviction_strategy_t before;
+  libflush_get_eviction_strategy(libflush_session, &before);
+
+  libflush_eviction_strategy_t no_accesses = { 10, 0, 2, 1, false };
+  fail_unless(libflush_set_eviction_strategy(libflush_session, &no_accesses) == false);
+
+  libflush_eviction_strategy_t no_addresses = { 10, 2, 0, 1, false };
+  fail_unless(libflush_set_eviction_strategy(libflush_session, &no_addresses) == false);
+
+  /* More addresses than the pool holds per set */
+  libflush_eviction_strategy_t too_large = { 1000 * 1000, 1, 1, 1, false };
+  fail_unless(libflush_set_eviction_strategy(libflush_session, &too_large) == false);
+
+  libflush_eviction_strategy_t after;
+  libflush_get_eviction_strategy(libflush_session, &after);
+  fail_unless(after.eviction_counter == before.eviction_counter);
+
+  int x;
+  fail_unless(libflush_evict_strategy(libflush_session, &x, &too_large) == false);
+
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_strategy = too_large;
+  fail_unless(libflush_init(&session, &args) == false);
+  fail_unless(session == NULL);
+} END_TEST
+
+/* The pages of the pool are not spread evenly over the sets, so a strategy as
+ * large as the average set leaves some sets short. Those fail instead of
+ * aborting, which sets fail depends on the pool and is not asserted. */
+START_TEST(test_eviction_strategy_short_sets) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_SMALL;
+  args.eviction_strategy = (libflush_eviction_strategy_t) {
+    PHYSICAL_MEMORY_MAPPED_LINES_PER_SET, 1, 1, 1, false };
+  fail_unless(libflush_init(&session, &args) == true);
+
+  size_t number_of_sets = libflush_get_number_of_sets(session);
+  for (size_t i = 0; i < number_of_sets; i++) {
+    uint64_t time = 0;
+    if (libflush_prime_sets(session, &i, 1) == true) {
+      fail_unless(libflush_probe_sets(session, &i, 1, &time) == true);
+      fail_unless(time > 0);
+    }
+  }
+
+  int x;
+  libflush_evict(session, &x);
+  libflush_prime_all(session, number_of_sets);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+/* Discovery only relies on timing, so it does not depend on the pagemap. Its
+ * success depends on the noise of the system and is not asserted. */
+static uint8_t discovery_target[4096] __attribute__((aligned(4096)));
+
+static bool
+abort_discovery(const libflush_discovery_result_t* result, void* data)
+{
+  (void) result;
+  (*(size_t*) data)++;
+  return false;
+}
+
+/* Returns a level below the last one whose sets are not indexed by the page
+ * offset alone, so its set indices are looked up in the virtual address cache
+ * (0: none) */
+static unsigned int
+get_cached_level(void)
+{
+  libflush_cache_geometry_t caches[8];
+  size_t number_of_caches = libflush_get_cache_geometry(libflush_session, caches, 8);
+  if (number_of_caches > 8) {
+    number_of_caches = 8;
+  }
+
+  unsigned int last_level = 0;
+  for (size_t i = 0; i < number_of_caches; i++) {
+    if (caches[i].level > last_level) {
+      last_level = caches[i].level;
+    }
+  }
+
+  for (size_t i = 0; i < number_of_caches; i++) {
+    size_t number_of_sets = libflush_get_level_number_of_sets(libflush_session,
+        caches[i].level);
+    if (caches[i].level != last_level && number_of_sets * caches[i].line_length > 4096) {
+      return caches[i].level;
+    }
+  }
+
+  return 0;
+}
+
+START_TEST(test_eviction_discover) {
+  void* target = discovery_target + 64 * _i;
+
+  libflush_discovery_result_t result = { 0 };
+  if (libflush_discover_eviction_set(libflush_session, target, NULL, &result) == true) {
+    fail_unless(result.number_of_attempts >= 1);
+    fail_unless(result.threshold > 0);
+
+    /* The discovered set is used instead of searching the pool, and a line
+     * with a discovered set has no set index within the levels */
+    unsigned int level = get_cached_level();
+    size_t set_index;
+    fail_unless(level == 0 || libflush_get_level_set_index(libflush_session, target, level,
+          &set_index) == false);
+    fail_unless(libflush_evict_strategy(libflush_session, target, NULL) == true);
+
+#if HAVE_PAGEMAP_ACCESS == 1
+    /* The set stays pinned while the lines of other addresses push the
+     * virtual address cache beyond its capacity */
+    size_t number_of_lines = 4 * ADDRESS_CACHE_MAX_SIZE;
+    uint8_t* buffer = malloc(number_of_lines * 64);
+    fail_unless(buffer != NULL);
+    for (size_t i = 0; level != 0 && i < number_of_lines; i++) {
+      libflush_get_level_set_index(libflush_session, buffer + i * 64, level, &set_index);
+    }
+    free(buffer);
+#endif
+
+    fail_unless(level == 0 || libflush_get_level_set_index(libflush_session, target, level,
+          &set_index) == false);
+    fail_unless(libflush_evict_strategy(libflush_session, target, NULL) == true);
+
+    /* Discovering it again replaces the set */
+    libflush_discover_eviction_set(libflush_session, target, NULL, NULL);
+    libflush_eviction_evict(libflush_session, target);
+  }
+  fail_unless(result.duration > 0);
+} END_TEST
+
+START_TEST(test_eviction_discover_abort) {
+  size_t calls = 0;
+
+  libflush_discovery_args_t args = { 0 };
+  args.progress = abort_discovery;
+  args.progress_data = &calls;
+
+  libflush_discovery_result_t result = { 0 };
+  fail_unless(libflush_discover_eviction_set(libflush_session, discovery_target, &args,
+        &result) == false);
+  fail_unless(calls <= 1);
+  fail_unless(result.number_of_addresses == 0);
+
+  /* The time budget is exceeded before the first reduction step */
+  memset(&args, 0, sizeof(args));
+  args.time_budget = 1;
+  fail_unless(libflush_discover_eviction_set(libflush_session, discovery_target, &args,
+        &result) == false);
+  fail_unless(result.number_of_addresses == 0);
+} END_TEST
+
+START_TEST(test_eviction_discover_invalid) {
+  fail_unless(libflush_discover_eviction_set(NULL, discovery_target, NULL, NULL) == false);
+  fail_unless(libflush_discover_eviction_set(libflush_session, NULL, NULL, NULL) == false);
+
+  /* Pointer chasing is not supported */
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_access = LIBFLUSH_EVICTION_ACCESS_CHAIN;
+  fail_unless(libflush_init(&session, &args) == true);
+  fail_unless(libflush_discover_eviction_set(session, discovery_target, NULL, NULL) == false);
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
 #if HAVE_PAGEMAP_ACCESS == 1
+/* Unrolled variants, the generic loop, step sizes and mirroring */
+static const libflush_eviction_strategy_t eviction_strategies[] = {
+  { 12, 1, 2, 1, false },
+  { 10, 2, 2, 1, true },
+  { 21, 2, 5, 1, false },
+  { 28, 5, 4, 1, false },
+  { 20, 3, 3, 2, false },
+  { 20, 3, 3, 3, true },
+  { 20, 2, 2, 3, true },
+};
+
+START_TEST(test_eviction_evict_strategy) {
+  const libflush_eviction_strategy_t* strategy = &(eviction_strategies[_i]);
+
+  /* Huge pages provide the same number of lines for every set */
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+  fail_unless(libflush_init(&session, &args) == true);
+
+  int x;
+  fail_unless(libflush_evict_strategy(session, &x, strategy) == true);
+
+  fail_unless(libflush_set_eviction_strategy(session, strategy) == true);
+  libflush_eviction_evict(session, &x);
+  libflush_prime(session, 1);
+  libflush_probe(session, 1);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_eviction_jit) {
+  const libflush_eviction_strategy_t* strategy = &(eviction_strategies[_i]);
+
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+  args.eviction_strategy = *strategy;
+  args.eviction_jit = true;
+
+#if defined(__x86_64__)
+  fail_unless(libflush_init(&session, &args) == true);
+#else
+  fail_unless(libflush_init(&session, &args) == false);
+  return;
+#endif
+
+  int x;
+  libflush_eviction_evict(session, &x);
+  libflush_eviction_evict(session, &x);
+  libflush_prime(session, 1);
+  libflush_probe(session, 1);
+
+  /* Strategies of single calls are not compiled */
+  fail_unless(libflush_evict_strategy(session, &x, &(eviction_strategies[0])) == true);
+
+  /* Routines are compiled again for a new strategy */
+  fail_unless(libflush_set_eviction_strategy(session, NULL) == true);
+  libflush_eviction_evict(session, &x);
+  libflush_prime(session, 1);
+  libflush_probe(session, 1);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+static const libflush_eviction_access_t eviction_chains[] = {
+  LIBFLUSH_EVICTION_ACCESS_CHAIN,
+  LIBFLUSH_EVICTION_ACCESS_RANDOM_CHAIN
+};
+
+START_TEST(test_eviction_chain) {
+  size_t number_of_strategies = sizeof(eviction_strategies) / sizeof(eviction_strategies[0]);
+  const libflush_eviction_strategy_t* strategy = &(eviction_strategies[_i % number_of_strategies]);
+
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_pages = LIBFLUSH_EVICTION_PAGES_HUGE;
+  args.eviction_strategy = *strategy;
+  args.eviction_access = eviction_chains[_i / number_of_strategies];
+  fail_unless(libflush_init(&session, &args) == true);
+
+  int x;
+  libflush_eviction_evict(session, &x);
+  libflush_prime(session, 1);
+  libflush_probe(session, 1);
+
+  /* A larger eviction set is linked again */
+  libflush_eviction_strategy_t larger = *strategy;
+  larger.eviction_counter += 8;
+  fail_unless(libflush_evict_strategy(session, &x, &larger) == true);
+  libflush_eviction_evict(session, &x);
+  libflush_prime(session, 1);
+  libflush_probe(session, 1);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_eviction_chain_invalid) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_access = LIBFLUSH_EVICTION_ACCESS_RANDOM_CHAIN + 1;
+  fail_unless(libflush_init(&session, &args) == false);
+
+  /* Compiled routines only implement the array access */
+  args.eviction_access = LIBFLUSH_EVICTION_ACCESS_CHAIN;
+  args.eviction_jit = true;
+  fail_unless(libflush_init(&session, &args) == false);
+} END_TEST
+
+static const size_t slice_counts[] = { 2, 4, 8 };
+
+START_TEST(test_eviction_slice) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.slice_hash = LIBFLUSH_SLICE_HASH_INTEL;
+  args.number_of_slices = slice_counts[_i];
+  fail_unless(libflush_init(&session, &args) == true);
+
+  /* All slices have the same power of two of sets */
+  fail_unless(libflush_get_number_of_slices(session) == slice_counts[_i]);
+  size_t sets_per_slice = libflush_get_number_of_sets(session) / slice_counts[_i];
+  fail_unless(libflush_get_number_of_sets(session) == sets_per_slice * slice_counts[_i]);
+  fail_unless(sets_per_slice > 0 && (sets_per_slice & (sets_per_slice - 1)) == 0);
+
+  int x;
+  fail_unless(libflush_get_set_index(session, &x) < libflush_get_number_of_sets(session));
+  libflush_eviction_evict(session, &x);
+
+  /* Sets of the first, second and last slice */
+  size_t set_indices[] = { 0, sets_per_slice, libflush_get_number_of_sets(session) - 1 };
+  uint64_t times[3] = { 0 };
+  fail_unless(libflush_prime_sets(session, set_indices, 3) == true);
+  fail_unless(libflush_probe_sets(session, set_indices, 3, times) == true);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+static bool
+write_slice_hash_file(char* path, const char* content)
+{
+  int fd = mkstemp(path);
+  if (fd == -1) {
+    return false;
+  }
+
+  size_t length = strlen(content);
+  bool written = (write(fd, content, length) == (ssize_t) length);
+  close(fd);
+
+  return written;
+}
+
+START_TEST(test_eviction_slice_file) {
+  static const char* contents[] = {
+    "# Two slices\nxor 0x1b5f575440\n",
+    "table 0 1 1 0\ntable 1 0 0 1\n"
+  };
+
+  char path[] = "/tmp/libflush-slice-XXXXXX";
+  fail_unless(write_slice_hash_file(path, contents[_i]) == true);
+
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.slice_hash = LIBFLUSH_SLICE_HASH_FILE;
+  args.slice_hash_file = path;
+  fail_unless(libflush_init(&session, &args) == true);
+  unlink(path);
+
+  fail_unless(libflush_get_number_of_slices(session) == 2);
+
+  int x;
+  libflush_eviction_evict(session, &x);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_eviction_slice_invalid) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.slice_hash = LIBFLUSH_SLICE_HASH_INTEL;
+  args.number_of_slices = 3;
+  fail_unless(libflush_init(&session, &args) == false);
+
+  args.number_of_slices = 16;
+  fail_unless(libflush_init(&session, &args) == false);
+
+  args.slice_hash = LIBFLUSH_SLICE_HASH_FILE + 1;
+  args.number_of_slices = 0;
+  fail_unless(libflush_init(&session, &args) == false);
+
+  args.slice_hash = LIBFLUSH_SLICE_HASH_FILE;
+  args.slice_hash_file = NULL;
+  fail_unless(libflush_init(&session, &args) == false);
+
+  args.slice_hash_file = "/nonexistent/slice-hash";
+  fail_unless(libflush_init(&session, &args) == false);
+
+  /* Functions and a table at once, a table of three lines, unknown keywords
+   * and a number of slices that differs from the file */
+  static const struct {
+    const char* content;
+    size_t number_of_slices;
+  } files[] = {
+    { "xor 0x1b5f575440\ntable 0 1\n", 0 },
+    { "table 0 1 1\n", 0 },
+    { "and 0x1b5f575440\n", 0 },
+    { "xor 0x1b5f575440\n", 4 }
+  };
+
+  for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+    char path[] = "/tmp/libflush-slice-XXXXXX";
+    fail_unless(write_slice_hash_file(path, files[i].content) == true);
+
+    args.slice_hash_file = path;
+    args.number_of_slices = files[i].number_of_slices;
+    fail_unless(libflush_init(&session, &args) == false);
+    unlink(path);
+  }
+} END_TEST
+
+/* The pool is backed by a memfd that outlives the sessions */
+static bool
+init_profile_session(libflush_session_t** session, int pool, const char* profile)
+{
+  char pool_file[64];
+  snprintf(pool_file, sizeof(pool_file), "/proc/self/fd/%d", pool);
+
+  libflush_session_args_t args = { 0 };
+  args.eviction_pool_file = (pool >= 0) ? pool_file : NULL;
+  args.eviction_profile_file = profile;
+
+  return libflush_init(session, &args);
+}
+
+START_TEST(test_eviction_profile) {
+  int pool = memfd_create("pool", 0);
+  fail_unless(pool >= 0);
+
+  char profile[] = "/tmp/libflush-profile-XXXXXX";
+  int fd = mkstemp(profile);
+  fail_unless(fd >= 0);
+  close(fd);
+  unlink(profile);
+
+  /* The first session computes the set indices and writes the profile */
+  libflush_session_t* session;
+  int x;
+  fail_unless(init_profile_session(&session, pool, profile) == true);
+  fail_unless(libflush_get_eviction_profile_state(session) == LIBFLUSH_EVICTION_PROFILE_MISSING);
+  libflush_eviction_evict(session, &x);
+  fail_unless(libflush_terminate(session) == true);
+  fail_unless(access(profile, F_OK) == 0);
+
+  /* Later sessions with the same pool reuse them */
+  fail_unless(init_profile_session(&session, pool, profile) == true);
+  fail_unless(libflush_get_eviction_profile_state(session) == LIBFLUSH_EVICTION_PROFILE_LOADED);
+  libflush_eviction_evict(session, &x);
+  libflush_prime(session, 1);
+  fail_unless(libflush_terminate(session) == true);
+
+  /* A corrupt profile is replaced */
+  fd = open(profile, O_WRONLY | O_TRUNC);
+  fail_unless(fd >= 0);
+  fail_unless(write(fd, "LIBFLPRF", 8) == 8);
+  close(fd);
+  fail_unless(init_profile_session(&session, pool, profile) == true);
+  fail_unless(libflush_get_eviction_profile_state(session) == LIBFLUSH_EVICTION_PROFILE_INVALID);
+  libflush_eviction_evict(session, &x);
+  fail_unless(libflush_terminate(session) == true);
+
+  fail_unless(init_profile_session(&session, pool, profile) == true);
+  fail_unless(libflush_get_eviction_profile_state(session) == LIBFLUSH_EVICTION_PROFILE_LOADED);
+  fail_unless(libflush_terminate(session) == true);
+
+  /* Another pool is backed by other physical pages */
+  fail_unless(init_profile_session(&session, -1, profile) == true);
+  fail_unless(libflush_get_eviction_profile_state(session) == LIBFLUSH_EVICTION_PROFILE_INVALID);
+  fail_unless(libflush_terminate(session) == true);
+
+  unlink(profile);
+  close(pool);
+} END_TEST
+
+START_TEST(test_eviction_profile_none) {
+  libflush_session_t* session;
+  fail_unless(init_profile_session(&session, -1, NULL) == true);
+  fail_unless(libflush_get_eviction_profile_state(session) == LIBFLUSH_EVICTION_PROFILE_NONE);
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
 START_TEST(test_eviction_evict) {
   int x;
   libflush_eviction_evict(libflush_session, &x);
@@ -54,6 +715,202 @@ START_TEST(test_eviction_evict_exhaust) {
     libflush_eviction_evict(libflush_session, &(addresses[i]));
   }
 } END_TEST
+
+START_TEST(test_eviction_evict_replace) {
+  /* Distinct lines for several rounds of the replacement once the address
+   * cache has reached its maximal size. All pages alias the same physical page
+   * to keep the number of eviction sets small. */
+  size_t number_of_pages = 4 * ADDRESS_CACHE_MAX_SIZE * 64 / 4096;
+  size_t size = number_of_pages * 4096;
+
+  int fd = memfd_create("eviction", 0);
+  fail_unless(fd >= 0);
+  fail_unless(ftruncate(fd, 4096) == 0);
+
+  uint8_t* lines = mmap(NULL, size, PROT_NONE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  fail_unless(lines != MAP_FAILED);
+  for (size_t i = 0; i < number_of_pages; i++) {
+    fail_unless(mmap(lines + i * 4096, 4096, PROT_READ | PROT_WRITE,
+          MAP_FIXED | MAP_POPULATE | MAP_SHARED, fd, 0) != MAP_FAILED);
+  }
+  close(fd);
+
+  for (size_t i = 0; i < size; i += 64) {
+    libflush_eviction_evict(libflush_session, lines + i);
+  }
+
+  for (size_t i = 0; i < size; i += 64 * 1024) {
+    libflush_eviction_evict(libflush_session, lines + i);
+  }
+
+  munmap(lines, size);
+} END_TEST
+
+START_TEST(test_eviction_prepare) {
+  int x[64];
+  void* addresses[] = { &(x[0]), &(x[16]), &(x[32]), &(x[48]) };
+  size_t n = sizeof(addresses) / sizeof(addresses[0]);
+
+  /* Addresses are not ready before they have been prepared */
+  fail_unless(libflush_eviction_sets_ready(libflush_session, addresses, n) == false);
+
+  fail_unless(libflush_prepare_eviction_sets(libflush_session, addresses, n) == true);
+  libflush_wait_eviction_sets(libflush_session);
+  fail_unless(libflush_eviction_sets_ready(libflush_session, addresses, n) == true);
+
+  for (size_t i = 0; i < n; i++) {
+    libflush_eviction_evict(libflush_session, addresses[i]);
+  }
+} END_TEST
+
+START_TEST(test_eviction_prepare_all) {
+  fail_unless(libflush_prepare_eviction_sets(libflush_session, NULL, 0) == true);
+  libflush_wait_eviction_sets(libflush_session);
+  fail_unless(libflush_eviction_sets_ready(libflush_session, NULL, 0) == true);
+} END_TEST
+
+START_TEST(test_eviction_prepare_terminate) {
+  /* The session is terminated while the sets are built */
+  libflush_session_t* session;
+  fail_unless(libflush_init(&session, NULL) == true);
+  fail_unless(libflush_prepare_eviction_sets(session, NULL, 0) == true);
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_eviction_prepare_invalid) {
+  int x;
+  void* address = &x;
+
+  fail_unless(libflush_prepare_eviction_sets(NULL, &address, 1) == false);
+  fail_unless(libflush_eviction_sets_ready(NULL, &address, 1) == false);
+  libflush_wait_eviction_sets(NULL);
+} END_TEST
+
+static const libflush_eviction_population_t eviction_populations[] = {
+  LIBFLUSH_EVICTION_POPULATION_DEFAULT,
+  LIBFLUSH_EVICTION_POPULATION_SERIAL,
+  LIBFLUSH_EVICTION_POPULATION_PARALLEL,
+  LIBFLUSH_EVICTION_POPULATION_INCREMENTAL
+};
+
+START_TEST(test_eviction_population) {
+  libflush_session_t* session;
+  libflush_session_args_t args = { 0 };
+  args.eviction_population = eviction_populations[_i / 2];
+  args.eviction_touch = (_i % 2 == 1);
+
+  fail_unless(libflush_init(&session, &args) == true);
+
+  int x;
+  libflush_evict(session, &x);
+  libflush_evict(session, &x);
+
+  /* An incremental pool is populated until every set has enough lines */
+  size_t number_of_sets = libflush_get_number_of_sets(session);
+  fail_unless(libflush_prime_all(session, number_of_sets) == true);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_eviction_level) {
+  libflush_cache_geometry_t caches[8];
+  size_t number_of_caches = libflush_get_cache_geometry(libflush_session, caches, 8);
+  if (number_of_caches > 8) {
+    number_of_caches = 8;
+  }
+
+  int x;
+  for (size_t i = 0; i < number_of_caches; i++) {
+    size_t number_of_sets = libflush_get_level_number_of_sets(libflush_session,
+        caches[i].level);
+    if (number_of_sets == 0) {
+      fail_unless(libflush_evict_level(libflush_session, &x, caches[i].level) == false);
+      continue;
+    }
+
+    fail_unless(libflush_evict_level(libflush_session, &x, caches[i].level) == true);
+    fail_unless(libflush_evict_level(libflush_session, &x, caches[i].level) == true);
+
+    size_t set_index;
+    fail_unless(libflush_get_level_set_index(libflush_session, &x, caches[i].level,
+          &set_index) == true);
+    fail_unless(set_index < number_of_sets);
+
+    uint64_t time;
+    fail_unless(libflush_prime_level(libflush_session, set_index, caches[i].level) == true);
+    fail_unless(libflush_probe_level(libflush_session, set_index, caches[i].level,
+          &time) == true);
+    fail_unless(libflush_prime_level(libflush_session, number_of_sets - 1,
+          caches[i].level) == true);
+    fail_unless(libflush_prime_level(libflush_session, number_of_sets,
+          caches[i].level) == false);
+    fail_unless(libflush_probe_level(libflush_session, number_of_sets, caches[i].level,
+          &time) == false);
+  }
+} END_TEST
+
+START_TEST(test_eviction_level_strategy) {
+  libflush_cache_geometry_t caches[8];
+  size_t number_of_caches = libflush_get_cache_geometry(libflush_session, caches, 8);
+  if (number_of_caches > 8) {
+    number_of_caches = 8;
+  }
+
+  int x;
+  for (size_t i = 0; i < number_of_caches; i++) {
+    libflush_eviction_strategy_t strategy;
+    if (libflush_get_level_eviction_strategy(libflush_session, caches[i].level,
+          &strategy) == false) {
+      continue;
+    }
+
+    /* A larger set extends the previous one */
+    libflush_eviction_strategy_t larger = strategy;
+    larger.eviction_counter = strategy.eviction_counter + 4;
+    fail_unless(libflush_set_level_eviction_strategy(libflush_session, caches[i].level,
+          &larger) == true);
+    fail_unless(libflush_evict_level(libflush_session, &x, caches[i].level) == true);
+
+    libflush_eviction_strategy_t invalid = strategy;
+    invalid.number_of_accesses_in_loop = 0;
+    fail_unless(libflush_set_level_eviction_strategy(libflush_session, caches[i].level,
+          &invalid) == false);
+
+    libflush_eviction_strategy_t current;
+    fail_unless(libflush_get_level_eviction_strategy(libflush_session, caches[i].level,
+          &current) == true);
+    fail_unless(current.eviction_counter == larger.eviction_counter);
+
+    /* Default strategy of the level */
+    fail_unless(libflush_set_level_eviction_strategy(libflush_session, caches[i].level,
+          NULL) == true);
+    fail_unless(libflush_get_level_eviction_strategy(libflush_session, caches[i].level,
+          &current) == true);
+    fail_unless(current.eviction_counter == strategy.eviction_counter);
+  }
+} END_TEST
+
+START_TEST(test_eviction_level_invalid) {
+  int x;
+  size_t set_index;
+  uint64_t time;
+  libflush_eviction_strategy_t strategy;
+
+  fail_unless(libflush_evict_level(libflush_session, &x, 0) == false);
+  fail_unless(libflush_evict_level(libflush_session, &x, 99) == false);
+  fail_unless(libflush_prime_level(libflush_session, 0, 99) == false);
+  fail_unless(libflush_probe_level(libflush_session, 0, 99, &time) == false);
+  fail_unless(libflush_get_level_set_index(libflush_session, &x, 99, &set_index) == false);
+  fail_unless(libflush_get_level_number_of_sets(libflush_session, 99) == 0);
+  fail_unless(libflush_set_level_eviction_strategy(libflush_session, 99, NULL) == false);
+  fail_unless(libflush_get_level_eviction_strategy(libflush_session, 99, &strategy) == false);
+
+  fail_unless(libflush_evict_level(NULL, &x, 1) == false);
+  fail_unless(libflush_prime_level(NULL, 0, 1) == false);
+  fail_unless(libflush_probe_level(NULL, 0, 1, &time) == false);
+  fail_unless(libflush_get_level_set_index(NULL, &x, 1, &set_index) == false);
+  fail_unless(libflush_get_level_number_of_sets(NULL, 1) == 0);
+} END_TEST
 #endif
 
 Suite*
@@ -68,6 +925,74 @@ suite_eviction(void)
   tcase_add_test(tcase, test_eviction_terminate);
   suite_add_tcase(suite, tcase);
 
+  tcase = tcase_create("strategy");
+  tcase_add_checked_fixture(tcase, setup_session, teardown_session);
+  tcase_add_test(tcase, test_eviction_strategy);
+  tcase_add_test(tcase, test_eviction_strategy_invalid);
+  tcase_add_test(tcase, test_eviction_strategy_short_sets);
+  suite_add_tcase(suite, tcase);
+
+#if HAVE_PAGEMAP_ACCESS == 1
+  tcase = tcase_create("strategy_evict");
+  tcase_add_loop_test(tcase, test_eviction_evict_strategy, 0,
+      sizeof(eviction_strategies) / sizeof(eviction_strategies[0]));
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("jit");
+  tcase_add_loop_test(tcase, test_eviction_jit, 0,
+      sizeof(eviction_strategies) / sizeof(eviction_strategies[0]));
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("chain");
+  tcase_add_loop_test(tcase, test_eviction_chain, 0,
+      sizeof(eviction_strategies) / sizeof(eviction_strategies[0]) *
+      sizeof(eviction_chains) / sizeof(eviction_chains[0]));
+  tcase_add_test(tcase, test_eviction_chain_invalid);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("slice");
+  tcase_add_loop_test(tcase, test_eviction_slice, 0,
+      sizeof(slice_counts) / sizeof(slice_counts[0]));
+  tcase_add_loop_test(tcase, test_eviction_slice_file, 0, 2);
+  tcase_add_test(tcase, test_eviction_slice_invalid);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("profile");
+  tcase_add_test(tcase, test_eviction_profile);
+  tcase_add_test(tcase, test_eviction_profile_none);
+  suite_add_tcase(suite, tcase);
+#endif
+
+  tcase = tcase_create("discover");
+  tcase_add_checked_fixture(tcase, setup_session, teardown_session);
+  tcase_add_loop_test(tcase, test_eviction_discover, 0, 2);
+  tcase_add_test(tcase, test_eviction_discover_abort);
+  tcase_add_test(tcase, test_eviction_discover_invalid);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("sweep");
+  tcase_add_loop_test(tcase, test_eviction_sweep, 0,
+      sizeof(eviction_accesses) / sizeof(eviction_accesses[0]));
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("sweep_invalid");
+  tcase_add_checked_fixture(tcase, setup_session, teardown_session);
+  tcase_add_test(tcase, test_eviction_sweep_invalid);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("pages");
+  tcase_add_loop_test(tcase, test_eviction_pages, 0,
+      sizeof(eviction_pages) / sizeof(eviction_pages[0]));
+  tcase_add_test(tcase, test_eviction_pages_invalid);
+  tcase_add_test(tcase, test_eviction_pool_file_invalid);
+  tcase_add_test(tcase, test_eviction_population_invalid);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("node");
+  tcase_add_test(tcase, test_eviction_node);
+  tcase_add_test(tcase, test_eviction_node_invalid);
+  suite_add_tcase(suite, tcase);
+
 #if HAVE_PAGEMAP_ACCESS == 1
   tcase = tcase_create("evict");
   tcase_add_checked_fixture(tcase, setup_session, teardown_session);
@@ -75,6 +1000,27 @@ suite_eviction(void)
   tcase_add_test(tcase, test_eviction_evict_cached);
   tcase_add_test(tcase, test_eviction_evict_two);
   tcase_add_test(tcase, test_eviction_evict_exhaust);
+  tcase_add_test(tcase, test_eviction_evict_replace);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("prepare");
+  tcase_add_checked_fixture(tcase, setup_session, teardown_session);
+  tcase_add_test(tcase, test_eviction_prepare);
+  tcase_add_test(tcase, test_eviction_prepare_all);
+  tcase_add_test(tcase, test_eviction_prepare_terminate);
+  tcase_add_test(tcase, test_eviction_prepare_invalid);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("population");
+  tcase_add_loop_test(tcase, test_eviction_population, 0,
+      2 * sizeof(eviction_populations) / sizeof(eviction_populations[0]));
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("level");
+  tcase_add_checked_fixture(tcase, setup_session, teardown_session);
+  tcase_add_test(tcase, test_eviction_level);
+  tcase_add_test(tcase, test_eviction_level_strategy);
+  tcase_add_test(tcase, test_eviction_level_invalid);
   suite_add_tcase(suite, tcase);
 #endif
 
@@ -1,8 +1,10 @@
 /* See LICENSE file for license and copyright information */
 
 #include <check.h>
+#include <stdlib.h>
 
 #include <libflush.h>
+#include <libflush_inline.h>
 
 libflush_session_t* libflush_session;
 
@@ -16,6 +18,57 @@ static void teardown_session(void) {
   libflush_session = NULL;
 }
 
+/* The batches measure every address of a round with the same timer, so the
+ * median reload of flushed or evicted lines exceeds the one of cached lines */
+#define BATCH_ROUNDS 1000
+
+static int
+compare_timings(const void* a, const void* b)
+{
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
+
+  return (x > y) - (x < y);
+}
+
+static uint64_t
+median_timing(uint64_t* timings, size_t number_of_timings)
+{
+  qsort(timings, number_of_timings, sizeof(uint64_t), compare_timings);
+
+  return timings[number_of_timings / 2];
+}
+
+typedef void (*batch_function_t)(libflush_session_t* session, void** addresses,
+    size_t number_of_addresses, uint64_t* timings);
+
+/* Median reload of lines that the given batch has removed from the cache and
+ * of lines that the batch of plain reloads has just cached */
+static void
+measure_batch(batch_function_t batch, uint64_t* removed, uint64_t* cached)
+{
+  static uint64_t x[2 * 8];
+  void* addresses[2] = { &x[0], &x[8] };
+  uint64_t timings[2];
+  uint64_t* removed_timings = calloc(2 * BATCH_ROUNDS, sizeof(uint64_t));
+  uint64_t* cached_timings = calloc(2 * BATCH_ROUNDS, sizeof(uint64_t));
+  fail_unless(removed_timings != NULL && cached_timings != NULL);
+
+  for (size_t i = 0; i < BATCH_ROUNDS; i++) {
+    libflush_reload_batch(libflush_session, addresses, 2, timings);
+    libflush_reload_batch(libflush_session, addresses, 2, cached_timings + 2 * i);
+
+    batch(libflush_session, addresses, 2, timings);
+    batch(libflush_session, addresses, 2, removed_timings + 2 * i);
+  }
+
+  *removed = median_timing(removed_timings, 2 * BATCH_ROUNDS);
+  *cached = median_timing(cached_timings, 2 * BATCH_ROUNDS);
+
+  free(removed_timings);
+  free(cached_timings);
+}
+
 START_TEST(test_flush) {
   int x;
   libflush_flush(libflush_session, &x);
@@ -26,6 +79,14 @@ START_TEST(test_flush_time) {
   libflush_flush_time(libflush_session, &x);
 } END_TEST
 
+START_TEST(test_flush_time_batch) {
+  int x[2];
+  void* addresses[2] = { &x[0], &x[1] };
+  uint64_t timings[2] = { 0 };
+  libflush_flush_time_batch(libflush_session, addresses, 2, timings);
+  libflush_flush_time_batch(libflush_session, addresses, 0, NULL);
+} END_TEST
+
 #if HAVE_PAGEMAP_ACCESS == 1
 START_TEST(test_evict) {
   int x;
@@ -55,17 +116,100 @@ START_TEST(test_reload_address_and_flush) {
   libflush_reload_address_and_flush(libflush_session, &x);
 } END_TEST
 
+START_TEST(test_reload_batch) {
+  int x[2];
+  void* addresses[2] = { &x[0], &x[1] };
+  uint64_t timings[2] = { 0 };
+  libflush_reload_batch(libflush_session, addresses, 2, timings);
+  libflush_reload_batch(libflush_session, addresses, 0, NULL);
+} END_TEST
+
+START_TEST(test_reload_and_flush_batch) {
+  int x[2];
+  void* addresses[2] = { &x[0], &x[1] };
+  uint64_t timings[2] = { 0 };
+  libflush_reload_and_flush_batch(libflush_session, addresses, 2, timings);
+  libflush_reload_and_flush_batch(libflush_session, addresses, 0, NULL);
+
+  uint64_t flushed, cached;
+  measure_batch(libflush_reload_and_flush_batch, &flushed, &cached);
+  fail_unless(flushed > cached);
+} END_TEST
+
 #if HAVE_PAGEMAP_ACCESS == 1
 START_TEST(test_reload_address_and_evict) {
   int x;
   libflush_reload_address_and_evict(libflush_session, &x);
 } END_TEST
+
+START_TEST(test_reload_and_evict_batch) {
+  int x[2];
+  void* addresses[2] = { &x[0], &x[1] };
+  uint64_t timings[2] = { 0 };
+  libflush_reload_and_evict_batch(libflush_session, addresses, 2, timings);
+
+  uint64_t evicted, cached;
+  measure_batch(libflush_reload_and_evict_batch, &evicted, &cached);
+  fail_unless(evicted > cached);
+} END_TEST
 #endif
 
+START_TEST(test_flush_range) {
+  static char buffer[4096];
+
+  libflush_flush_range(libflush_session, buffer, sizeof(buffer));
+  libflush_flush_range(libflush_session, buffer + 1, 1);
+  libflush_flush_range(libflush_session, buffer, 0);
+} END_TEST
+
+START_TEST(test_flush_instruction) {
+  static char buffer[4096];
+
+  libflush_session_args_t args = { 0 };
+  args.flush_instruction = (libflush_flush_instruction_t) _i;
+
+  libflush_session_t* session = NULL;
+  /* Not every instruction is available on every CPU */
+  if (libflush_init(&session, &args) == false) {
+    fail_unless(session == NULL);
+    return;
+  }
+
+  libflush_flush(session, buffer);
+  libflush_reload_address_and_flush(session, buffer);
+  libflush_flush_range(session, buffer, sizeof(buffer));
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_flush_instruction_invalid) {
+  libflush_session_args_t args = { 0 };
+  args.flush_instruction = (libflush_flush_instruction_t) 99;
+
+  libflush_session_t* session = NULL;
+  fail_unless(libflush_init(&session, &args) == false);
+} END_TEST
+
 START_TEST(test_memory_barrier) {
   libflush_memory_barrier();
 } END_TEST
 
+START_TEST(test_inline_reload_address) {
+  int x;
+  libflush_inline_access_memory(&x);
+  libflush_inline_reload_address(&x);
+  libflush_inline_prefetch_time(&x);
+} END_TEST
+
+#ifdef LIBFLUSH_INLINE_HAVE_FLUSH
+START_TEST(test_inline_reload_address_and_flush) {
+  int x;
+  libflush_inline_flush(&x);
+  libflush_inline_flush_time(&x);
+  libflush_inline_reload_address_and_flush(&x);
+} END_TEST
+#endif
+
 Suite*
 suite_memory(void)
 {
@@ -76,6 +220,14 @@ suite_memory(void)
   tcase_add_checked_fixture(tcase, setup_session, teardown_session);
   tcase_add_test(tcase, test_flush);
   tcase_add_test(tcase, test_flush_time);
+  tcase_add_test(tcase, test_flush_time_batch);
+  tcase_add_test(tcase, test_flush_range);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("flush-instruction");
+  tcase_add_loop_test(tcase, test_flush_instruction, LIBFLUSH_FLUSH_INSTRUCTION_DEFAULT,
+      LIBFLUSH_FLUSH_INSTRUCTION_CLWB + 1);
+  tcase_add_test(tcase, test_flush_instruction_invalid);
   suite_add_tcase(suite, tcase);
 
 #if HAVE_PAGEMAP_ACCESS == 1
@@ -95,8 +247,11 @@ suite_memory(void)
   tcase_add_checked_fixture(tcase, setup_session, teardown_session);
   tcase_add_test(tcase, test_reload_address);
   tcase_add_test(tcase, test_reload_address_and_flush);
+  tcase_add_test(tcase, test_reload_batch);
+  tcase_add_test(tcase, test_reload_and_flush_batch);
 #if HAVE_PAGEMAP_ACCESS == 1
   tcase_add_test(tcase, test_reload_address_and_evict);
+  tcase_add_test(tcase, test_reload_and_evict_batch);
 #endif
   suite_add_tcase(suite, tcase);
 
@@ -105,5 +260,13 @@ suite_memory(void)
   tcase_add_test(tcase, test_memory_barrier);
   suite_add_tcase(suite, tcase);
 
+  tcase = tcase_create("inline");
+  tcase_add_checked_fixture(tcase, setup_session, teardown_session);
+  tcase_add_test(tcase, test_inline_reload_address);
+#ifdef LIBFLUSH_INLINE_HAVE_FLUSH
+  tcase_add_test(tcase, test_inline_reload_address_and_flush);
+#endif
+  suite_add_tcase(suite, tcase);
+
   return suite;
 }
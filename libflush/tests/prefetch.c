@@ -26,6 +26,13 @@ START_TEST(test_prefetch_time) {
   libflush_prefetch_time(libflush_session, &x);
 } END_TEST
 
+START_TEST(test_prefetch_time_batch) {
+  int x[2];
+  void* addresses[2] = { &x[0], &x[1] };
+  uint64_t timings[2] = { 0 };
+  libflush_prefetch_time_batch(libflush_session, addresses, 2, timings);
+} END_TEST
+
 Suite*
 suite_prefetch(void)
 {
@@ -36,6 +43,7 @@ suite_prefetch(void)
   tcase_add_checked_fixture(tcase, setup_session, teardown_session);
   tcase_add_test(tcase, test_prefetch);
   tcase_add_test(tcase, test_prefetch_time);
+  tcase_add_test(tcase, test_prefetch_time_batch);
   suite_add_tcase(suite, tcase);
 
   return suite;
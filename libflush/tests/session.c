@@ -46,6 +46,35 @@ START_TEST(test_session_terminate) {
   fail_unless(libflush_terminate(libflush_session) == true);
 } END_TEST
 
+START_TEST(test_session_cache_geometry) {
+  libflush_session_t* libflush_session;
+  fail_unless(libflush_init(&libflush_session, NULL) == true);
+
+  /* The number of caches is returned without storing them */
+  size_t number_of_caches = libflush_get_cache_geometry(libflush_session, NULL, 0);
+  fail_unless(number_of_caches <= 8);
+
+  libflush_cache_geometry_t caches[8];
+  fail_unless(libflush_get_cache_geometry(libflush_session, caches, 8) == number_of_caches);
+
+  /* Caches are ordered by level and consistent */
+  for (size_t i = 0; i < number_of_caches; i++) {
+    fail_unless(caches[i].level >= 1);
+    fail_unless(i == 0 || caches[i].level >= caches[i - 1].level);
+    fail_unless(caches[i].type >= LIBFLUSH_CACHE_TYPE_DATA &&
+        caches[i].type <= LIBFLUSH_CACHE_TYPE_UNIFIED);
+    fail_unless(caches[i].line_length > 0 && caches[i].number_of_sets > 0 &&
+        caches[i].associativity > 0 && caches[i].number_of_sharing_cpus > 0);
+    fail_unless(caches[i].size >= caches[i].line_length * caches[i].number_of_sets *
+        caches[i].associativity);
+  }
+
+  fail_unless(libflush_terminate(libflush_session) == true);
+
+  /* Invalid arguments */
+  fail_unless(libflush_get_cache_geometry(NULL, caches, 8) == 0);
+} END_TEST
+
 Suite*
 suite_session(void)
 {
@@ -55,6 +84,7 @@ suite_session(void)
   tcase = tcase_create("basic");
   tcase_add_test(tcase, test_session_init);
   tcase_add_test(tcase, test_session_terminate);
+  tcase_add_test(tcase, test_session_cache_geometry);
   suite_add_tcase(suite, tcase);
 
   return suite;
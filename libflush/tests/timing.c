@@ -1,6 +1,7 @@
 /* See LICENSE file for license and copyright information */
 
 #include <check.h>
+#include <sched.h>
 
 #include <libflush.h>
 
@@ -24,6 +25,194 @@ START_TEST(test_reset_timing) {
   libflush_reset_timing(libflush_session);
 } END_TEST
 
+START_TEST(test_get_time_source) {
+  libflush_time_source_t source = libflush_get_time_source(libflush_session);
+  fail_unless(source != LIBFLUSH_TIME_SOURCE_DEFAULT);
+  fail_unless(source != LIBFLUSH_TIME_SOURCE_AUTO);
+} END_TEST
+
+START_TEST(test_time_source) {
+  static const libflush_time_source_t sources[] = {
+    LIBFLUSH_TIME_SOURCE_REGISTER,
+    LIBFLUSH_TIME_SOURCE_PERF,
+    LIBFLUSH_TIME_SOURCE_MONOTONIC_CLOCK,
+    LIBFLUSH_TIME_SOURCE_THREAD_COUNTER
+  };
+
+  libflush_session_args_t args = { 0 };
+  args.time_source = sources[_i];
+
+  libflush_session_t* session = NULL;
+  /* Not every time source is available on every system */
+  if (libflush_init(&session, &args) == false) {
+    fail_unless(session == NULL);
+    return;
+  }
+
+  fail_unless(libflush_get_time_source(session) == sources[_i]);
+  libflush_reset_timing(session);
+  libflush_get_timing(session);
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_time_source_perf) {
+  libflush_session_args_t args = { 0 };
+  args.time_source = LIBFLUSH_TIME_SOURCE_PERF;
+
+  libflush_session_t* session = NULL;
+  /* Perf might be disabled by the kernel */
+  if (libflush_init(&session, &args) == false) {
+    return;
+  }
+
+  libflush_reset_timing(session);
+
+  uint64_t previous = libflush_get_timing(session);
+  for (unsigned int i = 0; i < 1000; i++) {
+    uint64_t value = libflush_get_timing(session);
+    fail_unless(value >= previous);
+    previous = value;
+  }
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_thread_counter_shared) {
+  libflush_session_args_t args = { 0 };
+  args.time_source = LIBFLUSH_TIME_SOURCE_THREAD_COUNTER;
+
+  libflush_session_t* first = NULL;
+  libflush_session_t* second = NULL;
+  fail_unless(libflush_init(&first, &args) == true);
+  fail_unless(libflush_init(&second, &args) == true);
+
+  /* Both sessions read the same counter */
+  uint64_t value = libflush_get_timing(first);
+  fail_unless(libflush_get_timing(second) >= value);
+
+  /* The counter keeps running as long as a session uses it */
+  fail_unless(libflush_terminate(first) == true);
+  value = libflush_get_timing(second);
+  while (libflush_get_timing(second) == value) {
+    sched_yield();
+  }
+
+  fail_unless(libflush_terminate(second) == true);
+} END_TEST
+
+START_TEST(test_timing_to_ns) {
+  libflush_session_args_t args = { 0 };
+  args.time_source = LIBFLUSH_TIME_SOURCE_MONOTONIC_CLOCK;
+
+  libflush_session_t* session = NULL;
+  fail_unless(libflush_init(&session, &args) == true);
+  fail_unless(libflush_timing_to_ns(session, 1000) == 1000);
+  fail_unless(libflush_terminate(session) == true);
+
+  args.time_source = LIBFLUSH_TIME_SOURCE_THREAD_COUNTER;
+  fail_unless(libflush_init(&session, &args) == true);
+  fail_unless(libflush_timing_to_ns(session, 1000*1000*1000ULL) > 0);
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_calibrate_overhead) {
+  fail_unless(libflush_calibrate_overhead(libflush_session) == true);
+  fail_unless(libflush_calibrate_overhead(NULL) == false);
+  fail_unless(libflush_get_overhead(libflush_session, (libflush_overhead_t) 99) == 0);
+} END_TEST
+
+static uint64_t
+get_median_reload_time(libflush_session_t* session, void* address)
+{
+  uint64_t values[101];
+  size_t n = sizeof(values) / sizeof(values[0]);
+
+  for (size_t i = 0; i < n; i++) {
+    values[i] = libflush_reload_address(session, address);
+  }
+
+  /* Insertion sort */
+  for (size_t i = 1; i < n; i++) {
+    for (size_t j = i; j > 0 && values[j - 1] > values[j]; j--) {
+      uint64_t tmp = values[j];
+      values[j] = values[j - 1];
+      values[j - 1] = tmp;
+    }
+  }
+
+  return values[n / 2];
+}
+
+START_TEST(test_subtract_overhead) {
+  static size_t value = 0;
+
+  uint64_t overhead = libflush_get_overhead(libflush_session, LIBFLUSH_OVERHEAD_TIMING);
+  if (overhead == 0) {
+    return;
+  }
+
+  libflush_set_overhead_subtraction(libflush_session, false);
+  uint64_t raw = get_median_reload_time(libflush_session, &value);
+
+  libflush_set_overhead_subtraction(libflush_session, true);
+  uint64_t corrected = get_median_reload_time(libflush_session, &value);
+
+  libflush_set_overhead_subtraction(libflush_session, false);
+
+  fail_unless(corrected < raw);
+} END_TEST
+
+START_TEST(test_fence) {
+  static size_t value = 0;
+
+  libflush_session_args_t args = { 0 };
+  args.time_source = LIBFLUSH_TIME_SOURCE_REGISTER;
+  args.fence = (libflush_fence_t) _i;
+
+  libflush_session_t* session = NULL;
+  fail_unless(libflush_init(&session, &args) == true);
+
+  libflush_access_memory(&value);
+  libflush_reload_address_and_flush(session, &value);
+  libflush_prefetch_time(session, &value);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_fence_invalid) {
+  libflush_session_args_t args = { 0 };
+  args.fence = (libflush_fence_t) 99;
+
+  libflush_session_t* session = NULL;
+  fail_unless(libflush_init(&session, &args) == false);
+} END_TEST
+
+START_TEST(test_time_source_auto) {
+  libflush_session_args_t args = { 0 };
+  args.time_source = LIBFLUSH_TIME_SOURCE_AUTO;
+
+  libflush_session_t* session = NULL;
+  fail_unless(libflush_init(&session, &args) == true);
+
+  libflush_time_source_t source = libflush_get_time_source(session);
+  fail_unless(source != LIBFLUSH_TIME_SOURCE_DEFAULT);
+  fail_unless(source != LIBFLUSH_TIME_SOURCE_AUTO);
+
+  /* The monotonic clock is always available, so the thread counter is not
+   * started */
+  fail_unless(source != LIBFLUSH_TIME_SOURCE_THREAD_COUNTER);
+
+  fail_unless(libflush_terminate(session) == true);
+} END_TEST
+
+START_TEST(test_time_source_invalid) {
+  libflush_session_args_t args = { 0 };
+  args.time_source = (libflush_time_source_t) 99;
+
+  libflush_session_t* session = NULL;
+  fail_unless(libflush_init(&session, &args) == false);
+} END_TEST
+
 Suite*
 suite_timing(void)
 {
@@ -34,6 +223,27 @@ suite_timing(void)
   tcase_add_checked_fixture(tcase, setup_session, teardown_session);
   tcase_add_test(tcase, test_get_timing);
   tcase_add_test(tcase, test_reset_timing);
+  tcase_add_test(tcase, test_get_time_source);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("overhead");
+  tcase_add_checked_fixture(tcase, setup_session, teardown_session);
+  tcase_add_test(tcase, test_calibrate_overhead);
+  tcase_add_test(tcase, test_subtract_overhead);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("time-source");
+  tcase_add_loop_test(tcase, test_time_source, 0, 4);
+  tcase_add_test(tcase, test_time_source_perf);
+  tcase_add_test(tcase, test_thread_counter_shared);
+  tcase_add_test(tcase, test_timing_to_ns);
+  tcase_add_test(tcase, test_time_source_auto);
+  tcase_add_test(tcase, test_time_source_invalid);
+  suite_add_tcase(suite, tcase);
+
+  tcase = tcase_create("fence");
+  tcase_add_loop_test(tcase, test_fence, LIBFLUSH_FENCE_DEFAULT, LIBFLUSH_FENCE_MFENCE + 1);
+  tcase_add_test(tcase, test_fence_invalid);
   suite_add_tcase(suite, tcase);
 
   return suite;
@@ -7,6 +7,7 @@
 
 #include <check.h>
 #include <signal.h>
+#include <sys/mman.h>
 
 #include <libflush.h>
 
@@ -40,12 +41,68 @@ START_TEST(test_get_pagemap_entry) {
   int x;
   libflush_get_pagemap_entry(libflush_session, (uintptr_t) &x);
 } END_TEST
+
+#define NUMBER_OF_PAGES 16
+
+START_TEST(test_translate_range) {
+  uint8_t* buffer = mmap(NULL, NUMBER_OF_PAGES * 4096, PROT_READ | PROT_WRITE,
+      MAP_POPULATE | MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  fail_unless(buffer != MAP_FAILED);
+
+  uint64_t page_frame_numbers[NUMBER_OF_PAGES];
+  fail_unless(libflush_translate_range(libflush_session, (uintptr_t) buffer,
+        NUMBER_OF_PAGES, page_frame_numbers) == true);
+
+  /* Cached and uncached translations agree */
+  for (unsigned int i = 0; i < NUMBER_OF_PAGES; i++) {
+    uintptr_t virtual_address = (uintptr_t) buffer + i * 4096 + 64;
+    uintptr_t physical_address = libflush_get_physical_address(libflush_session, virtual_address);
+    fail_unless(physical_address == ((page_frame_numbers[i] * 4096) | 64));
+  }
+
+  fail_unless(libflush_translate_range(libflush_session, (uintptr_t) buffer, 0, NULL) == true);
+  fail_unless(libflush_translate_range(libflush_session, (uintptr_t) buffer, 1, NULL) == false);
+
+  munmap(buffer, NUMBER_OF_PAGES * 4096);
+} END_TEST
+
+START_TEST(test_invalidate_translations) {
+  uint8_t* buffer = mmap(NULL, NUMBER_OF_PAGES * 4096, PROT_READ | PROT_WRITE,
+      MAP_POPULATE | MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+  fail_unless(buffer != MAP_FAILED);
+
+  libflush_get_physical_address(libflush_session, (uintptr_t) buffer);
+
+  /* Replace the mapping */
+  fail_unless(mmap(buffer, NUMBER_OF_PAGES * 4096, PROT_READ | PROT_WRITE,
+      MAP_POPULATE | MAP_ANONYMOUS | MAP_PRIVATE | MAP_FIXED, -1, 0) == buffer);
+  libflush_invalidate_translations(libflush_session, buffer, NUMBER_OF_PAGES * 4096);
+
+  uintptr_t physical_address = libflush_get_physical_address(libflush_session, (uintptr_t) buffer);
+  fail_unless(physical_address == libflush_get_pagemap_entry(libflush_session,
+        (uintptr_t) buffer) % (1ULL << 55) * 4096);
+
+  libflush_invalidate_translations(libflush_session, NULL, 0);
+
+  munmap(buffer, NUMBER_OF_PAGES * 4096);
+} END_TEST
 #endif
 
 START_TEST(test_bind_to_cpu) {
   libflush_bind_to_cpu(0);
 } END_TEST
 
+START_TEST(test_get_node) {
+  /* Nodes are only known on systems that report them */
+  fail_unless(libflush_get_cpu_node(0) >= -1);
+  fail_unless(libflush_get_cpu_node(1 << 20) == -1);
+
+  int x = 1;
+  libflush_access_memory(&x);
+  fail_unless(libflush_get_address_node(&x) >= -1);
+  fail_unless(libflush_get_address_node(NULL) == -1);
+} END_TEST
+
 Suite*
 suite_utils(void)
 {
@@ -62,8 +119,11 @@ suite_utils(void)
   fiu_disable("posix/io/rw/pread");
 #endif
   tcase_add_test(tcase, test_get_pagemap_entry);
+  tcase_add_test(tcase, test_translate_range);
+  tcase_add_test(tcase, test_invalidate_translations);
 #endif
   tcase_add_test(tcase, test_bind_to_cpu);
+  tcase_add_test(tcase, test_get_node);
   suite_add_tcase(suite, tcase);
 
   return suite;